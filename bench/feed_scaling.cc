@@ -0,0 +1,280 @@
+/**
+ * @file feed_scaling.cc
+ * @author Derek Huang
+ * @brief Benchmark for feed parse time and memory against item count
+ * @copyright MIT License
+ *
+ * Synthetic RSS, Atom, or `info.0.json` corpora from 10 items up to the
+ * requested maximum in powers of 10 are generated with
+ * `testing::corpus_generator` and parsed, recording the best parse time, the
+ * peak heap usage while parsing, and the heap retained by the result. The
+ * scaling exponent between consecutive sizes is also reported, where values
+ * well above 1 indicate superlinear behavior. Results are written as JSON for
+ * plotting. Heap usage is tracked with `testing::alloc_counter`.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "pdxka/json.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/corpus.hh"
+
+// replacement operator new and operator delete counting heap usage
+#define PDXKA_TESTING_ALLOC_COUNTER_MAIN
+#include "pdxka/testing/alloc_counter.hh"
+
+namespace {
+
+namespace pt = pdxka::testing;
+
+/**
+ * Struct holding benchmark options.
+ *
+ * @param format Corpus format, one of `rss`, `atom`, or `json`
+ * @param max_items Largest corpus item count
+ * @param repeats Number of timed parses per size
+ * @param seed Corpus generator seed
+ * @param write Write the largest corpus to standard output instead
+ */
+struct bench_options {
+  std::string format{"rss"};
+  std::size_t max_items = 100000u;
+  unsigned int repeats = 3u;
+  unsigned int seed = 0u;
+  bool write = false;
+};
+
+/**
+ * Print usage to standard output.
+ */
+void print_usage()
+{
+  std::cout <<
+    "Usage: pdxka_feed_scaling [-F FORMAT] [-m MAX] [-r REPEATS] [-s SEED] [-w]\n"
+    "\n"
+    "Measures parse time and heap usage of synthetic feeds from 10 items up to\n"
+    "MAX items in powers of 10, writing results as JSON.\n"
+    "\n"
+    "Options:\n"
+    "  -F FORMAT           Corpus format, rss (default), atom, or json for\n"
+    "                      newline-delimited info.0.json objects\n"
+    "  -m MAX              Largest item count, default 100000\n"
+    "  -r REPEATS          Timed parses per size, default 3\n"
+    "  -s SEED             Corpus generator seed, default 0\n"
+    "  -w                  Write the MAX item corpus to stdout and exit" <<
+    std::endl;
+}
+
+/**
+ * Parse a positive integral option value.
+ *
+ * @param name Option name for error messages
+ * @param value Option value
+ *
+ * @throws std::invalid_argument If the value is not a positive integer
+ */
+unsigned long parse_positive(std::string_view name, const char* value)
+{
+  char* end;
+  auto parsed = std::strtoul(value, &end, 10);
+  if (!*value || *end || !parsed)
+    throw std::invalid_argument{
+      std::string{name} + " requires a positive integer, got " + value
+    };
+  return parsed;
+}
+
+/**
+ * Parse command-line options.
+ *
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @returns Options, empty if help was printed
+ *
+ * @throws std::invalid_argument On invalid options
+ */
+std::optional<bench_options> parse_args(int argc, char* argv[])
+{
+  bench_options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return {};
+    }
+    if (arg == "-w") {
+      opts.write = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument{"unknown option or missing value: " + std::string{arg}};
+    auto value = argv[++i];
+    if (arg == "-F")
+      opts.format = value;
+    else if (arg == "-m")
+      opts.max_items = parse_positive(arg, value);
+    else if (arg == "-r")
+      opts.repeats = static_cast<unsigned int>(parse_positive(arg, value));
+    else if (arg == "-s")
+      opts.seed = static_cast<unsigned int>(std::strtoul(value, nullptr, 10));
+    else
+      throw std::invalid_argument{"unknown option: " + std::string{arg}};
+  }
+  if (opts.format != "rss" && opts.format != "atom" && opts.format != "json")
+    throw std::invalid_argument{"unknown format " + opts.format};
+  return opts;
+}
+
+/**
+ * Return the corpus text for items in the given format.
+ *
+ * @param format Corpus format
+ * @param items Items
+ */
+std::string make_corpus(const std::string& format, const pdxka::rss_item_vector& items)
+{
+  if (format == "atom")
+    return pt::corpus_atom(items);
+  if (format == "json")
+    return pt::corpus_info_json(items);
+  return pt::corpus_rss(items);
+}
+
+/**
+ * Parse a corpus, returning the number of items found.
+ *
+ * RSS is parsed into items as `xkcd-alt` does. Atom, which the library does
+ * not consume, is parsed into a property tree, and each `info.0.json` line is
+ * parsed with the Boost property tree JSON parser.
+ *
+ * @param format Corpus format
+ * @param text Corpus text
+ */
+std::size_t parse_corpus(const std::string& format, const std::string& text)
+{
+  if (format == "rss")
+    return pdxka::to_item_vector(pdxka::parse_rss(text)).size();
+  if (format == "atom") {
+    auto tree = pdxka::parse_rss(text);
+    return tree.get_child("feed").count("entry");
+  }
+  std::istringstream stream{text};
+  std::string line;
+  std::size_t n_items = 0;
+  while (std::getline(stream, line)) {
+    boost::property_tree::ptree tree;
+    std::istringstream line_stream{line};
+    boost::property_tree::read_json(line_stream, tree);
+    n_items += !!tree.count("num");
+  }
+  return n_items;
+}
+
+/**
+ * Struct holding the measurements for one corpus size.
+ *
+ * @param items Item count
+ * @param bytes Corpus size in bytes
+ * @param ns Best parse time in nanoseconds
+ * @param peak_bytes Peak heap bytes allocated while parsing
+ */
+struct size_result {
+  std::size_t items;
+  std::size_t bytes;
+  double ns;
+  std::size_t peak_bytes;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto parsed = parse_args(argc, argv);
+    if (!parsed)
+      return EXIT_SUCCESS;
+    const auto& opts = *parsed;
+    if (opts.write) {
+      auto items = pt::corpus_generator{opts.seed}.items(opts.max_items);
+      std::cout << make_corpus(opts.format, items) << std::flush;
+      return EXIT_SUCCESS;
+    }
+    std::vector<size_result> results;
+    for (std::size_t n_items = 10u; n_items <= opts.max_items; n_items *= 10u) {
+      const auto text = make_corpus(
+        opts.format, pt::corpus_generator{opts.seed}.items(n_items)
+      );
+      size_result result{n_items, text.size(), std::numeric_limits<double>::max(), 0u};
+      for (unsigned int i = 0; i < opts.repeats; i++) {
+        pt::alloc_counter counter;
+        auto start = std::chrono::steady_clock::now();
+        auto found = parse_corpus(opts.format, text);
+        auto stop = std::chrono::steady_clock::now();
+        if (found != n_items)
+          throw std::runtime_error{
+            "parsed " + std::to_string(found) + " items, expected " +
+            std::to_string(n_items)
+          };
+        result.ns = std::min(
+          result.ns, std::chrono::duration<double, std::nano>(stop - start).count()
+        );
+        result.peak_bytes = std::max(result.peak_bytes, counter.peak_bytes());
+      }
+      std::cerr << n_items << " items: " << result.ns / 1e6 << " ms, " <<
+        result.peak_bytes / 1024 << " KiB peak" << std::endl;
+      results.push_back(result);
+    }
+    // results with the time and memory exponents relative to the previous size
+    std::string out{"{\"schema\":1,\"format\":"};
+    pdxka::append_json_string(out, opts.format);
+    out += ",\"seed\":";
+    pdxka::append_json_number(out, opts.seed);
+    out += ",\"repeats\":";
+    pdxka::append_json_number(out, opts.repeats);
+    out += ",\"sizes\":[";
+    for (std::size_t i = 0; i < results.size(); i++) {
+      const auto& result = results[i];
+      out += i ? ",\n" : "\n";
+      out += "{\"items\":";
+      pdxka::append_json_number(out, result.items);
+      out += ",\"bytes\":";
+      pdxka::append_json_number(out, result.bytes);
+      out += ",\"ns\":" + std::to_string(result.ns);
+      out += ",\"ns_per_item\":" + std::to_string(result.ns / result.items);
+      out += ",\"peak_bytes\":";
+      pdxka::append_json_number(out, result.peak_bytes);
+      if (i) {
+        const auto& prev = results[i - 1];
+        auto scale = std::log(static_cast<double>(result.items) / prev.items);
+        out += ",\"time_exponent\":" + std::to_string(std::log(result.ns / prev.ns) / scale);
+        out += ",\"memory_exponent\":" + std::to_string(
+          std::log(static_cast<double>(result.peak_bytes) / prev.peak_bytes) / scale
+        );
+      }
+      out += '}';
+    }
+    out += "\n]}\n";
+    std::cout << out << std::flush;
+    return EXIT_SUCCESS;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,328 @@
+/**
+ * @file http_load.cc
+ * @author Derek Huang
+ * @brief HTTP load generator for the xkcd-alt HTTP/JSON server
+ * @copyright MIT License
+ *
+ * By default an in-process `http_server` serving the test fixture feed is
+ * started on a free loopback port so no network access is needed. Use
+ * `--target HOST:PORT` to load an already running `xkcd-alt --http` instead.
+ */
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/http_server.hh"
+#include "pdxka/testing/http_server.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace {
+
+namespace pt = pdxka::testing;
+
+/**
+ * Struct holding load generator options.
+ *
+ * @param connections Number of concurrent connections, one thread each
+ * @param duration Duration of the measured run
+ * @param depth Number of requests pipelined per round trip
+ * @param workers Number of workers for the in-process server
+ * @param path Request path
+ * @param target External `HOST:PORT` to load, empty for in-process server
+ */
+struct load_options {
+  unsigned int connections = 4u;
+  std::chrono::seconds duration{5};
+  unsigned int depth = 1u;
+  unsigned int workers = 1u;
+  std::string path{"/latest"};
+  std::string target;
+};
+
+/**
+ * Struct holding per-connection results.
+ *
+ * @param requests Number of completed requests
+ * @param latencies Round trip latencies in microseconds per pipelined batch
+ * @param error Error message if the connection failed
+ */
+struct connection_result {
+  unsigned long requests = 0u;
+  std::vector<double> latencies;
+  std::string error;
+};
+
+/**
+ * Print usage to standard output.
+ */
+void print_usage()
+{
+  std::cout <<
+    "Usage: pdxka_http_load [-c CONNS] [-d SECS] [-p DEPTH] [-w WORKERS]\n"
+    "                       [--path PATH] [--target HOST:PORT]\n"
+    "\n"
+    "Measures throughput and latency of the xkcd-alt HTTP/JSON server.\n"
+    "\n"
+    "Options:\n"
+    "  -c CONNS            Number of concurrent connections, default 4\n"
+    "  -d SECS             Measured run duration, default 5\n"
+    "  -p DEPTH            Requests pipelined per round trip, default 1\n"
+    "  -w WORKERS          In-process server worker threads, default 1\n"
+    "  --path PATH         Request path, default /latest\n"
+    "  --target HOST:PORT  Load an external IPv4 server instead" << std::endl;
+}
+
+/**
+ * Parse a positive integral option value.
+ *
+ * @param name Option name for error messages
+ * @param value Option value
+ *
+ * @throws std::invalid_argument If the value is not a positive integer
+ */
+unsigned int parse_positive(std::string_view name, const char* value)
+{
+  char* end;
+  auto parsed = std::strtoul(value, &end, 10);
+  if (!*value || *end || !parsed)
+    throw std::invalid_argument{
+      std::string{name} + " requires a positive integer, got " + value
+    };
+  return static_cast<unsigned int>(parsed);
+}
+
+/**
+ * Parse command-line options.
+ *
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @returns Options, empty if help was printed
+ *
+ * @throws std::invalid_argument On invalid options
+ */
+std::optional<load_options> parse_args(int argc, char* argv[])
+{
+  load_options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return {};
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument{"unknown option or missing value: " + std::string{arg}};
+    auto value = argv[++i];
+    if (arg == "-c")
+      opts.connections = parse_positive(arg, value);
+    else if (arg == "-d")
+      opts.duration = std::chrono::seconds{parse_positive(arg, value)};
+    else if (arg == "-p")
+      opts.depth = parse_positive(arg, value);
+    else if (arg == "-w")
+      opts.workers = parse_positive(arg, value);
+    else if (arg == "--path")
+      opts.path = value;
+    else if (arg == "--target")
+      opts.target = value;
+    else
+      throw std::invalid_argument{"unknown option " + std::string{arg}};
+  }
+  return opts;
+}
+
+/**
+ * Consume complete responses from the front of a receive buffer.
+ *
+ * @param buf Receive buffer
+ * @returns Number of complete responses consumed
+ */
+unsigned int consume_responses(std::string& buf)
+{
+  unsigned int n_responses = 0;
+  std::size_t pos = 0;
+  while (true) {
+    auto header_end = buf.find("\r\n\r\n", pos);
+    if (header_end == std::string::npos)
+      break;
+    auto length_pos = buf.find("Content-Length: ", pos);
+    std::size_t length = 0;
+    if (length_pos != std::string::npos && length_pos < header_end)
+      length = std::strtoul(buf.c_str() + length_pos + 16, nullptr, 10);
+    if (buf.size() < header_end + 4 + length)
+      break;
+    pos = header_end + 4 + length;
+    n_responses++;
+  }
+  buf.erase(0, pos);
+  return n_responses;
+}
+
+/**
+ * Drive one connection until the deadline.
+ *
+ * @param address Numeric IPv4 address
+ * @param port Server port
+ * @param opts Load generator options
+ * @param start Flag set when all connection threads should start sending
+ * @param deadline Time to stop sending at
+ */
+connection_result run_connection(
+  const std::string& address,
+  unsigned short port,
+  const load_options& opts,
+  const std::atomic<bool>& start,
+  std::chrono::steady_clock::time_point deadline)
+{
+  connection_result result;
+  auto fd = pt::tcp_connect(port, address.c_str());
+  if (fd < 0) {
+    result.error = "connect: " + std::string{std::strerror(errno)};
+    return result;
+  }
+  // pipelined batch of requests sent per round trip
+  std::string batch;
+  for (unsigned int i = 0; i < opts.depth; i++)
+    batch += "GET " + opts.path + " HTTP/1.1\r\nHost: " + address + "\r\n\r\n";
+  std::string buf;
+  char chunk[16384];
+  while (!start)
+    std::this_thread::yield();
+  while (std::chrono::steady_clock::now() < deadline) {
+    auto sent = std::chrono::steady_clock::now();
+    if (!pt::send_all(fd, batch)) {
+      result.error = "send: " + std::string{std::strerror(errno)};
+      break;
+    }
+    unsigned int pending = opts.depth;
+    while (pending) {
+      auto n = recv(fd, chunk, sizeof chunk, 0);
+      if (n <= 0) {
+        result.error = n ? std::strerror(errno) : "connection closed";
+        break;
+      }
+      buf.append(chunk, static_cast<std::size_t>(n));
+      pending -= std::min(pending, consume_responses(buf));
+    }
+    if (pending)
+      break;
+    result.requests += opts.depth;
+    result.latencies.push_back(
+      std::chrono::duration<double, std::micro>(
+        std::chrono::steady_clock::now() - sent
+      ).count()
+    );
+  }
+  close(fd);
+  return result;
+}
+
+/**
+ * Return the given percentile of sorted values.
+ *
+ * @param sorted Sorted values
+ * @param p Percentile in `[0, 100]`
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0.;
+  auto index = static_cast<std::size_t>(p / 100. * static_cast<double>(sorted.size() - 1));
+  return sorted[index];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto parsed = parse_args(argc, argv);
+    if (!parsed)
+      return EXIT_SUCCESS;
+    const auto& opts = *parsed;
+    // in-process server on fixture data or external target
+    std::unique_ptr<pt::scoped_http_server> server;
+    pdxka::http_server_options endpoint{"127.0.0.1", 0u, opts.workers};
+    if (opts.target.size())
+      pdxka::parse_endpoint(opts.target, endpoint);
+    else {
+      server = std::make_unique<pt::scoped_http_server>(
+        endpoint,
+        [](std::time_t)
+        {
+          return pdxka::curl_result{
+            CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200
+          };
+        }
+      );
+      if (!server->wait_ready())
+        throw std::runtime_error{"in-process server did not start"};
+      endpoint.port = server->port();
+    }
+    // run all connections concurrently
+    std::atomic<bool> start{false};
+    auto deadline = std::chrono::steady_clock::now() + opts.duration;
+    std::vector<connection_result> results(opts.connections);
+    std::vector<std::thread> threads;
+    for (unsigned int i = 0; i < opts.connections; i++)
+      threads.emplace_back(
+        [&, i]
+        {
+          results[i] = run_connection(
+            endpoint.address, endpoint.port, opts, start, deadline
+          );
+        }
+      );
+    auto started = std::chrono::steady_clock::now();
+    start = true;
+    for (auto& thread : threads)
+      thread.join();
+    auto elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - started
+    ).count();
+    if (server)
+      server->join();
+    // aggregate
+    unsigned long n_requests = 0;
+    std::vector<double> latencies;
+    for (const auto& result : results) {
+      if (result.error.size())
+        std::cerr << "Warning: " << result.error << std::endl;
+      n_requests += result.requests;
+      latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::fixed << std::setprecision(1) <<
+      "target:      " << endpoint.address << ":" << endpoint.port <<
+        (server ? " (in-process)" : "") << "\n" <<
+      "connections: " << opts.connections << ", depth " << opts.depth <<
+        ", workers " << (server ? std::to_string(opts.workers) : "n/a") << "\n" <<
+      "requests:    " << n_requests << " in " << elapsed << " s\n" <<
+      "throughput:  " << static_cast<double>(n_requests) / elapsed << " req/s\n" <<
+      "latency:     p50 " << percentile(latencies, 50.) << " us, p99 " <<
+        percentile(latencies, 99.) << " us per round trip" << std::endl;
+    return n_requests ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
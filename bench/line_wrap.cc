@@ -0,0 +1,248 @@
+/**
+ * @file line_wrap.cc
+ * @author Derek Huang
+ * @brief Benchmark for whitespace segmentation and line wrapping
+ * @copyright MIT License
+ *
+ * The corpus is the test fixture's alt texts concatenated and repeated to the
+ * requested size. Each run checks that the vectorized segmentation finds the
+ * same word boundaries as a per-byte `std::isspace` scan before timing.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/string.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/whitespace.hh"
+
+namespace {
+
+namespace pt = pdxka::testing;
+
+/**
+ * Struct holding benchmark options.
+ *
+ * @param size Corpus size in bytes
+ * @param repeats Number of timed passes over the corpus per measurement
+ * @param line_length Line length to wrap at
+ */
+struct bench_options {
+  std::size_t size = 8u << 20;
+  unsigned int repeats = 10u;
+  std::size_t line_length = 80u;
+};
+
+/**
+ * Print usage to standard output.
+ */
+void print_usage()
+{
+  std::cout <<
+    "Usage: pdxka_line_wrap [-m MIB] [-r REPEATS] [-l LENGTH]\n"
+    "\n"
+    "Measures whitespace segmentation and line wrapping throughput.\n"
+    "\n"
+    "Options:\n"
+    "  -m MIB              Corpus size in MiB, default 8\n"
+    "  -r REPEATS          Timed passes per measurement, default 10\n"
+    "  -l LENGTH           Line length to wrap at, default 80" << std::endl;
+}
+
+/**
+ * Parse a positive integral option value.
+ *
+ * @param name Option name for error messages
+ * @param value Option value
+ *
+ * @throws std::invalid_argument If the value is not a positive integer
+ */
+unsigned int parse_positive(std::string_view name, const char* value)
+{
+  char* end;
+  auto parsed = std::strtoul(value, &end, 10);
+  if (!*value || *end || !parsed)
+    throw std::invalid_argument{
+      std::string{name} + " requires a positive integer, got " + value
+    };
+  return static_cast<unsigned int>(parsed);
+}
+
+/**
+ * Parse command-line options.
+ *
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @returns Options, empty if help was printed
+ *
+ * @throws std::invalid_argument On invalid options
+ */
+std::optional<bench_options> parse_args(int argc, char* argv[])
+{
+  bench_options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return {};
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument{"unknown option or missing value: " + std::string{arg}};
+    auto value = argv[++i];
+    if (arg == "-m")
+      opts.size = std::size_t{parse_positive(arg, value)} << 20;
+    else if (arg == "-r")
+      opts.repeats = parse_positive(arg, value);
+    else if (arg == "-l")
+      opts.line_length = parse_positive(arg, value);
+    else
+      throw std::invalid_argument{"unknown option: " + std::string{arg}};
+  }
+  return opts;
+}
+
+/**
+ * Return the fixture alt texts concatenated and repeated to `size` bytes.
+ *
+ * @param size Corpus size in bytes
+ */
+std::string make_corpus(std::size_t size)
+{
+  std::string texts;
+  for (const auto& item : pt::rss_fixture_items())
+    texts.append(item.img_title()).push_back('\n');
+  std::string corpus;
+  corpus.reserve(size + texts.size());
+  while (corpus.size() < size)
+    corpus.append(texts);
+  corpus.resize(size);
+  return corpus;
+}
+
+/**
+ * Return the sum of whitespace positions found with per-byte `std::isspace`.
+ *
+ * @param text Text to scan
+ */
+std::size_t scan_isspace(std::string_view text)
+{
+  std::size_t sum = 0;
+  for (std::size_t i = 0; i < text.size(); i++)
+    if (std::isspace(static_cast<unsigned char>(text[i])))
+      sum += i;
+  return sum;
+}
+
+/**
+ * Return the sum of whitespace positions found with `whitespace_finder`.
+ *
+ * @param text Text to scan
+ */
+std::size_t scan_finder(std::string_view text)
+{
+  std::size_t sum = 0;
+  pdxka::whitespace_finder finder{text};
+  for (auto i = finder.next(); i != text.size(); i = finder.next())
+    sum += i;
+  return sum;
+}
+
+/**
+ * Return the best throughput in MiB/s of `repeats` runs of `func`.
+ *
+ * @param bytes Bytes processed per run
+ * @param repeats Number of runs
+ * @param func Callable to time
+ */
+template <typename Func>
+double best_throughput(std::size_t bytes, unsigned int repeats, Func&& func)
+{
+  double best = 0.;
+  for (unsigned int i = 0; i < repeats; i++) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto elapsed = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start
+    ).count();
+    best = std::max(best, static_cast<double>(bytes) / (1 << 20) / elapsed);
+  }
+  return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto parsed = parse_args(argc, argv);
+    if (!parsed)
+      return EXIT_SUCCESS;
+    const auto& opts = *parsed;
+    const auto corpus = make_corpus(opts.size);
+    // results must match before anything is timed
+    auto expected = scan_isspace(corpus);
+    if (scan_finder(corpus) != expected)
+      throw std::runtime_error{"whitespace_finder disagrees with std::isspace"};
+    // volatile sink so the scans are not optimized away
+    volatile std::size_t sink = 0;
+    auto isspace_rate = best_throughput(
+      corpus.size(), opts.repeats, [&] { sink = scan_isspace(corpus); }
+    );
+    auto finder_rate = best_throughput(
+      corpus.size(), opts.repeats, [&] { sink = scan_finder(corpus); }
+    );
+    std::string wrapped;
+    wrapped.reserve(pdxka::line_wrap_size(corpus, opts.line_length));
+    auto wrap_rate = best_throughput(
+      corpus.size(),
+      opts.repeats,
+      [&]
+      {
+        wrapped.clear();
+        pdxka::line_wrap(wrapped, corpus, opts.line_length);
+      }
+    );
+    // same corpus with curly apostrophes so the UTF-8 path is taken
+    std::string utf8_corpus;
+    utf8_corpus.reserve(corpus.size() + corpus.size() / 8);
+    for (auto c : corpus)
+      if (c == '\'')
+        utf8_corpus.append("\u2019");
+      else
+        utf8_corpus.push_back(c);
+    auto utf8_wrap_rate = best_throughput(
+      utf8_corpus.size(),
+      opts.repeats,
+      [&]
+      {
+        wrapped.clear();
+        pdxka::line_wrap(wrapped, utf8_corpus, opts.line_length);
+      }
+    );
+    std::cout << std::fixed << std::setprecision(1) <<
+      "corpus:      " << (corpus.size() >> 20) << " MiB of fixture alt text\n" <<
+      "kernel:      " PDXKA_WHITESPACE_KERNEL ", " <<
+        pdxka::whitespace_block_size << " bytes per mask\n" <<
+      "isspace:     " << isspace_rate << " MiB/s\n" <<
+      "finder:      " << finder_rate << " MiB/s (" <<
+        finder_rate / isspace_rate << "x)\n" <<
+      "line_wrap:   " << wrap_rate << " MiB/s\n" <<
+      "  UTF-8:     " << utf8_wrap_rate << " MiB/s" << std::endl;
+    return EXIT_SUCCESS;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,669 @@
+/**
+ * @file pdxka_bench.cc
+ * @author Derek Huang
+ * @brief Microbenchmarks for the libpdxka hot paths with JSON results
+ * @copyright MIT License
+ *
+ * Benchmarks run against the bundled RSS fixture and a synthetic feed from
+ * `testing::corpus_generator`, so no network access is needed. Each benchmark
+ * is calibrated to run for at least a minimum time per sample and several
+ * samples are taken, with the per-iteration minimum, median, and mean reported
+ * as JSON so results can be saved and compared across releases.
+ *
+ * Given a baseline, i.e. saved results, each benchmark's minimum is compared
+ * against the baseline minimum and the run fails if any benchmark is slower
+ * by more than a tolerance. The minimum is used since noise from other
+ * processes, interrupts, etc. only ever adds time. Results record the build
+ * configuration, and a baseline from a differently configured build is only
+ * reported, not compared. This is how the `perf` CTest tests are run, with a
+ * fixed iteration count and a JUnit XML report alongside the JSON.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "pdxka/curl.hh"
+#include "pdxka/features.h"
+#include "pdxka/json.hh"
+#include "pdxka/program_options.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/simd.hh"
+#include "pdxka/string.hh"
+#include "pdxka/testing/corpus.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/version.h"
+
+namespace {
+
+namespace pt = pdxka::testing;
+
+/**
+ * Struct holding benchmark options.
+ *
+ * @param repeats Number of timed samples per benchmark
+ * @param n_items Number of items in the synthetic feed
+ * @param min_time Minimum duration of each timed sample
+ * @param iterations Fixed iterations per timed sample, 0 to calibrate
+ * @param filter Only run benchmarks whose name contains this text
+ * @param output Path to write JSON results to, empty for standard output
+ * @param baseline Path of JSON results to compare against, empty for none
+ * @param tolerance Percent slowdown over the baseline minimum allowed
+ * @param junit Path to write a JUnit XML report to, empty for none
+ */
+struct bench_options {
+  unsigned int repeats = 5u;
+  unsigned int n_items = 1000u;
+  std::chrono::milliseconds min_time{20};
+  unsigned int iterations = 0u;
+  std::string filter;
+  std::string output;
+  std::string baseline;
+  unsigned int tolerance = 25u;
+  std::string junit;
+};
+
+/**
+ * Print usage to standard output.
+ */
+void print_usage()
+{
+  std::cout <<
+    "Usage: pdxka_bench [-r REPEATS] [-n ITEMS] [-t MS | -i ITERS] [-f FILTER]\n"
+    "         [-o FILE] [-b BASELINE [-T PCT] [-j FILE]]\n"
+    "\n"
+    "Runs the libpdxka microbenchmarks, writing results as JSON.\n"
+    "\n"
+    "Options:\n"
+    "  -r REPEATS          Timed samples per benchmark, default 5\n"
+    "  -n ITEMS            Synthetic feed item count, default 1000\n"
+    "  -t MS               Minimum milliseconds per sample, default 20\n"
+    "  -i ITERS            Run exactly ITERS iterations per sample instead\n"
+    "  -f FILTER           Only run benchmarks whose name contains FILTER\n"
+    "  -o FILE             Write JSON to FILE instead of standard output\n"
+    "  -b BASELINE         Compare minimums against the saved JSON results in\n"
+    "                      BASELINE, failing if any benchmark regressed\n"
+    "  -T PCT              Percent slowdown over the baseline allowed,\n"
+    "                      default 25\n"
+    "  -j FILE             Also write a JUnit XML report of the comparison" <<
+    std::endl;
+}
+
+/**
+ * Parse a positive integral option value.
+ *
+ * @param name Option name for error messages
+ * @param value Option value
+ *
+ * @throws std::invalid_argument If the value is not a positive integer
+ */
+unsigned int parse_positive(std::string_view name, const char* value)
+{
+  char* end;
+  auto parsed = std::strtoul(value, &end, 10);
+  if (!*value || *end || !parsed)
+    throw std::invalid_argument{
+      std::string{name} + " requires a positive integer, got " + value
+    };
+  return static_cast<unsigned int>(parsed);
+}
+
+/**
+ * Parse command-line options.
+ *
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @returns Options, empty if help was printed
+ *
+ * @throws std::invalid_argument On invalid options
+ */
+std::optional<bench_options> parse_args(int argc, char* argv[])
+{
+  bench_options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return {};
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument{"unknown option or missing value: " + std::string{arg}};
+    auto value = argv[++i];
+    if (arg == "-r")
+      opts.repeats = parse_positive(arg, value);
+    else if (arg == "-n")
+      opts.n_items = parse_positive(arg, value);
+    else if (arg == "-t")
+      opts.min_time = std::chrono::milliseconds{parse_positive(arg, value)};
+    else if (arg == "-i")
+      opts.iterations = parse_positive(arg, value);
+    else if (arg == "-f")
+      opts.filter = value;
+    else if (arg == "-o")
+      opts.output = value;
+    else if (arg == "-b")
+      opts.baseline = value;
+    else if (arg == "-T")
+      opts.tolerance = parse_positive(arg, value);
+    else if (arg == "-j")
+      opts.junit = value;
+    else
+      throw std::invalid_argument{"unknown option: " + std::string{arg}};
+  }
+  return opts;
+}
+
+/**
+ * Return the build configuration that results are only comparable within.
+ *
+ * Each pair is a JSON key and its value for this build.
+ */
+auto build_config()
+{
+  return std::vector<std::pair<std::string_view, std::string_view>>{
+    {"build_type", PDXKA_BUILD_TYPE},
+    {"compiler", PDXKA_BENCH_COMPILER},
+    {"cxx_flags", PDXKA_BENCH_CXX_FLAGS},
+#if PDXKA_USE_BOOST_PROGRAM_OPTIONS
+    {"cli_parser", "boost"},
+#else
+    {"cli_parser", "builtin"},
+#endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
+    {"system", PDXKA_SYSTEM_ARCH " " PDXKA_SYSTEM_NAME},
+    {"simd", PDXKA_SIMD_NAME}
+  };
+}
+
+/**
+ * Prevent the compiler from optimizing away a computed value.
+ *
+ * @param value Value to keep
+ */
+template <typename T>
+void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif  // !defined(__GNUC__)
+}
+
+/**
+ * Struct holding a benchmark's results.
+ *
+ * @param name Benchmark name
+ * @param bytes Bytes processed per iteration, 0 if not meaningful
+ * @param iterations Iterations per timed sample
+ * @param samples Nanoseconds per iteration of each sample
+ * @param baseline Baseline minimum nanoseconds per iteration, if any
+ */
+struct bench_result {
+  std::string name;
+  std::size_t bytes;
+  std::size_t iterations;
+  std::vector<double> samples;
+  std::optional<double> baseline;
+};
+
+/**
+ * Return the minimum of the samples.
+ *
+ * @param samples Samples, which must not be empty
+ */
+double minimum(const std::vector<double>& samples)
+{
+  return *std::min_element(samples.begin(), samples.end());
+}
+
+/**
+ * Benchmark runner collecting results.
+ */
+class bench_runner {
+public:
+  explicit bench_runner(const bench_options& opts) : opts_{opts} {}
+
+  /**
+   * Run a benchmark unless it is filtered out.
+   *
+   * The iteration count is doubled from 1 until a sample takes at least the
+   * minimum time, which also serves as the warmup, then the timed samples
+   * are taken with that iteration count. With a fixed iteration count, an
+   * untimed sample is the warmup instead.
+   *
+   * @param name Benchmark name
+   * @param bytes Bytes processed per iteration, 0 if not meaningful
+   * @param func Callable running one iteration
+   */
+  template <typename Func>
+  void run(std::string name, std::size_t bytes, Func&& func)
+  {
+    if (name.find(opts_.filter) == std::string::npos)
+      return;
+    std::size_t iterations = 1;
+    if (opts_.iterations) {
+      iterations = opts_.iterations;
+      time(iterations, func);
+    }
+    else {
+      while (time(iterations, func) < opts_.min_time && iterations < (std::size_t{1} << 30))
+        iterations *= 2;
+    }
+    bench_result result{std::move(name), bytes, iterations, {}, {}};
+    for (unsigned int i = 0; i < opts_.repeats; i++)
+      result.samples.push_back(
+        std::chrono::duration<double, std::nano>(time(iterations, func)).count() /
+        static_cast<double>(iterations)
+      );
+    std::cerr << result.name << ": " << *std::min_element(
+      result.samples.begin(), result.samples.end()
+    ) << " ns" << std::endl;
+    results_.push_back(std::move(result));
+  }
+
+  /**
+   * Load baseline minimums from saved JSON results.
+   *
+   * Benchmarks missing from the baseline, e.g. new ones, are not compared,
+   * and nothing is compared if the baseline's build configuration differs.
+   *
+   * @param path JSON results file path
+   *
+   * @throws boost::property_tree::json_parser_error On read or parse error
+   */
+  void load_baseline(const std::string& path)
+  {
+    boost::property_tree::ptree tree;
+    boost::property_tree::read_json(path, tree);
+    for (const auto& [key, value] : build_config()) {
+      auto baseline_value = tree.get<std::string>(std::string{key}, "");
+      if (baseline_value != value)
+        mismatches_.push_back(
+          std::string{key} + " \"" + baseline_value + "\" differs from \"" +
+          std::string{value} + "\""
+        );
+    }
+    if (mismatches_.size())
+      return;
+    std::map<std::string, double> minimums;
+    for (const auto& [key, bench] : tree.get_child("benchmarks"))
+      minimums[bench.get<std::string>("name")] =
+        bench.get<double>("ns_per_iteration.min");
+    for (auto& result : results_)
+      if (auto iter = minimums.find(result.name); iter != minimums.end())
+        result.baseline = iter->second;
+  }
+
+  /**
+   * Return `true` if a result is slower than its baseline beyond tolerance.
+   *
+   * @param result Benchmark result
+   */
+  bool regressed(const bench_result& result) const
+  {
+    return result.baseline &&
+      minimum(result.samples) > *result.baseline * (1. + opts_.tolerance / 100.);
+  }
+
+  /**
+   * Return the number of results slower than their baseline beyond tolerance.
+   */
+  std::size_t regressions() const
+  {
+    return static_cast<std::size_t>(
+      std::count_if(
+        results_.begin(),
+        results_.end(),
+        [this](const auto& result) { return regressed(result); }
+      )
+    );
+  }
+
+  /**
+   * Return how the baseline's build configuration differs, empty if it matches.
+   */
+  const auto& baseline_mismatches() const noexcept { return mismatches_; }
+
+  /**
+   * Return the baseline comparison as a JUnit XML report.
+   *
+   * Each benchmark is a test case whose time is its total sample time, and
+   * benchmarks without a comparable baseline are reported as skipped.
+   */
+  std::string junit() const
+  {
+    std::string cases;
+    double total_time = 0.;
+    std::size_t skipped = 0;
+    for (const auto& result : results_) {
+      double seconds = 0.;
+      for (auto sample : result.samples)
+        seconds += sample * static_cast<double>(result.iterations) * 1e-9;
+      total_time += seconds;
+      cases += "  <testcase classname=\"pdxka_bench\" name=\"";
+      pt::append_xml_escaped(cases, result.name);
+      cases += "\" time=\"" + std::to_string(seconds) + "\"";
+      if (!result.baseline) {
+        skipped++;
+        cases += ">\n    <skipped message=\"";
+        cases += mismatches_.empty() ? "no baseline" : "baseline build differs";
+        cases += "\"/>\n  </testcase>\n";
+      }
+      else if (regressed(result))
+        cases += ">\n    <failure message=\"minimum " +
+          std::to_string(minimum(result.samples)) + " ns exceeds baseline " +
+          std::to_string(*result.baseline) + " ns by more than " +
+          std::to_string(opts_.tolerance) + "%\"/>\n  </testcase>\n";
+      else
+        cases += "/>\n";
+    }
+    return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      "<testsuite name=\"pdxka_bench\" tests=\"" + std::to_string(results_.size()) +
+      "\" failures=\"" + std::to_string(regressions()) + "\" skipped=\"" +
+      std::to_string(skipped) + "\" time=\"" + std::to_string(total_time) + "\">\n" +
+      cases + "</testsuite>\n";
+  }
+
+  /**
+   * Return the results as JSON.
+   */
+  std::string json() const
+  {
+    std::string out{"{\"schema\":1,\"version\":"};
+    pdxka::append_json_string(out, PDXKA_VERSION_STRING);
+    for (const auto& [key, value] : build_config()) {
+      out += ",\"";
+      out += key;
+      out += "\":";
+      pdxka::append_json_string(out, value);
+    }
+    out += ",\"repeats\":";
+    pdxka::append_json_number(out, opts_.repeats);
+    out += ",\"synthetic_items\":";
+    pdxka::append_json_number(out, opts_.n_items);
+    if (opts_.baseline.size()) {
+      out += ",\"baseline_matches\":";
+      out += mismatches_.empty() ? "true" : "false";
+      out += ",\"tolerance\":";
+      pdxka::append_json_number(out, opts_.tolerance);
+      out += ",\"regressions\":";
+      pdxka::append_json_number(out, regressions());
+    }
+    out += ",\"benchmarks\":[";
+    for (std::size_t i = 0; i < results_.size(); i++) {
+      const auto& result = results_[i];
+      auto sorted = result.samples;
+      std::sort(sorted.begin(), sorted.end());
+      double mean = 0.;
+      for (auto sample : sorted)
+        mean += sample / static_cast<double>(sorted.size());
+      out += i ? ",\n" : "\n";
+      out += "{\"name\":";
+      pdxka::append_json_string(out, result.name);
+      out += ",\"iterations\":";
+      pdxka::append_json_number(out, result.iterations);
+      out += ",\"bytes\":";
+      pdxka::append_json_number(out, result.bytes);
+      out += ",\"ns_per_iteration\":{\"min\":" + std::to_string(sorted.front()) +
+        ",\"median\":" + std::to_string(sorted[sorted.size() / 2]) +
+        ",\"mean\":" + std::to_string(mean) + "}";
+      if (result.bytes)
+        out += ",\"mib_per_second\":" + std::to_string(
+          static_cast<double>(result.bytes) / (1 << 20) / (sorted.front() * 1e-9)
+        );
+      // "new" benchmarks have no baseline to compare against
+      if (opts_.baseline.size()) {
+        out += ",\"baseline\":{\"min\":";
+        if (result.baseline)
+          out += std::to_string(*result.baseline) + ",\"ratio\":" +
+            std::to_string(sorted.front() / *result.baseline);
+        else
+          out += "null";
+        out += ",\"status\":";
+        pdxka::append_json_string(
+          out, !result.baseline ? "new" : regressed(result) ? "fail" : "pass"
+        );
+        out += '}';
+      }
+      out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+  }
+
+private:
+  const bench_options& opts_;
+  std::vector<bench_result> results_;
+  std::vector<std::string> mismatches_;
+
+  /**
+   * Return the time taken to run `func` `iterations` times.
+   */
+  template <typename Func>
+  static auto time(std::size_t iterations, Func& func)
+  {
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; i++)
+      func();
+    return std::chrono::steady_clock::now() - start;
+  }
+};
+
+/**
+ * Return the fixture alt texts concatenated and repeated to `size` bytes.
+ *
+ * @param size Corpus size in bytes
+ */
+std::string make_corpus(std::size_t size)
+{
+  std::string texts;
+  for (const auto& item : pt::rss_fixture_items())
+    texts.append(item.img_title()).push_back(' ');
+  std::string corpus;
+  while (corpus.size() < size)
+    corpus.append(texts);
+  corpus.resize(size);
+  return corpus;
+}
+
+/**
+ * Run the RSS parsing benchmarks for a feed.
+ *
+ * @param runner Benchmark runner
+ * @param label Feed label used in benchmark names
+ * @param xml Feed XML
+ */
+void bench_feed(bench_runner& runner, const std::string& label, const std::string& xml)
+{
+  runner.run(
+    "parse_rss/" + label, xml.size(), [&xml] { do_not_optimize(pdxka::parse_rss(xml)); }
+  );
+  const auto tree = pdxka::parse_rss(xml);
+  runner.run(
+    "to_item_vector/" + label,
+    xml.size(),
+    [&tree] { do_not_optimize(pdxka::to_item_vector(tree)); }
+  );
+}
+
+/**
+ * Run the `detail::curl_writer` benchmarks.
+ *
+ * Each iteration writes the whole feed into a fresh stream in chunks of the
+ * given size, as libcurl would when receiving it.
+ *
+ * @param runner Benchmark runner
+ * @param label Feed label used in benchmark names
+ * @param xml Feed XML
+ */
+void bench_curl_writer(bench_runner& runner, const std::string& label, std::string xml)
+{
+  // CURL_MAX_WRITE_SIZE is the largest chunk libcurl passes by default
+  for (std::size_t chunk : {16u, 256u, 4096u, 16384u}) {
+    runner.run(
+      "curl_writer/" + label + "/chunk_" + std::to_string(chunk),
+      xml.size(),
+      [&xml, chunk]
+      {
+        std::stringstream stream;
+        for (std::size_t i = 0; i < xml.size(); i += chunk)
+          pdxka::detail::curl_writer(
+            xml.data() + i, 1u, std::min(chunk, xml.size() - i), &stream
+          );
+        do_not_optimize(stream);
+      }
+    );
+  }
+}
+
+/**
+ * Run the `parse_options` benchmarks.
+ *
+ * @param runner Benchmark runner
+ */
+void bench_parse_options(bench_runner& runner)
+{
+  // argument vectors, as mutable strings since argv is char**
+  // no arguments is omitted as it times little more than the loop itself
+  const std::vector<std::vector<std::string>> arg_sets{
+    {PDXKA_PROGNAME, "-o", "-b2"},
+    {
+      PDXKA_PROGNAME, "-o", "-b", "0..3", "--format", "ndjson", "-k",
+      "--socket", "/tmp/xkcd-alt.sock", "--refresh", "600"
+    }
+  };
+  const char* labels[] = {"short", "many"};
+  for (std::size_t i = 0; i < arg_sets.size(); i++) {
+    auto args = arg_sets[i];
+    std::vector<char*> argv;
+    for (auto& arg : args)
+      argv.push_back(arg.data());
+    argv.push_back(nullptr);
+    auto argc = static_cast<int>(args.size());
+    runner.run(
+      std::string{"parse_options/"} + labels[i],
+      0u,
+      [argc, &argv]
+      {
+#if PDXKA_USE_BOOST_PROGRAM_OPTIONS
+        do_not_optimize(pdxka::parse_options(argc, argv.data()));
+#else
+        pdxka::cliopt_map opt_map;
+        do_not_optimize(pdxka::parse_options(opt_map, argc, argv.data()));
+        do_not_optimize(opt_map);
+#endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
+      }
+    );
+  }
+}
+
+/**
+ * Write text to a file or standard output.
+ *
+ * @param path File path, empty for standard output
+ * @param text Text to write
+ *
+ * @throws std::runtime_error On write failure
+ */
+void write_file(const std::string& path, const std::string& text)
+{
+  if (path.empty()) {
+    std::cout << text << std::flush;
+    return;
+  }
+  std::ofstream out{path, std::ios::binary};
+  if (!(out << text))
+    throw std::runtime_error{"error writing " + path};
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto parsed = parse_args(argc, argv);
+    if (!parsed)
+      return EXIT_SUCCESS;
+    const auto& opts = *parsed;
+    bench_runner runner{opts};
+    // RSS parsing
+    const auto& fixture = pt::rss_fixture();
+    const auto synthetic = pt::corpus_rss(pt::corpus_generator{}.items(opts.n_items));
+    const auto synthetic_label = "synthetic_" + std::to_string(opts.n_items);
+    bench_feed(runner, "fixture", fixture);
+    bench_feed(runner, synthetic_label, synthetic);
+    // single item decode from its subtree
+    const auto tree = pdxka::parse_rss(fixture);
+    const auto& item_tree = tree.get_child("rss.channel.item");
+    runner.run(
+      "rss_item::from_tree",
+      0u,
+      [&item_tree] { do_not_optimize(pdxka::rss_item::from_tree(item_tree)); }
+    );
+    // line wrapping into a reused string, soft and hard
+    const auto corpus = make_corpus(64u << 10);
+    std::string wrapped;
+    wrapped.reserve(2 * corpus.size());
+    for (auto hard : {false, true}) {
+      for (std::size_t width : {40u, 80u, 120u}) {
+        runner.run(
+          std::string{"line_wrap/"} + (hard ? "hard" : "soft") + "/" +
+            std::to_string(width),
+          corpus.size(),
+          [&corpus, &wrapped, width, hard]
+          {
+            wrapped.clear();
+            pdxka::line_wrap(wrapped, corpus, width, hard);
+            do_not_optimize(wrapped);
+          }
+        );
+      }
+    }
+    // receiving the feed
+    bench_curl_writer(runner, "fixture", fixture);
+    bench_curl_writer(runner, synthetic_label, synthetic);
+    // option parsing
+    bench_parse_options(runner);
+    // baseline comparison
+    if (opts.baseline.size()) {
+      runner.load_baseline(opts.baseline);
+      for (const auto& mismatch : runner.baseline_mismatches())
+        std::cerr << "Warning: baseline " << mismatch << std::endl;
+      if (runner.baseline_mismatches().size())
+        std::cerr << "Warning: not comparing against a baseline from a " <<
+          "differently configured build" << std::endl;
+    }
+    // results
+    write_file(opts.output, runner.json());
+    if (opts.junit.size())
+      write_file(opts.junit, runner.junit());
+    if (auto regressions = runner.regressions()) {
+      std::cerr << "Error: " << regressions << " benchmarks regressed by more than " <<
+        opts.tolerance << "%" << std::endl;
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,340 @@
+/**
+ * @file startup.cc
+ * @author Derek Huang
+ * @brief End-to-end startup latency benchmark for the xkcd-alt executable
+ * @copyright MIT License
+ *
+ * The executable is spawned repeatedly with `posix_spawn` and each run is
+ * timed from spawn to exit, which covers dynamic loading of `libpdxka` and its
+ * dependencies, static initialization, option parsing, and output. Page
+ * faults and peak RSS come from the `rusage` of each child. No network access
+ * is needed since the scenarios either read the test fixture feed with
+ * `--input` or query an in-process daemon serving it. Results are written as
+ * JSON so shared and static builds can be compared.
+ */
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/json.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/testing/server.hh"
+#include "pdxka/version.h"
+
+// environment passed to the spawned executable
+extern char** environ;
+
+namespace {
+
+namespace pt = pdxka::testing;
+
+/**
+ * Struct holding benchmark options.
+ *
+ * @param runs Number of timed runs
+ * @param warmup Number of untimed runs first, e.g. to fill the page cache
+ * @param scenario Scenario name, one of `input`, `daemon`, or `version`
+ * @param exe Path to the executable to spawn
+ * @param output Path to write JSON results to, empty for standard output
+ */
+struct startup_options {
+  unsigned int runs = 200u;
+  unsigned int warmup = 10u;
+  std::string scenario{"input"};
+  std::string exe{PDXKA_STARTUP_EXE};
+  std::string output;
+};
+
+/**
+ * Print usage to standard output.
+ */
+void print_usage()
+{
+  std::cout <<
+    "Usage: pdxka_startup [-n RUNS] [-w WARMUP] [-s SCENARIO] [-x EXE] [-o FILE]\n"
+    "\n"
+    "Measures the spawn-to-exit latency and page faults of " PDXKA_PROGNAME ",\n"
+    "writing results as JSON.\n"
+    "\n"
+    "Options:\n"
+    "  -n RUNS             Timed runs, default 200\n"
+    "  -w WARMUP           Untimed runs first, default 10\n"
+    "  -s SCENARIO         input to parse the test fixture with --input and\n"
+    "                      print the latest comic, daemon to print it from an\n"
+    "                      in-process daemon on the test fixture, or version\n"
+    "                      to print the version, default input\n"
+    "  -x EXE              Executable to spawn, default\n"
+    "                      " PDXKA_STARTUP_EXE "\n"
+    "  -o FILE             Write JSON to FILE instead of standard output" <<
+    std::endl;
+}
+
+/**
+ * Parse a positive integral option value.
+ *
+ * @param name Option name for error messages
+ * @param value Option value
+ *
+ * @throws std::invalid_argument If the value is not a positive integer
+ */
+unsigned int parse_positive(std::string_view name, const char* value)
+{
+  char* end;
+  auto parsed = std::strtoul(value, &end, 10);
+  if (!*value || *end || !parsed)
+    throw std::invalid_argument{
+      std::string{name} + " requires a positive integer, got " + value
+    };
+  return static_cast<unsigned int>(parsed);
+}
+
+/**
+ * Parse command-line options.
+ *
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @returns Options, empty if help was printed
+ *
+ * @throws std::invalid_argument On invalid options
+ */
+std::optional<startup_options> parse_args(int argc, char* argv[])
+{
+  startup_options opts;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg{argv[i]};
+    if (arg == "-h" || arg == "--help") {
+      print_usage();
+      return {};
+    }
+    if (i + 1 >= argc)
+      throw std::invalid_argument{"unknown option or missing value: " + std::string{arg}};
+    auto value = argv[++i];
+    if (arg == "-n")
+      opts.runs = parse_positive(arg, value);
+    else if (arg == "-w")
+      opts.warmup = std::strtoul(value, nullptr, 10);
+    else if (arg == "-s")
+      opts.scenario = value;
+    else if (arg == "-x")
+      opts.exe = value;
+    else if (arg == "-o")
+      opts.output = value;
+    else
+      throw std::invalid_argument{"unknown option: " + std::string{arg}};
+  }
+  if (
+    opts.scenario != "input" && opts.scenario != "daemon" && opts.scenario != "version"
+  )
+    throw std::invalid_argument{"unknown scenario: " + opts.scenario};
+  return opts;
+}
+
+/**
+ * Struct holding the measurements of one run.
+ *
+ * @param wall_us Spawn-to-exit wall time in microseconds
+ * @param cpu_us User plus system CPU time in microseconds
+ * @param minor_faults Minor page faults
+ * @param major_faults Major page faults
+ * @param max_rss_kib Peak resident set size in KiB
+ */
+struct run_result {
+  double wall_us;
+  double cpu_us;
+  double minor_faults;
+  double major_faults;
+  double max_rss_kib;
+};
+
+/**
+ * Spawn a process with standard streams on `/dev/null` and wait for it.
+ *
+ * @param args Program path and arguments
+ *
+ * @throws std::system_error If spawning or waiting fails
+ * @throws std::runtime_error If the process does not exit successfully
+ */
+run_result spawn_once(std::vector<std::string>& args)
+{
+  std::vector<char*> argv;
+  for (auto& arg : args)
+    argv.push_back(arg.data());
+  argv.push_back(nullptr);
+  // file actions are destroyed on scope exit
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  std::unique_ptr<posix_spawn_file_actions_t, int (*)(posix_spawn_file_actions_t*)>
+    actions_guard{&actions, posix_spawn_file_actions_destroy};
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+  // spawn and wait
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid;
+  if (auto err = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ))
+    throw std::system_error{err, std::generic_category(), "posix_spawn " + args[0]};
+  int status;
+  rusage usage;
+  if (wait4(pid, &status, 0, &usage) < 0)
+    throw std::system_error{errno, std::generic_category(), "wait4"};
+  auto stop = std::chrono::steady_clock::now();
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS)
+    throw std::runtime_error{args[0] + " did not exit successfully"};
+  auto micros = [](const timeval& tv)
+  {
+    return 1e6 * static_cast<double>(tv.tv_sec) + static_cast<double>(tv.tv_usec);
+  };
+  return {
+    std::chrono::duration<double, std::micro>(stop - start).count(),
+    micros(usage.ru_utime) + micros(usage.ru_stime),
+    static_cast<double>(usage.ru_minflt),
+    static_cast<double>(usage.ru_majflt),
+    // ru_maxrss is in KiB on Linux but in bytes on macOS
+#if defined(__APPLE__)
+    static_cast<double>(usage.ru_maxrss) / 1024.
+#else
+    static_cast<double>(usage.ru_maxrss)
+#endif  // !defined(__APPLE__)
+  };
+}
+
+/**
+ * Return the given percentile of sorted values.
+ *
+ * @param sorted Sorted values
+ * @param p Percentile in `[0, 100]`
+ */
+double percentile(const std::vector<double>& sorted, double p)
+{
+  if (sorted.empty())
+    return 0.;
+  auto index = static_cast<std::size_t>(p / 100. * static_cast<double>(sorted.size() - 1));
+  return sorted[index];
+}
+
+/**
+ * Append a JSON object with the min, median, p99, and mean of values.
+ *
+ * @param out String to append to
+ * @param name Key to write the object under
+ * @param values Values, which are sorted
+ */
+void append_stats(std::string& out, std::string_view name, std::vector<double>& values)
+{
+  std::sort(values.begin(), values.end());
+  double mean = 0.;
+  for (auto value : values)
+    mean += value / static_cast<double>(values.size());
+  out += ',';
+  pdxka::append_json_string(out, name);
+  out += ":{\"min\":" + std::to_string(values.front()) +
+    ",\"median\":" + std::to_string(percentile(values, 50.)) +
+    ",\"p99\":" + std::to_string(percentile(values, 99.)) +
+    ",\"mean\":" + std::to_string(mean) + "}";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+  try {
+    auto parsed = parse_args(argc, argv);
+    if (!parsed)
+      return EXIT_SUCCESS;
+    const auto& opts = *parsed;
+    // in-process daemon on fixture data for the daemon scenario
+    std::unique_ptr<pt::scoped_server> server;
+    std::vector<std::string> args{opts.exe};
+    if (opts.scenario == "input")
+      args.insert(args.end(), {"--input", pt::rss_fixture_path(), "-o"});
+    else if (opts.scenario == "daemon") {
+      server = std::make_unique<pt::scoped_server>(
+        pdxka::server_options{pt::temp_socket_path(), std::chrono::seconds{900}},
+        [](std::time_t)
+        {
+          return pdxka::curl_result{
+            CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200
+          };
+        }
+      );
+      if (!server->wait_ready())
+        throw std::runtime_error{"in-process daemon did not start"};
+      args.insert(args.end(), {"--socket", server->socket_path(), "-o"});
+    }
+    else
+      args.push_back("-V");
+    // warmup then timed runs
+    for (unsigned int i = 0; i < opts.warmup; i++)
+      spawn_once(args);
+    std::vector<double> wall_us, cpu_us, minor_faults, major_faults, max_rss_kib;
+    for (unsigned int i = 0; i < opts.runs; i++) {
+      auto result = spawn_once(args);
+      wall_us.push_back(result.wall_us);
+      cpu_us.push_back(result.cpu_us);
+      minor_faults.push_back(result.minor_faults);
+      major_faults.push_back(result.major_faults);
+      max_rss_kib.push_back(result.max_rss_kib);
+    }
+    if (server)
+      server->join();
+    // results
+    std::string out{"{\"schema\":1,\"version\":"};
+    pdxka::append_json_string(out, PDXKA_VERSION_STRING);
+    out += ",\"build_type\":";
+    pdxka::append_json_string(out, PDXKA_BUILD_TYPE);
+    out += ",\"system\":";
+    pdxka::append_json_string(out, PDXKA_SYSTEM_ARCH " " PDXKA_SYSTEM_NAME);
+    out += ",\"libpdxka\":";
+    pdxka::append_json_string(out, PDXKA_STARTUP_SHARED ? "shared" : "static");
+    out += ",\"exe\":";
+    pdxka::append_json_string(out, opts.exe);
+    out += ",\"scenario\":";
+    pdxka::append_json_string(out, opts.scenario);
+    out += ",\"runs\":";
+    pdxka::append_json_number(out, opts.runs);
+    append_stats(out, "wall_us", wall_us);
+    append_stats(out, "cpu_us", cpu_us);
+    append_stats(out, "minor_faults", minor_faults);
+    append_stats(out, "major_faults", major_faults);
+    append_stats(out, "max_rss_kib", max_rss_kib);
+    out += "}\n";
+    std::cerr << opts.scenario << ": min " << wall_us.front() << " us, median " <<
+      percentile(wall_us, 50.) << " us, p99 " << percentile(wall_us, 99.) <<
+      " us, " << percentile(minor_faults, 50.) << " minor faults" << std::endl;
+    if (opts.output.empty())
+      std::cout << out << std::flush;
+    else {
+      std::ofstream file{opts.output, std::ios::binary};
+      if (!(file << out))
+        throw std::runtime_error{"error writing " + opts.output};
+    }
+    return EXIT_SUCCESS;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
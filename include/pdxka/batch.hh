@@ -0,0 +1,73 @@
+/**
+ * @file batch.hh
+ * @author Derek Huang
+ * @brief C++ header for answering batches of queries
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_BATCH_HH_
+#define PDXKA_BATCH_HH_
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/output.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+/**
+ * Answer newline-delimited queries, writing exactly one line per query.
+ *
+ * Each input line is a query as accepted by `parse_query`. `latest`, `back`,
+ * and `number` queries are answered with the comic's alt text and GUID as
+ * printed by `xkcd-alt -o`. `search` queries are answered with the GUIDs of
+ * all matching comics separated by spaces, which is an empty line if nothing
+ * matches. Malformed queries and queries selecting no comic are answered with
+ * `error: MESSAGE` so that output line `i` always answers input line `i`.
+ *
+ * Answers are formatted straight into `out` and each ends a record, so the
+ * buffer is written once it holds `out.capacity()` bytes, after every
+ * `flush_every` answers if nonzero, and at the end of input.
+ *
+ * @param snapshot Feed snapshot to answer from
+ * @param in Stream to read queries from
+ * @param out Output buffer to write answers to
+ * @param flush_every Number of answers after which to flush, 0 to only flush
+ *  when the buffer is full or at the end of input
+ * @returns Number of queries answered
+ */
+PDXKA_PUBLIC
+std::size_t run_batch(
+  const feed_snapshot& snapshot,
+  std::istream& in,
+  output_buffer& out,
+  std::size_t flush_every = 0u);
+
+/**
+ * Answer newline-delimited queries, writing exactly one line per query.
+ *
+ * This writes through an `output_buffer` holding `buffer_size` bytes, so
+ * `out` is written to and flushed each time the buffer is flushed.
+ *
+ * @param snapshot Feed snapshot to answer from
+ * @param in Stream to read queries from
+ * @param out Stream to write answers to
+ * @param flush_every Number of answers after which to flush, 0 to only flush
+ *  when the buffer is full or at the end of input
+ * @param buffer_size Number of buffered bytes after which to flush
+ * @returns Number of queries answered
+ */
+PDXKA_PUBLIC
+std::size_t run_batch(
+  const feed_snapshot& snapshot,
+  std::istream& in,
+  std::ostream& out,
+  std::size_t flush_every = 0u,
+  std::size_t buffer_size = output_buffer_size);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_BATCH_HH_
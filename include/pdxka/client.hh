@@ -0,0 +1,42 @@
+/**
+ * @file client.hh
+ * @author Derek Huang
+ * @brief C++ header for the xkcd-alt UNIX domain socket daemon client
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_CLIENT_HH_
+#define PDXKA_CLIENT_HH_
+
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Send a single query to a `xkcd-alt --serve` daemon.
+ *
+ * This is intended as a fast path that the caller can fall back from, so any
+ * failure, e.g. no daemon listening, a timeout, or an `error` response, is
+ * reported only through the return value. No libcurl or XML parsing is done.
+ *
+ * @param socket_path Path of the daemon's UNIX domain socket
+ * @param request Query as accepted by `parse_query`, e.g. `back 1`
+ * @param items RSS items to write the daemon's answer to on success
+ * @param timeout Maximum time to wait on each send or receive
+ * @returns `true` on success, `false` on any failure
+ */
+PDXKA_PUBLIC
+bool query_daemon(
+  const std::string& socket_path,
+  std::string_view request,
+  rss_item_vector& items,
+  std::chrono::milliseconds timeout = std::chrono::milliseconds{1000});
+
+}  // namespace pdxka
+
+#endif  // PDXKA_CLIENT_HH_
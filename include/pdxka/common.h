@@ -22,7 +22,7 @@
  * @param x First argument
  * @param y Second argument
  */
-#define PDXKA_CONCAT(x, y) PDXKA_CONCAT_I(x, y)
+#define PDXKA_CONCAT(x, y) PDXKA_CONCAT_T(x, y)
 
 /**
  * Stringify argument without macro expansion.
@@ -19,6 +19,7 @@
 #include <curl/curl.h>
 
 #include "pdxka/common.h"
+#include "pdxka/trace.hh"
 
 namespace pdxka {
 
@@ -61,6 +62,23 @@ namespace pdxka {
  */
 enum class request_type { get, post };
 
+/**
+ * Struct holding libcurl transfer phase times.
+ *
+ * Each is the time in microseconds from the start of the transfer until the
+ * phase completed, as reported by the `CURLINFO_*_TIME_T` values, or -1 if
+ * unknown, e.g. if the result did not come from a libcurl transfer.
+ * `appconnect` is 0 if there was no TLS handshake.
+ */
+struct curl_times {
+  curl_off_t namelookup = -1;
+  curl_off_t connect = -1;
+  curl_off_t appconnect = -1;
+  curl_off_t pretransfer = -1;
+  curl_off_t starttransfer = -1;
+  curl_off_t total = -1;
+};
+
 /**
  * Struct holding cURL HTTP[S] result.
  *
@@ -68,12 +86,30 @@ enum class request_type { get, post };
  * @param reason `std::string` holding contents of last cURL error buffer
  * @param request `request_type` HTTP[S] request we got result for
  * @param payload `std::string` HTTP[S] response body
+ * @param response_code `long` HTTP[S] response code, 0 if none was received
+ * @param file_time `curl_off_t` remote document time as a UNIX timestamp, -1
+ *  if unknown. Only retrieved if `CURLOPT_FILETIME` is enabled.
+ * @param times `curl_times` transfer phase times
  */
 struct curl_result {
   CURLcode status;
   std::string reason;
   request_type request;
   std::string payload;
+  long response_code = 0;
+  curl_off_t file_time = -1;
+  curl_times times{};
+
+  /**
+   * Return `true` if a conditional request was answered with not modified.
+   *
+   * This is the case when `CURLOPT_TIMECONDITION` was set and the server
+   * responded with `304 Not Modified`, i.e. there is no new payload.
+   */
+  bool not_modified() const noexcept
+  {
+    return status == CURLE_OK && response_code == 304;
+  }
 };
 
 /**
@@ -279,6 +315,7 @@ inline std::size_t curl_writer(
   // error if either incoming buffer or stream are NULL
   if (!incoming || !stream)
     return 0;
+  PDXKA_TRACE_SPAN_ARG("curl_write", n_items);
   // counter/number of items read before exception
   std::size_t n = 0;
   // since incoming is not NULL-terminated, just put each char into stream. C
@@ -306,12 +343,18 @@ inline std::size_t curl_writer(
 template <typename... Ts>
 curl_result curl_get(const std::string& url, const curl_option<Ts>&... options)
 {
+  // whole request, where the time outside curl_perform is handle setup
+  PDXKA_TRACE_SPAN("curl_get");
   // cURL session handle and global error status
   curl_handle handle;
   CURLcode status;
   // reason the cURL request has errored out + stream to hold response body
   std::string reason;
   std::stringstream stream;
+  // HTTP[S] response code + remote document time (if requested)
+  long response_code = 0;
+  curl_off_t file_time = -1;
+  curl_times times;
   // set cURL error buffer, callback writer function, and the write target
   char errbuf[CURL_ERROR_SIZE];
   curl_easy_setopt(handle, CURLOPT_ERRORBUFFER, &errbuf);
@@ -336,10 +379,32 @@ curl_result curl_get(const std::string& url, const curl_option<Ts>&... options)
   // check last error and clean up if necessary
   PDXKA_CURL_ERR_HANDLER(status, reason, errbuf, done);
   // perform GET request
-  status = curl_easy_perform(handle);
+  {
+    PDXKA_TRACE_SPAN("curl_perform");
+    status = curl_easy_perform(handle);
+  }
   PDXKA_CURL_ERR_HANDLER(status, reason, errbuf, done);
+  // transfer info. file time is -1 unless CURLOPT_FILETIME was set
+  curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &response_code);
+  curl_easy_getinfo(handle, CURLINFO_FILETIME_T, &file_time);
 done:
-  return {status, reason, request_type::get, stream.str()};
+  // phase times, cumulative from the start of the transfer. also retrieved
+  // on error since e.g. the DNS resolution time is still informative
+  curl_easy_getinfo(handle, CURLINFO_NAMELOOKUP_TIME_T, &times.namelookup);
+  curl_easy_getinfo(handle, CURLINFO_CONNECT_TIME_T, &times.connect);
+  curl_easy_getinfo(handle, CURLINFO_APPCONNECT_TIME_T, &times.appconnect);
+  curl_easy_getinfo(handle, CURLINFO_PRETRANSFER_TIME_T, &times.pretransfer);
+  curl_easy_getinfo(handle, CURLINFO_STARTTRANSFER_TIME_T, &times.starttransfer);
+  curl_easy_getinfo(handle, CURLINFO_TOTAL_TIME_T, &times.total);
+  return {
+    status,
+    reason,
+    request_type::get,
+    stream.str(),
+    response_code,
+    file_time,
+    times
+  };
 }
 
 }  // namespace pdkxa
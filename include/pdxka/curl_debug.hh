@@ -0,0 +1,172 @@
+/**
+ * @file curl_debug.hh
+ * @author Derek Huang
+ * @brief C++ header for structured capture of libcurl debug output
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_CURL_DEBUG_HH_
+#define PDXKA_CURL_DEBUG_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/dllexport.h"
+
+namespace pdxka {
+
+/**
+ * Return the name of a libcurl debug info type, e.g. `"header_in"`.
+ *
+ * @param type libcurl debug info type
+ * @returns Name, `"unknown"` for unknown types
+ */
+PDXKA_PUBLIC
+std::string_view curl_debug_type_name(curl_infotype type) noexcept;
+
+/**
+ * Struct holding a libcurl debug event.
+ *
+ * Informational text and header lines are kept without the line ending while
+ * for data, both plain and TLS, only the byte count is kept.
+ *
+ * @param time Microseconds since the log was created
+ * @param type libcurl debug info type
+ * @param text Text or header line, empty for data
+ * @param size Number of bytes libcurl passed for the event
+ */
+struct curl_debug_event {
+  std::uint64_t time;
+  curl_infotype type;
+  std::string text;
+  std::size_t size;
+};
+
+/**
+ * In-memory log of libcurl debug output.
+ *
+ * Instead of libcurl writing free-form verbose output to standard error, the
+ * log records each informational message, each request and response header
+ * line, and the sizes of data and TLS records sent and received, so that
+ * redirects, content encoding, connection reuse, etc. can be analyzed from
+ * the JSON dump. Use it with `curl_get` by passing its `options()`, e.g.
+ *
+ * @code{.cc}
+ * curl_debug_log log;
+ * auto [verbose, function, data] = log.options();
+ * auto res = curl_get(url, verbose, function, data);
+ * auto json = log.json();
+ * @endcode
+ *
+ * @note A log must only be attached to one easy handle at a time.
+ */
+class PDXKA_PUBLIC curl_debug_log {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Ctor.
+   *
+   * Event times are relative to when the log is constructed.
+   */
+  curl_debug_log()
+    : start_{clock::now()},
+      start_unix_{
+        std::chrono::duration_cast<std::chrono::microseconds>(
+          std::chrono::system_clock::now().time_since_epoch()
+        ).count()
+      }
+  {}
+
+  /**
+   * Return the recorded events in order.
+   */
+  const auto& events() const noexcept { return events_; }
+
+  /**
+   * Return the total number of bytes recorded for a debug info type.
+   *
+   * @param type libcurl debug info type
+   */
+  std::size_t bytes(curl_infotype type) const noexcept;
+
+  /**
+   * Record a libcurl debug callback invocation.
+   *
+   * Header blocks are split into one event per line and empty lines, e.g. the
+   * blank line ending a request header, are dropped.
+   *
+   * @param type libcurl debug info type
+   * @param data Data libcurl passed, not null-terminated
+   */
+  void record(curl_infotype type, std::string_view data);
+
+  /**
+   * Discard all recorded events.
+   */
+  void clear() noexcept { events_.clear(); }
+
+  /**
+   * Return the log as a JSON object.
+   *
+   * The object has the wall-clock `start` time in UNIX microseconds, the
+   * `events` array, and `bytes` totals for each debug info type. Each event
+   * has a `time` in microseconds since `start`, its `type` name, and either
+   * its `text` or for data its `bytes`.
+   */
+  std::string json() const;
+
+  /**
+   * Write the log as a JSON object to a file.
+   *
+   * @param path File path
+   *
+   * @throws std::runtime_error On write failure
+   */
+  void write(const std::string& path) const;
+
+  /**
+   * libcurl `CURLOPT_DEBUGFUNCTION` callback recording into a log.
+   *
+   * @param handle Easy handle (unused)
+   * @param type libcurl debug info type
+   * @param data Data libcurl passed, not null-terminated
+   * @param size Number of bytes in `data`
+   * @param log `curl_debug_log*` set with `CURLOPT_DEBUGDATA`
+   * @returns Always 0, as libcurl requires
+   */
+  static int callback(
+    CURL* handle, curl_infotype type, char* data, std::size_t size, void* log) noexcept;
+
+  /**
+   * Return the `curl_get` options to record an easy handle's debug output.
+   *
+   * These enable `CURLOPT_VERBOSE`, without which libcurl does not call the
+   * debug callback, and set this log as the callback's target.
+   */
+  auto options() noexcept
+  {
+    return std::make_tuple(
+      curl_option<long>{CURLOPT_VERBOSE, 1L},
+      curl_option<curl_debug_callback>{CURLOPT_DEBUGFUNCTION, callback},
+      curl_option<void*>{CURLOPT_DEBUGDATA, this}
+    );
+  }
+
+private:
+  clock::time_point start_;
+  std::int64_t start_unix_;
+  std::vector<curl_debug_event> events_;
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_CURL_DEBUG_HH_
@@ -0,0 +1,39 @@
+/**
+ * @file features.h
+ * @author Derek Huang
+ * @brief C/C++ header for pdxka features
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_FEATURES_H_
+#define PDXKA_FEATURES_H_
+
+/**
+ * Indicates whether the `pdkxa` project is using `boost_program_options`.
+ */
+#define PDXKA_USE_BOOST_PROGRAM_OPTIONS 0
+
+/**
+ * Indicates whether trace spans are compiled into `libpdxka`.
+ */
+#define PDXKA_TRACING 1
+
+/**
+ * Indicate whether we are compiling on Windows.
+ */
+#if defined(_WIN32)
+#define PDXKA_WIN32 1
+#else
+#define PDXKA_WIN32 0
+#endif  // !defined(_WIN32)
+
+/**
+ * Indicate whether we are compiling on Linux.
+ */
+#if defined(__linux__)
+#define PDXKA_LINUX 1
+#else
+#define PDXKA_LINUX 0
+#endif  // !defined(__linux__)
+
+#endif  // PDXKA_FEATURES_H_
@@ -0,0 +1,145 @@
+/**
+ * @file format.hh
+ * @author Derek Huang
+ * @brief C++ header for machine-readable output formats of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_FORMAT_HH_
+#define PDXKA_FORMAT_HH_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/output.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/template.hh"
+
+namespace pdxka {
+
+/**
+ * Enum class for the formats comics can be printed in.
+ *
+ * `text` is the alt text and attestation, `json` is a JSON array of objects,
+ * `ndjson` is one JSON object per line, and `csv` and `tsv` are delimited
+ * records following a header row. The machine-readable formats contain all of
+ * the `rss_item` fields plus the comic number.
+ */
+enum class output_format { text, json, ndjson, csv, tsv };
+
+/**
+ * Return the output format with the given name.
+ *
+ * @param name One of `text`, `json`, `ndjson`, `csv`, or `tsv`
+ *
+ * @throws std::invalid_argument If the name is not a known format
+ */
+PDXKA_PUBLIC
+output_format parse_output_format(std::string_view name);
+
+/**
+ * Append a string as a CSV field.
+ *
+ * Fields containing commas, quotes, or line breaks are quoted with embedded
+ * quotes doubled as in RFC 4180. Other fields are copied unchanged.
+ *
+ * @param out String to append to
+ * @param value Field value
+ */
+PDXKA_PUBLIC
+void append_csv_field(std::string& out, std::string_view value);
+
+/**
+ * Append a string as a TSV field.
+ *
+ * Backslashes, tabs, newlines, and carriage returns are escaped as `\\`,
+ * `\t`, `\n`, and `\r` so that each record stays on one line.
+ *
+ * @param out String to append to
+ * @param value Field value
+ */
+PDXKA_PUBLIC
+void append_tsv_field(std::string& out, std::string_view value);
+
+/**
+ * Append an RSS item's alt text and attestation.
+ *
+ * @param out String to append to
+ * @param item RSS item to format
+ * @param one_line `true` to write on one line, `false` to write fortune-style
+ *  with the alt text wrapped at 80 columns
+ */
+PDXKA_PUBLIC
+void append_text(std::string& out, const rss_item& item, bool one_line);
+
+/**
+ * Writer formatting RSS items straight into an output buffer.
+ *
+ * Fields are encoded directly into the buffer with no intermediate strings
+ * and each item is ended as a record, so output is only written when the
+ * buffer fills or is flushed. CSV and TSV header rows and the JSON array
+ * brackets are written by the writer as needed.
+ */
+class PDXKA_PUBLIC record_writer {
+public:
+  /**
+   * Ctor.
+   *
+   * @param out Output buffer to write to, which must outlive the writer
+   * @param format Output format
+   * @param one_line `true` to write `text` items on one line
+   */
+  record_writer(output_buffer& out, output_format format, bool one_line = false) noexcept
+    : out_{out}, format_{format}, one_line_{one_line}, template_{}, count_{}
+  {}
+
+  /**
+   * Ctor for writing items rendered with a compiled template.
+   *
+   * No newline is added after each item, so the template should end in one.
+   *
+   * @param out Output buffer to write to, which must outlive the writer
+   * @param tmpl Compiled template, which must outlive the writer
+   */
+  record_writer(output_buffer& out, const compiled_template& tmpl) noexcept
+    : out_{out}, format_{output_format::text}, one_line_{}, template_{&tmpl}, count_{}
+  {}
+
+  /**
+   * Write an RSS item, preceded by the header if this is the first item.
+   *
+   * @param item RSS item to write
+   */
+  void write(const rss_item& item);
+
+  /**
+   * Finish the output, closing the JSON array if necessary.
+   *
+   * This writes the header of an empty CSV or TSV table or an empty JSON
+   * array if no items were written. Output is not flushed.
+   */
+  void finish();
+
+  /**
+   * Return the number of items written.
+   */
+  auto count() const noexcept { return count_; }
+
+private:
+  output_buffer& out_;
+  output_format format_;
+  bool one_line_;
+  const compiled_template* template_;
+  std::size_t count_;
+
+  /**
+   * Write the CSV or TSV header row or the JSON array opening bracket.
+   */
+  void begin();
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_FORMAT_HH_
@@ -0,0 +1,164 @@
+/**
+ * @file fortune.hh
+ * @author Derek Huang
+ * @brief C++ header for exporting XKCD alt text as a fortune(6) database
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_FORTUNE_HH_
+#define PDXKA_FORTUNE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Version written in the header of `strfile` index files.
+ */
+inline constexpr std::uint32_t strfile_version = 2u;
+
+/**
+ * Size in bytes of the `strfile` index file header.
+ */
+inline constexpr std::size_t strfile_header_size = 24u;
+
+/**
+ * Offset index of a fortune cookie file as written by `strfile(1)`.
+ *
+ * A cookie file holds cookies each followed by a `%` delimiter line. The
+ * index holds the offset of each cookie plus a final offset at the end of the
+ * file, along with the longest and shortest cookie sizes, so `fortune` can
+ * seek straight to a random cookie.
+ *
+ * The serialized form matches fortune-mod's `strfile`: a header of five
+ * big-endian 32-bit words, i.e. version, cookie count, longest size,
+ * shortest size, and flags, followed by the delimiter character and three
+ * padding bytes, then the big-endian 32-bit offsets.
+ */
+class PDXKA_PUBLIC strfile_index {
+public:
+  /**
+   * Default ctor, for an empty cookie file.
+   */
+  strfile_index() : offsets_{0u}, longest_{}, shortest_{no_cookies} {}
+
+  /**
+   * Add the next cookie.
+   *
+   * @param size Cookie size in bytes, including its final newline but not the
+   *  delimiter line that follows it
+   *
+   * @throws std::runtime_error If the cookie file would grow past what 32-bit
+   *  offsets can address
+   */
+  void add(std::uint32_t size);
+
+  /**
+   * Return the number of cookies.
+   */
+  std::size_t count() const noexcept { return offsets_.size() - 1u; }
+
+  /**
+   * Return the cookie offsets followed by the cookie file size.
+   */
+  const auto& offsets() const noexcept { return offsets_; }
+
+  /**
+   * Return the size of the longest cookie.
+   */
+  auto longest() const noexcept { return longest_; }
+
+  /**
+   * Return the size of the shortest cookie, 0 if there are no cookies.
+   */
+  std::uint32_t shortest() const noexcept
+  {
+    return (shortest_ == no_cookies) ? 0u : shortest_;
+  }
+
+  /**
+   * Return the index serialized in the `strfile` `.dat` format.
+   */
+  std::string serialize() const;
+
+  /**
+   * Parse an index serialized in the `strfile` `.dat` format.
+   *
+   * @param data Serialized index
+   *
+   * @throws std::runtime_error If the data is not a version 2 `strfile` index
+   *  delimited by `%`
+   */
+  static strfile_index parse(std::string_view data);
+
+  /**
+   * Build the index of a cookie file by scanning for its delimiter lines.
+   *
+   * Empty cookies are skipped as `strfile` does.
+   *
+   * @param cookies Cookie file contents
+   */
+  static strfile_index scan(std::string_view cookies);
+
+private:
+  static constexpr auto no_cookies = std::numeric_limits<std::uint32_t>::max();
+  std::vector<std::uint32_t> offsets_;
+  std::uint32_t longest_;
+  std::uint32_t shortest_;
+
+  /**
+   * Add a cookie given the offset following its delimiter line.
+   *
+   * @param next Offset of the next cookie
+   * @param size Cookie size in bytes
+   *
+   * @throws std::runtime_error If `next` does not fit in 32 bits
+   */
+  void push(std::uint64_t next, std::uint32_t size);
+};
+
+/**
+ * Struct holding the result of a fortune export.
+ *
+ * @param added Number of cookies appended
+ * @param total Number of cookies in the cookie file after the export
+ */
+struct fortune_export_result {
+  std::size_t added;
+  std::size_t total;
+};
+
+/**
+ * Export RSS items as a fortune cookie file and its `strfile` index.
+ *
+ * Each cookie is the fortune-style alt text and attestation printed by
+ * default. The export is incremental: only items newer than the last cookie
+ * already in the file, identified by GUID, are appended, oldest first, and
+ * then the `.dat` index is rewritten. The existing index is extended when it
+ * matches the cookie file, otherwise the cookie file is rescanned.
+ *
+ * @param dir Directory to write the cookie file and index to
+ * @param items RSS items, most recent first
+ * @param name Cookie file name, where the index is `name` plus `.dat`
+ *
+ * @throws std::runtime_error On I/O errors or if the cookie file grows past
+ *  what 32-bit offsets can address
+ */
+PDXKA_PUBLIC
+fortune_export_result export_fortune(
+  const std::filesystem::path& dir,
+  const rss_item_vector& items,
+  std::string_view name = "xkcd");
+
+}  // namespace pdxka
+
+#endif  // PDXKA_FORTUNE_HH_
@@ -0,0 +1,181 @@
+/**
+ * @file http_server.hh
+ * @author Derek Huang
+ * @brief C++ header for the xkcd-alt HTTP/JSON server
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_HTTP_SERVER_HH_
+#define PDXKA_HTTP_SERVER_HH_
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+#include "pdxka/server.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+/**
+ * Struct holding HTTP server options.
+ *
+ * @param address Numeric IPv4 or IPv6 address to listen on
+ * @param port TCP port to listen on, 0 for any free port
+ * @param workers Number of worker threads, each with its own event loop and
+ *  its own `SO_REUSEPORT` listening socket if there is more than one
+ * @param refresh_interval Interval between conditional feed refreshes
+ */
+struct http_server_options {
+  std::string address{"127.0.0.1"};
+  unsigned short port = 8080u;
+  unsigned int workers = 1u;
+  std::chrono::seconds refresh_interval{900};
+};
+
+/**
+ * Parse a `HOST:PORT` listening endpoint into HTTP server options.
+ *
+ * IPv6 addresses must be enclosed in brackets, e.g. `[::1]:8080`.
+ *
+ * @param endpoint Endpoint, e.g. `127.0.0.1:8080`
+ * @param options HTTP server options to set address and port for
+ *
+ * @throws std::invalid_argument If the endpoint is malformed
+ */
+PDXKA_PUBLIC
+void parse_endpoint(std::string_view endpoint, http_server_options& options);
+
+/**
+ * Struct holding the status and JSON body of an HTTP response.
+ *
+ * @param status HTTP status code
+ * @param body JSON response body
+ */
+struct http_response {
+  int status;
+  std::string body;
+};
+
+/**
+ * Return the HTTP response for a request.
+ *
+ * The supported `GET` or `HEAD` routes are `/latest`, `/back/{n}`,
+ * `/comic/{n}`, and `/search?q=TEXT`. The first three respond with a single
+ * JSON object as written by `append_json` while `/search` responds with a
+ * JSON array of all matches. Errors respond with `{"error": MESSAGE}`.
+ *
+ * @param snapshot Feed snapshot to answer from
+ * @param method Request method
+ * @param target Request target, e.g. `/back/2`
+ */
+PDXKA_PUBLIC
+http_response handle_http_request(
+  const feed_snapshot& snapshot, std::string_view method, std::string_view target);
+
+/**
+ * HTTP/1.1 server answering XKCD RSS item queries with JSON.
+ *
+ * The parsed feed is held in memory and refreshed periodically on the thread
+ * calling `run()`, which publishes each new `feed_snapshot` through a
+ * `snapshot_cell` so workers never wait on a refresh. Each worker thread runs
+ * a single-threaded `epoll` loop supporting persistent connections and
+ * pipelined requests.
+ */
+class PDXKA_PUBLIC http_server {
+public:
+  /**
+   * Ctor.
+   *
+   * Nothing is bound or fetched until `run()` is called.
+   *
+   * @param options HTTP server options
+   * @param fetcher Callable to fetch the XKCD RSS XML with
+   *
+   * @throws std::runtime_error If the wakeup pipe cannot be created
+   */
+  http_server(http_server_options options, feed_fetcher fetcher);
+
+  /**
+   * Deleted copy ctor.
+   */
+  http_server(const http_server&) = delete;
+
+  /**
+   * Dtor.
+   */
+  ~http_server();
+
+  /**
+   * Fetch the feed, start listening, and serve clients until stopped.
+   *
+   * @throws std::runtime_error If the initial fetch, parse, or bind fails
+   */
+  void run();
+
+  /**
+   * Request that `run()` return.
+   *
+   * This only writes to a pipe and so is async-signal-safe.
+   */
+  void stop() noexcept;
+
+  /**
+   * Return the port being listened on, 0 if not yet listening.
+   */
+  unsigned short port() const noexcept { return port_; }
+
+  /**
+   * Return the HTTP server options.
+   */
+  const auto& options() const noexcept { return options_; }
+
+  /**
+   * Return the feed snapshot currently being served, `nullptr` if none.
+   */
+  auto snapshot() const noexcept { return snapshot_.load(); }
+
+private:
+  http_server_options options_;
+  feed_fetcher fetcher_;
+  snapshot_cell snapshot_;
+  std::time_t modified_;
+  std::atomic<unsigned short> port_;
+  int wakeup_fds_[2];
+
+  /**
+   * Conditionally fetch the feed and publish a new snapshot if it has changed.
+   *
+   * @returns `true` if a new snapshot was published
+   * @throws std::runtime_error If the fetch or the parse fails
+   */
+  bool refresh();
+
+  /**
+   * Run a worker event loop on a listening socket until stopped.
+   *
+   * @param listen_fd Non-blocking listening socket
+   */
+  void serve_worker(int listen_fd);
+};
+
+/**
+ * Run an `http_server` until `SIGINT` or `SIGTERM` is received.
+ *
+ * Errors are printed to standard error.
+ *
+ * @param options HTTP server options
+ * @param fetcher Callable to fetch the XKCD RSS XML with
+ * @returns `EXIT_SUCCESS` on clean shutdown, `EXIT_FAILURE` on error
+ */
+PDXKA_PUBLIC
+int serve_http(const http_server_options& options, const feed_fetcher& fetcher);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_HTTP_SERVER_HH_
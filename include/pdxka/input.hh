@@ -0,0 +1,112 @@
+/**
+ * @file input.hh
+ * @author Derek Huang
+ * @brief C++ header for reading the RSS feed from a file or standard input
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_INPUT_HH_
+#define PDXKA_INPUT_HH_
+
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include "pdxka/curl.hh"
+#include "pdxka/dllexport.h"
+
+namespace pdxka {
+
+/**
+ * Read-only contents of an RSS feed file or of standard input.
+ *
+ * Non-empty regular files are memory-mapped so that the feed can be passed to
+ * `parse_rss` without first being copied into a string. Standard input, which
+ * is given by the path `-`, and files that cannot be mapped, e.g. pipes, are
+ * read into an owned buffer instead.
+ */
+class PDXKA_PUBLIC feed_input {
+public:
+  /**
+   * Ctor.
+   *
+   * @param path File path, `-` for standard input
+   *
+   * @throws std::runtime_error If the file cannot be opened or read
+   */
+  explicit feed_input(const std::string& path);
+
+  /**
+   * Deleted copy ctor.
+   */
+  feed_input(const feed_input&) = delete;
+
+  /**
+   * Move ctor.
+   */
+  feed_input(feed_input&& other) noexcept;
+
+  /**
+   * Move assignment operator.
+   */
+  feed_input& operator=(feed_input&& other) noexcept;
+
+  /**
+   * Dtor.
+   *
+   * Unmaps the file if it was mapped.
+   */
+  ~feed_input();
+
+  /**
+   * Return a view of the contents, valid for the lifetime of the input.
+   */
+  std::string_view view() const noexcept { return view_; }
+
+  /**
+   * Return `true` if the contents are memory-mapped.
+   */
+  bool mapped() const noexcept { return map_ != nullptr; }
+
+  /**
+   * Return the last modification time, -1 for standard input.
+   */
+  std::time_t file_time() const noexcept { return file_time_; }
+
+private:
+  void* map_ = nullptr;
+  std::size_t map_size_ = 0u;
+  std::string buffer_;
+  std::string_view view_;
+  std::time_t file_time_ = -1;
+
+  /**
+   * Unmap the file if it was mapped.
+   */
+  void unmap() noexcept;
+};
+
+/**
+ * Read an RSS feed from a file or standard input as a `curl_result`.
+ *
+ * This lets a file replace the network wherever an `rss_provider` or daemon
+ * fetcher is expected. On success the `status` is `CURLE_OK` with a 200
+ * response code and the file's modification time as the `file_time`, and if
+ * the file was not modified after `modified_since` a 304 response with an
+ * empty payload is returned without reading the file, so refreshes of an
+ * unchanged file are cheap. On failure the `status` is `CURLE_READ_ERROR`
+ * and the `reason` has the error message.
+ *
+ * @note Since the contents are copied into the payload, prefer `feed_input`
+ *  when the feed only needs to be parsed once.
+ *
+ * @param path File path, `-` for standard input
+ * @param modified_since UNIX time for a conditional read, 0 for none
+ */
+PDXKA_PUBLIC
+curl_result read_input(const std::string& path, std::time_t modified_since = 0);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_INPUT_HH_
@@ -0,0 +1,58 @@
+/**
+ * @file json.hh
+ * @author Derek Huang
+ * @brief C++ header for JSON encoding of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_JSON_HH_
+#define PDXKA_JSON_HH_
+
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Append a string as a quoted and escaped JSON string.
+ *
+ * Quotes, backslashes, and control characters are escaped. Other bytes,
+ * including non-ASCII UTF-8 sequences, are copied through unchanged. Runs
+ * of bytes needing no escaping are found with `find_special` and copied in
+ * bulk rather than a character at a time.
+ *
+ * @param out String to append to
+ * @param value String value to encode
+ */
+PDXKA_PUBLIC
+void append_json_string(std::string& out, std::string_view value);
+
+/**
+ * Append an unsigned integer as a JSON number.
+ *
+ * Digits are formatted with `std::to_chars` without any allocation.
+ *
+ * @param out String to append to
+ * @param value Value to encode
+ */
+PDXKA_PUBLIC
+void append_json_number(std::string& out, unsigned long value);
+
+/**
+ * Append an RSS item as a JSON object.
+ *
+ * The object has the `number`, `title`, `link`, `img_src`, `img_title`,
+ * `img_alt`, `pub_date`, and `guid` keys, in that order.
+ *
+ * @param out String to append to
+ * @param item RSS item to encode
+ */
+PDXKA_PUBLIC
+void append_json(std::string& out, const rss_item& item);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_JSON_HH_
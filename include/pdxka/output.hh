@@ -0,0 +1,144 @@
+/**
+ * @file output.hh
+ * @author Derek Huang
+ * @brief C++ header for buffered output written straight to a file descriptor
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_OUTPUT_HH_
+#define PDXKA_OUTPUT_HH_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+
+namespace pdxka {
+
+/**
+ * Default number of buffered output bytes after which a record flushes.
+ */
+inline constexpr std::size_t output_buffer_size = 65536u;
+
+/**
+ * Output buffer that formatters write into directly.
+ *
+ * Results are formatted into a buffer allocated once up front and are only
+ * written when `flush()` is called or when `end_record()` finds the buffer
+ * holds at least `capacity()` bytes, so each result or batch of results is
+ * emitted with a single `write` call and nothing is flushed per line.
+ *
+ * Output goes either straight to a file descriptor, bypassing iostreams, or
+ * to a `std::ostream`, which is then flushed. The latter is for callers, e.g.
+ * tests, that redirect `std::cout`.
+ */
+class PDXKA_PUBLIC output_buffer {
+public:
+  /**
+   * Ctor for writing to a file descriptor.
+   *
+   * @param fd File descriptor to write to, not owned
+   * @param capacity Number of buffered bytes at which a record flushes
+   */
+  explicit output_buffer(int fd, std::size_t capacity = output_buffer_size);
+
+  /**
+   * Ctor for writing to a stream.
+   *
+   * @param out Stream to write to, which must outlive the buffer
+   * @param capacity Number of buffered bytes at which a record flushes
+   */
+  explicit output_buffer(std::ostream& out, std::size_t capacity = output_buffer_size);
+
+  /**
+   * Move ctor.
+   */
+  output_buffer(output_buffer&& other) noexcept;
+
+  /**
+   * Deleted copy ctor.
+   */
+  output_buffer(const output_buffer&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Flushes any buffered output, ignoring errors.
+   */
+  ~output_buffer();
+
+  /**
+   * Return the buffer for formatters to append to directly.
+   */
+  auto& buffer() noexcept { return buffer_; }
+
+  /**
+   * Append text to the buffer.
+   *
+   * @param text Text to append
+   */
+  void append(std::string_view text) { buffer_.append(text); }
+
+  /**
+   * Append a character to the buffer.
+   *
+   * @param c Character to append
+   */
+  void put(char c) { buffer_.push_back(c); }
+
+  /**
+   * Mark the end of a record, flushing if the buffer is full.
+   *
+   * Records are never split across writes unless a single record is larger
+   * than the capacity, in which case the buffer grows to hold it.
+   *
+   * @returns `true` if the buffer was flushed
+   */
+  bool end_record()
+  {
+    if (buffer_.size() < capacity_)
+      return false;
+    flush();
+    return true;
+  }
+
+  /**
+   * Write all buffered output.
+   *
+   * Nothing is written if the buffer is empty. When writing to a file
+   * descriptor, short writes and `EINTR` are retried.
+   *
+   * @throws std::runtime_error If writing fails
+   */
+  void flush();
+
+  /**
+   * Return the number of buffered bytes at which a record flushes.
+   */
+  auto capacity() const noexcept { return capacity_; }
+
+private:
+  int fd_;
+  std::ostream* stream_;
+  std::size_t capacity_;
+  std::string buffer_;
+};
+
+/**
+ * Return an output buffer for standard output.
+ *
+ * This writes straight to file descriptor 1 unless `std::cout` has had its
+ * stream buffer replaced, e.g. by a test, in which case it writes to
+ * `std::cout`. Anything already buffered in `std::cout` is flushed first so
+ * output stays in order.
+ *
+ * @param capacity Number of buffered bytes at which a record flushes
+ */
+PDXKA_PUBLIC
+output_buffer stdout_buffer(std::size_t capacity = output_buffer_size);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_OUTPUT_HH_
@@ -8,10 +8,14 @@
 #ifndef PDXKA_PROGRAM_MAIN_HH_
 #define PDXKA_PROGRAM_MAIN_HH_
 
+#include <ctime>
 #include <functional>
+#include <optional>
+#include <string>
 
 #include "pdxka/curl.hh"
 #include "pdxka/dllexport.h"
+#include "pdxka/format.hh"
 
 namespace pdxka {
 
@@ -20,14 +24,72 @@ namespace pdxka {
  *
  * @param one_line Flag to indicate if output should be printed on one line
  * @param previous Number of XKCD strips to go back from today's strip
+ * @param previous_last Number of XKCD strips to go back for the last strip
+ *  printed, where strips `previous` through `previous_last` are printed
+ * @param all Flag to print every strip in the feed instead of `previous`
+ * @param random Number of distinct strips to print chosen uniformly at random
+ *  instead of `previous`, 0 to not select strips at random
+ * @param seed Seed for random selection, empty to use `std::random_device`
+ * @param fortune_dir Directory to export a fortune cookie file and `strfile`
+ *  index to with the `export` command, empty if not exporting
  * @param verbose Flag to operate cURL in verbose mode
+ * @param curl_log_path File to write a JSON log of libcurl debug events for
+ *  the most recent request to, empty if not logging
  * @param insecure Flag to allow skip cURL verification of server SSL cert
+ * @param timing Flag to print a per-phase latency breakdown to standard error
+ * @param trace_path File to write a Chrome trace of internal spans to on exit,
+ *  empty if not tracing
+ * @param serve_path UNIX domain socket path to serve from, empty if not serving
+ * @param refresh Number of seconds between feed refreshes when serving
+ * @param socket_path UNIX domain socket path of a daemon to try before making
+ *  a network request, empty to always use the network
+ * @param input_path File to read the RSS feed from instead of the network, `-`
+ *  for standard input, empty to use the `rss_provider`
+ * @param cache_path Cache file to share the feed between runs through, empty
+ *  to not cache
+ * @param cache_ttl Number of seconds a cache file is used for
+ * @param http_endpoint `HOST:PORT` to serve HTTP/JSON from, empty if not
+ *  serving over HTTP
+ * @param workers Number of HTTP server worker threads
+ * @param batch Flag to answer newline-delimited queries read from standard
+ *  input after fetching the feed once
+ * @param flush_every Number of batch answers after which output is flushed,
+ *  0 to only flush when the output buffer is full or at the end of input
+ * @param watch Flag to stay resident and print each new comic as it appears
+ * @param format Format to print comics in
+ * @param output_template `--template` text to print comics with, empty to use
+ *  `format` instead
+ * @param modified_since UNIX time for a conditional request, 0 for none. This
+ *  is not a command-line option but is set by long-running modes so that the
+ *  `rss_provider` can avoid refetching an unchanged feed.
  */
 struct cliopts {
   bool one_line = false;
   unsigned int previous = 1u;
+  unsigned int previous_last = 1u;
+  bool all = false;
+  unsigned int random = 0u;
+  std::optional<unsigned int> seed;
+  std::string fortune_dir;
   bool verbose = false;
+  std::string curl_log_path;
   bool insecure = false;
+  bool timing = false;
+  std::string trace_path;
+  std::string serve_path;
+  unsigned int refresh = 900u;
+  std::string socket_path;
+  std::string input_path;
+  std::string cache_path;
+  unsigned int cache_ttl = 900u;
+  std::string http_endpoint;
+  unsigned int workers = 1u;
+  bool batch = false;
+  unsigned int flush_every = 0u;
+  bool watch = false;
+  output_format format = output_format::text;
+  std::string output_template;
+  std::time_t modified_since = 0;
 };
 
 /**
@@ -39,6 +101,10 @@ using rss_provider = std::function<curl_result(const cliopts&)>;
  * `pdxka` CLI tool program main.
  *
  * This provides a hook for mocking in tests to avoid an actual network call.
+ * If `--input` is given the provider is not used and the feed is read from
+ * the file or standard input instead. If the first argument is `export`, the
+ * remaining arguments are parsed as options for the export command, which
+ * requires `--fortune DIR`.
  *
  * @param argc `argc` argument count from `main()`
  * @param argv `argv` argument vector from `main()`
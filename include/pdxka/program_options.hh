@@ -23,6 +23,16 @@
 #include <vector>
 #endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
 
+/**
+ * Environment variable holding the default for the `--socket` option.
+ */
+#define PDXKA_SOCKET_ENV "XKCD_ALT_SOCKET"
+
+/**
+ * Environment variable holding the default for the `--cache` option.
+ */
+#define PDXKA_CACHE_ENV "XKCD_ALT_CACHE"
+
 namespace pdxka {
 
 #if PDXKA_USE_BOOST_PROGRAM_OPTIONS
@@ -80,8 +90,16 @@ inline const auto& program_description()
     "Usage: " PDXKA_PROGNAME
 #if PDXKA_USE_BOOST_PROGRAM_OPTIONS
     " [OPTION...]\n"
+    "       " PDXKA_PROGNAME " export --fortune DIR [OPTION...]\n"
 #else
-    " [-h] [-b[ ][BACK]] [-o] [-v] [-k]\n"
+    " [-h] [-b[ ][BACK] | --all | --random [N] [--seed SEED]] [-o]\n"
+    "         [--format FMT | --template TMPL] [--batch [--flush-every N]]\n"
+    "         [--watch] [-v | --curl-log FILE] [-k] [--timing] [--trace FILE]\n"
+    "         [--input FILE] [--cache FILE [--cache-ttl SECS]] [--socket PATH]\n"
+    "         [--serve PATH [--refresh SECS]]\n"
+    "         [--http HOST:PORT [--workers N] [--refresh SECS]]\n"
+    "       " PDXKA_PROGNAME " export --fortune DIR [-v | --curl-log FILE] [-k]\n"
+    "         [--timing] [--trace FILE] [--input FILE] [--cache FILE]\n"
 #endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
     "\n"
     "Prints the alt text for the most recent XKCD comic."
@@ -94,13 +112,70 @@ inline const auto& program_description()
     "\n"
     "  -b[ ][BACK], --back[=][BACK]\n"
     "                      Print alt text for the bth previous XKCD strip. If\n"
-    "                      not given a value, implicitly sets b=1.\n"
+    "                      not given a value, implicitly sets b=1. A range\n"
+    "                      A..B prints the Ath through Bth previous strips\n"
+    "                      from a single fetch, e.g. -b 0..3.\n"
+    "  --all               Print every strip in the feed from a single fetch.\n"
+    "  --random[=][N]      Print N distinct strips chosen uniformly at random\n"
+    "                      from the feed. If not given a value, implicitly\n"
+    "                      sets N=1.\n"
+    "  --seed SEED         Seed for --random so that the same strips are\n"
+    "                      chosen. By default the seed is nondeterministic.\n"
     "\n"
     "  -o, --one-line      Print alt text and attestation on one line.\n"
+    "  --format FMT        Print comics as text (default), a json array,\n"
+    "                      ndjson objects, or csv or tsv with a header row.\n"
+    "                      Machine-readable formats include every feed field.\n"
+    "  --template TMPL     Print comics using TMPL, where %n, %t, %a, %l, %i,\n"
+    "                      %d, and %g are the number, title, alt text, link,\n"
+    "                      image URL, date, and GUID, %% is a literal %, and\n"
+    "                      \\n, \\t, and \\\\ are escapes, e.g. '%n\\t%a\\n'.\n"
+    "\n"
+    "  --batch             Fetch the feed once then answer newline-delimited\n"
+    "                      queries (latest, back N, number N, search TEXT)\n"
+    "                      read from stdin, writing one line per query.\n"
+    "  --flush-every N     Flush batch output every N answers. By default\n"
+    "                      output is flushed when the buffer fills.\n"
+    "  --watch             Stay resident, printing each new comic's alt text\n"
+    "                      as it appears. Polling is dense around expected\n"
+    "                      publication times learned from the feed.\n"
+    "\n"
+    "  --fortune DIR       With export, append new comics to the fortune\n"
+    "                      cookie file DIR/xkcd and rewrite its strfile index\n"
+    "                      DIR/xkcd.dat so fortune can pick comics directly.\n"
+    "\n"
+    "  --input FILE        Read the RSS feed from FILE instead of the network,\n"
+    "                      or from stdin if FILE is -. Files are memory-mapped\n"
+    "                      and reread on refresh only if modified.\n"
+    "  --cache FILE        Share the feed between runs through the cache file\n"
+    "                      FILE, which is used before the daemon or network\n"
+    "                      while younger than --cache-ttl. Defaults to the\n"
+    "                      value of the " PDXKA_CACHE_ENV " environment variable.\n"
+    "  --cache-ttl SECS    Seconds a cache file is used for, default 900.\n"
+    "  --socket PATH       Try the daemon at UNIX domain socket PATH before\n"
+    "                      making a network request. Defaults to the value\n"
+    "                      of the " PDXKA_SOCKET_ENV " environment variable.\n"
+    "  --serve PATH        Serve alt text queries from memory over a UNIX\n"
+    "                      domain socket at PATH until interrupted.\n"
+    "  --http HOST:PORT    Serve alt text queries from memory as JSON over\n"
+    "                      HTTP at HOST:PORT until interrupted. Linux only.\n"
+    "  --workers N         Number of HTTP worker threads, default 1. Each\n"
+    "                      has its own SO_REUSEPORT listening socket.\n"
+    "  --refresh SECS      Seconds between conditional feed refreshes when\n"
+    "                      serving, default 900.\n"
+    "\n"
     "  -v, --verbose       Allow cURL to print what's going on to stderr.\n"
     "                      Useful for debugging or satisfying curiosity.\n"
+    "  --curl-log FILE     Write cURL's debug output to FILE as JSON instead,\n"
+    "                      with timestamped text, header lines, and data and\n"
+    "                      TLS byte counts.\n"
     "  -k, --insecure      Allow cURL to skip verification of the server's SSL\n"
-    "                      certificate. Try not to specify this."
+    "                      certificate. Try not to specify this.\n"
+    "  --timing            Print a breakdown of where time was spent to stderr,\n"
+    "                      e.g. option parsing, DNS, connect, TLS, first byte,\n"
+    "                      transfer, parsing, formatting, and output.\n"
+    "  --trace FILE        Write a Chrome trace of internal spans to FILE on\n"
+    "                      exit for chrome://tracing or the Perfetto UI."
 #endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
   };
   return desc;
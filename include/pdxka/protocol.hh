@@ -0,0 +1,71 @@
+/**
+ * @file protocol.hh
+ * @author Derek Huang
+ * @brief C++ header for the xkcd-alt daemon line protocol
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_PROTOCOL_HH_
+#define PDXKA_PROTOCOL_HH_
+
+#include <string>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+/**
+ * Append the line protocol encoding of an RSS item to a string.
+ *
+ * The item's title, link, image source, image title, image alt text,
+ * publication date, and GUID are written in that order separated by tabs and
+ * terminated by a newline. Backslashes, tabs, carriage returns, and newlines
+ * within field values are written as `\\`, `\t`, `\r`, and `\n` respectively.
+ *
+ * @param out String to append to
+ * @param item RSS item to encode
+ */
+PDXKA_PUBLIC
+void encode_item(std::string& out, const rss_item& item);
+
+/**
+ * Decode an RSS item from its line protocol encoding.
+ *
+ * @param line Encoded item with or without the terminating newline
+ *
+ * @throws std::invalid_argument If the line is not a valid item encoding
+ */
+PDXKA_PUBLIC
+rss_item decode_item(std::string_view line);
+
+/**
+ * Return the line protocol response to a single request line.
+ *
+ * A request line is a query as accepted by `parse_query`. On success the
+ * response is `ok N` followed by the N encoded matching items, each on its
+ * own line. If the query is malformed the response is `error MESSAGE`. Each
+ * response line is terminated by a newline.
+ *
+ * @param snapshot Feed snapshot to answer from
+ * @param request Request line with or without the terminating newline
+ */
+PDXKA_PUBLIC
+std::string respond(const feed_snapshot& snapshot, std::string_view request);
+
+/**
+ * Decode the RSS items from a complete line protocol response.
+ *
+ * @param response Response to a single request as returned by `respond`
+ *
+ * @throws std::invalid_argument If the response is malformed or incomplete
+ * @throws std::runtime_error If the response is an `error` response
+ */
+PDXKA_PUBLIC
+rss_item_vector decode_response(std::string_view response);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_PROTOCOL_HH_
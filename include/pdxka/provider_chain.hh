@@ -0,0 +1,326 @@
+/**
+ * @file provider_chain.hh
+ * @author Derek Huang
+ * @brief C++ header for getting the feed from the cheapest of several tiers
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_PROVIDER_CHAIN_HH_
+#define PDXKA_PROVIDER_CHAIN_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "pdxka/curl.hh"
+#include "pdxka/dllexport.h"
+#include "pdxka/features.h"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+/**
+ * Type alias for a shared immutable feed as answered by a tier.
+ */
+using feed_ptr = std::shared_ptr<const feed_snapshot>;
+
+/**
+ * Abstract source of the XKCD RSS feed that is one tier of a `provider_chain`.
+ *
+ * A tier either answers with the feed or delegates to the next tier by
+ * returning `nullptr`. Tiers that can store a feed also accept feeds answered
+ * by slower tiers so that later requests are answered sooner.
+ */
+class PDXKA_PUBLIC feed_tier {
+public:
+  /**
+   * Virtual dtor.
+   */
+  virtual ~feed_tier() = default;
+
+  /**
+   * Return the tier name, e.g. `"cache"`.
+   */
+  virtual std::string_view name() const noexcept = 0;
+
+  /**
+   * Return the feed, `nullptr` to delegate to the next tier.
+   *
+   * @throws std::exception On error, which is also delegated
+   */
+  virtual feed_ptr get() = 0;
+
+  /**
+   * Store a feed answered by a slower tier.
+   *
+   * By default this does nothing.
+   *
+   * @param feed Feed to store
+   * @returns `true` if the feed was stored
+   *
+   * @throws std::exception On error
+   */
+  virtual bool put(const feed_ptr& /*feed*/) { return false; }
+};
+
+/**
+ * Tier holding the most recent feed in memory.
+ *
+ * This is only useful in long-lived processes and can be shared by threads.
+ */
+class PDXKA_PUBLIC memory_tier : public feed_tier {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /**
+   * Ctor.
+   *
+   * @param max_age Age after which the stored feed is no longer answered
+   */
+  explicit memory_tier(std::chrono::seconds max_age) noexcept : max_age_{max_age} {}
+
+  std::string_view name() const noexcept override { return "memory"; }
+
+  feed_ptr get() override;
+
+  bool put(const feed_ptr& feed) override;
+
+private:
+  std::chrono::seconds max_age_;
+  std::mutex mut_;
+  feed_ptr feed_;
+  clock::time_point stored_;
+};
+
+/**
+ * Tier holding the feed in a cache file that can be shared by processes.
+ *
+ * The file holds the items in the same line protocol as a daemon's `all`
+ * response, so a hit needs no XML parsing. Files are replaced atomically by
+ * renaming so concurrent readers never see a partial file.
+ */
+class PDXKA_PUBLIC cache_tier : public feed_tier {
+public:
+  /**
+   * Ctor.
+   *
+   * @param path Cache file path, whose directory is created when needed
+   * @param max_age Age of the file after which it is no longer answered
+   */
+  cache_tier(std::string path, std::chrono::seconds max_age)
+    : path_{std::move(path)}, max_age_{max_age}
+  {}
+
+  std::string_view name() const noexcept override { return "cache"; }
+
+  /**
+   * Return the cached feed, `nullptr` if missing, too old, or empty.
+   *
+   * @throws std::runtime_error If the file cannot be read
+   * @throws std::invalid_argument If the file is corrupt
+   */
+  feed_ptr get() override;
+
+  /**
+   * Write the feed to the cache file.
+   *
+   * @returns `true`
+   *
+   * @throws std::runtime_error If the file cannot be written
+   */
+  bool put(const feed_ptr& feed) override;
+
+private:
+  std::string path_;
+  std::chrono::seconds max_age_;
+};
+
+#if !PDXKA_WIN32
+/**
+ * Tier asking a daemon serving over a UNIX domain socket for the whole feed.
+ *
+ * Since the daemon keeps its own feed fresh, feeds are not stored.
+ */
+class PDXKA_PUBLIC daemon_tier : public feed_tier {
+public:
+  /**
+   * Ctor.
+   *
+   * Only the whole feed is asked for since a partial feed could not be
+   * promoted to cheaper tiers or have other comics selected from it.
+   *
+   * @param socket_path Daemon socket path
+   * @param timeout Timeout for connecting and each read or write
+   */
+  explicit daemon_tier(
+    std::string socket_path,
+    std::chrono::milliseconds timeout = std::chrono::milliseconds{1000})
+    : socket_path_{std::move(socket_path)}, timeout_{timeout}
+  {}
+
+  std::string_view name() const noexcept override { return "daemon"; }
+
+  /**
+   * Return the daemon's feed, `nullptr` if the daemon can't answer.
+   */
+  feed_ptr get() override;
+
+private:
+  std::string socket_path_;
+  std::chrono::milliseconds timeout_;
+};
+#endif  // !PDXKA_WIN32
+
+/**
+ * Tier fetching and parsing the RSS XML, e.g. from the network or a file.
+ */
+class PDXKA_PUBLIC fetch_tier : public feed_tier {
+public:
+  /**
+   * Ctor.
+   *
+   * @param name Tier name, e.g. `"network"`
+   * @param fetch Callable returning the RSS XML, e.g. calling `get_rss`
+   */
+  fetch_tier(std::string name, std::function<curl_result()> fetch)
+    : name_{std::move(name)}, fetch_{std::move(fetch)}
+  {}
+
+  std::string_view name() const noexcept override { return name_; }
+
+  /**
+   * Return the fetched and parsed feed.
+   *
+   * @throws std::runtime_error If the fetch fails or the feed has no items
+   * @throws boost::property_tree::ptree_error If the XML can't be parsed
+   */
+  feed_ptr get() override;
+
+private:
+  std::string name_;
+  std::function<curl_result()> fetch_;
+};
+
+/**
+ * Tier answering with a callable, e.g. to adapt existing fetch logic.
+ */
+class PDXKA_PUBLIC function_tier : public feed_tier {
+public:
+  /**
+   * Ctor.
+   *
+   * @param name Tier name
+   * @param get Callable returning the feed or `nullptr` to delegate
+   */
+  function_tier(std::string name, std::function<feed_ptr()> get)
+    : name_{std::move(name)}, get_{std::move(get)}
+  {}
+
+  std::string_view name() const noexcept override { return name_; }
+
+  feed_ptr get() override { return get_(); }
+
+private:
+  std::string name_;
+  std::function<feed_ptr()> get_;
+};
+
+/**
+ * Struct holding the counters of a tier in a `provider_chain`.
+ *
+ * @param hits Number of times the tier answered
+ * @param misses Number of times the tier delegated
+ * @param errors Number of times getting or storing a feed failed
+ * @param promotions Number of feeds from slower tiers stored by the tier
+ * @param last_error Message of the tier's most recent error, empty if none
+ */
+struct tier_stats {
+  std::size_t hits = 0u;
+  std::size_t misses = 0u;
+  std::size_t errors = 0u;
+  std::size_t promotions = 0u;
+  std::string last_error;
+};
+
+/**
+ * Chain of feed tiers ordered from cheapest to most expensive.
+ *
+ * Each request is answered by the first tier that can answer and the feed is
+ * then promoted to every cheaper tier, e.g. a feed from the network is written
+ * to the cache file so the next process reads it from there. For example:
+ *
+ * @code{.cc}
+ * provider_chain chain;
+ * chain.add(std::make_unique<cache_tier>(path, std::chrono::seconds{900}));
+ * chain.add(std::make_unique<fetch_tier>("network", [] { return get_rss(); }));
+ * auto feed = chain.get();
+ * @endcode
+ *
+ * @note A chain must not be used by multiple threads at once.
+ */
+class PDXKA_PUBLIC provider_chain {
+public:
+  /**
+   * Append a tier, which is more expensive than the tiers before it.
+   *
+   * @param tier Tier to append
+   * @returns `*this` so calls can be chained
+   */
+  provider_chain& add(std::unique_ptr<feed_tier> tier);
+
+  /**
+   * Return the number of tiers.
+   */
+  auto size() const noexcept { return tiers_.size(); }
+
+  /**
+   * Return the tier at the given index.
+   *
+   * @param i Tier index
+   */
+  const feed_tier& tier(std::size_t i) const { return *tiers_.at(i).tier; }
+
+  /**
+   * Return the counters of the tier at the given index.
+   *
+   * @param i Tier index
+   */
+  const tier_stats& stats(std::size_t i) const { return tiers_.at(i).stats; }
+
+  /**
+   * Return the feed from the first tier that answers.
+   *
+   * Tier errors are counted and delegated like misses. Failing to promote the
+   * feed to a cheaper tier is counted but otherwise ignored. Error messages
+   * are kept in the stats of the tier that failed.
+   *
+   * @returns Feed, `nullptr` if no tier answered
+   */
+  feed_ptr get();
+
+  /**
+   * Write the counters of each tier, e.g. to standard error.
+   *
+   * @param out Stream to write to
+   */
+  void report(std::ostream& out) const;
+
+private:
+  struct entry {
+    std::unique_ptr<feed_tier> tier;
+    tier_stats stats;
+  };
+
+  std::vector<entry> tiers_;
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_PROVIDER_CHAIN_HH_
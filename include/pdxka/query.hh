@@ -0,0 +1,71 @@
+/**
+ * @file query.hh
+ * @author Derek Huang
+ * @brief C++ header for XKCD RSS item queries
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_QUERY_HH_
+#define PDXKA_QUERY_HH_
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Enum class for the kinds of supported item queries.
+ *
+ * `latest` selects the most recent comic, `back` selects the nth previous
+ * comic, `number` selects a comic by its XKCD comic number, `search` selects
+ * all comics whose title or alt text contains some text, and `all` selects
+ * every comic, e.g. so a daemon's whole feed can be copied.
+ */
+enum class query_type { latest, back, number, search, all };
+
+/**
+ * Struct representing a single item query.
+ *
+ * @param type Kind of query
+ * @param value Number of comics to go back or comic number
+ * @param text Text to search for (case-insensitive)
+ */
+struct query {
+  query_type type = query_type::latest;
+  unsigned int value = 0u;
+  std::string text;
+};
+
+/**
+ * Parse a query from its text representation.
+ *
+ * The accepted queries are `latest`, `back N`, `number N`, `search TEXT`, and
+ * `all`. Leading and trailing whitespace is ignored.
+ *
+ * @param line Query text, e.g. `back 3`
+ *
+ * @throws std::invalid_argument If the query is malformed
+ */
+PDXKA_PUBLIC
+query parse_query(std::string_view line);
+
+/**
+ * Return the RSS items selected by a query.
+ *
+ * The returned pointers refer to elements of `items` and are ordered as they
+ * are in `items`, i.e. newest first. If nothing matches the result is empty.
+ *
+ * @param items RSS items ordered newest first
+ * @param q Query to run
+ */
+PDXKA_PUBLIC
+std::vector<const rss_item*> run_query(
+  const rss_item_vector& items, const query& q);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_QUERY_HH_
@@ -0,0 +1,125 @@
+/**
+ * @file random.hh
+ * @author Derek Huang
+ * @brief C++ header for seedable random comic selection
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_RANDOM_HH_
+#define PDXKA_RANDOM_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+
+namespace pdxka {
+
+/**
+ * xoshiro256** pseudo-random number generator.
+ *
+ * This is Blackman and Vigna's small-state, fast, general-purpose generator
+ * with the 256-bit state seeded from a 64-bit seed using splitmix64 as they
+ * recommend. It satisfies the `UniformRandomBitGenerator` requirements so it
+ * can also be used with the standard library distributions.
+ */
+class xoshiro256ss {
+public:
+  using result_type = std::uint64_t;
+
+  /**
+   * Ctor.
+   *
+   * @param seed Seed, where equal seeds give equal sequences
+   */
+  explicit xoshiro256ss(std::uint64_t seed) noexcept
+  {
+    for (auto& word : state_) {
+      // splitmix64 step
+      seed += UINT64_C(0x9e3779b97f4a7c15);
+      auto z = seed;
+      z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+      z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+      word = z ^ (z >> 31);
+    }
+  }
+
+  static constexpr result_type min() noexcept { return 0u; }
+
+  static constexpr result_type max() noexcept
+  {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  /**
+   * Return the next 64 random bits.
+   */
+  result_type operator()() noexcept
+  {
+    auto result = rotl(state_[1] * 5, 7) * 9;
+    auto t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+  }
+
+private:
+  std::uint64_t state_[4];
+
+  static constexpr std::uint64_t rotl(std::uint64_t x, int k) noexcept
+  {
+    return (x << k) | (x >> (64 - k));
+  }
+};
+
+/**
+ * Return a uniformly distributed integer in `[0, bound)`.
+ *
+ * This is Lemire's multiply-shift method, which avoids a division except in
+ * the rare case a rejection threshold needs to be computed.
+ *
+ * @param rng Random number generator
+ * @param bound Positive exclusive upper bound
+ */
+inline std::uint32_t uniform_below(xoshiro256ss& rng, std::uint32_t bound) noexcept
+{
+  auto product = (rng() >> 32) * bound;
+  auto low = static_cast<std::uint32_t>(product);
+  if (low < bound) {
+    // reject the values that would bias the result
+    auto threshold = static_cast<std::uint32_t>(-bound) % bound;
+    while (low < threshold) {
+      product = (rng() >> 32) * bound;
+      low = static_cast<std::uint32_t>(product);
+    }
+  }
+  return static_cast<std::uint32_t>(product >> 32);
+}
+
+/**
+ * Return `count` distinct indices sampled uniformly from `[0, population)`.
+ *
+ * This uses Floyd's algorithm, which makes exactly `count` draws regardless
+ * of the population size, followed by a shuffle so the order of the indices
+ * is uniformly random too. Each draw is constant time.
+ *
+ * @param rng Random number generator
+ * @param population Number of items to sample from
+ * @param count Number of indices to sample, at most `population`
+ *
+ * @throws std::invalid_argument If `count` is greater than `population` or
+ *  `population` does not fit in 32 bits
+ */
+PDXKA_PUBLIC
+std::vector<std::size_t> sample_indices(
+  xoshiro256ss& rng, std::size_t population, std::size_t count);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_RANDOM_HH_
@@ -10,8 +10,11 @@
 
 #include <cassert>
 #include <cstdint>
-#include <sstream>
+#include <istream>
+#include <streambuf>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include <boost/property_tree/ptree.hpp>
@@ -20,6 +23,7 @@
 
 #include "pdxka/curl.hh"
 #include "pdxka/dllexport.h"
+#include "pdxka/trace.hh"
 
 namespace pdxka {
 
@@ -45,20 +49,49 @@ inline curl_result get_rss(curl_option<Ts>... options)
   return curl_get(rss_url(), options...);
 }
 
+namespace detail {
+
+/**
+ * Read-only stream buffer over a character range.
+ *
+ * Unlike a `std::stringstream`, the range is read in place and not copied.
+ */
+class view_streambuf : public std::streambuf {
+public:
+  /**
+   * Ctor.
+   *
+   * @param view Characters to read, which must outlive the stream buffer
+   */
+  explicit view_streambuf(std::string_view view) noexcept
+  {
+    // get area is never written through
+    auto data = const_cast<char*>(view.data());
+    setg(data, data, data + view.size());
+  }
+};
+
+}  // namespace detail
+
 /**
  * Return Boost `ptree` holding the latest XKCD RSS XML.
  *
- * @param xml `const std::string&` raw XKCD RSS XML
+ * The XML is read in place, e.g. from a memory-mapped `feed_input`, so the
+ * only copy made is the mutable buffer the XML parser itself requires.
+ *
+ * @param xml Raw XKCD RSS XML
  *
  * @throws `boost::property_tree::xml_parser::xml_parser_error` if parse fails
  */
-inline auto parse_rss(const std::string& xml)
+inline auto parse_rss(std::string_view xml)
 {
   namespace pt = boost::property_tree;
+  PDXKA_TRACE_SPAN_ARG("parse_xml", xml.size());
   // property tree we will use to store RSS tree results in
   pt::ptree tree;
-  // create stream from rss_string + parse XML (drop comments)
-  std::stringstream stream(xml, std::ios_base::in);
+  // create stream over XML without copying it + parse XML (drop comments)
+  detail::view_streambuf buf{xml};
+  std::istream stream{&buf};
   pt::read_xml(stream, tree, pt::xml_parser::no_comments);
   return tree;
 }
@@ -90,6 +123,37 @@ public:
     from_tree(tree, this);
   }
 
+  /**
+   * Constructor initializing class directly from the item field values.
+   *
+   * This is useful when the item data does not come from the RSS XML, e.g.
+   * when the item is received from a `xkcd-alt --serve` daemon.
+   *
+   * @param title Comic title
+   * @param link URL link to the comic
+   * @param img_src URL to the comic's image source
+   * @param img_title Comic image title
+   * @param img_alt Comic image alt text
+   * @param pub_date Comic publication date string
+   * @param guid Comic globally unique identifier
+   */
+  rss_item(
+    std::string title,
+    std::string link,
+    std::string img_src,
+    std::string img_title,
+    std::string img_alt,
+    std::string pub_date,
+    std::string guid)
+    : title_{std::move(title)},
+      link_{std::move(link)},
+      img_src_{std::move(img_src)},
+      img_title_{std::move(img_title)},
+      img_alt_{std::move(img_alt)},
+      pub_date_{std::move(pub_date)},
+      guid_{std::move(guid)}
+  {}
+
   /**
    * Return new `rss_item` from Boost `ptree` containing XKCD RSS item data.
    *
@@ -180,6 +244,18 @@ private:
 
 using rss_item_vector = std::vector<rss_item>;
 
+/**
+ * Return the XKCD comic number of an `rss_item`.
+ *
+ * The number is read from the trailing path component of the comic link, e.g.
+ * `https://xkcd.com/2941/` has comic number 2941.
+ *
+ * @param item RSS item to get comic number for
+ * @returns Comic number or 0 if the link does not contain a comic number
+ */
+PDXKA_PUBLIC
+unsigned int comic_number(const rss_item& item) noexcept;
+
 /**
  * Return a `rss_item_vector` from a Boost property tree holding XKCD RSS XML.
  */
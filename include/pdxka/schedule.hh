@@ -0,0 +1,184 @@
+/**
+ * @file schedule.hh
+ * @author Derek Huang
+ * @brief C++ header for schedule-aware polling of the XKCD RSS feed
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_SCHEDULE_HH_
+#define PDXKA_SCHEDULE_HH_
+
+#include <chrono>
+#include <ctime>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Parse an RFC 822 date as used by RSS `pubDate` elements.
+ *
+ * The accepted format is `[Day, ]DD Mon YYYY HH:MM[:SS] ZONE` where `ZONE` is
+ * a numeric `+HHMM`/`-HHMM` offset, `GMT`, `UT`, or `Z`.
+ *
+ * @param date Date text, e.g. `Mon, 03 Jun 2024 04:00:00 -0000`
+ * @returns UNIX time
+ *
+ * @throws std::invalid_argument If the date is malformed
+ */
+PDXKA_PUBLIC
+std::time_t parse_rfc822_date(std::string_view date);
+
+/**
+ * Weekly publication schedule.
+ *
+ * Each slot is a time of the week as seconds since Monday 00:00 UTC. XKCD
+ * publishes on Monday, Wednesday, and Friday at about 04:00 UTC.
+ */
+class PDXKA_PUBLIC publish_schedule {
+public:
+  /**
+   * Number of seconds in a week.
+   */
+  static constexpr std::time_t week = 7 * 86400;
+
+  /**
+   * Ctor.
+   *
+   * @param slots Times of the week as seconds since Monday 00:00 UTC
+   */
+  explicit publish_schedule(std::vector<std::time_t> slots);
+
+  /**
+   * Return the XKCD Monday, Wednesday, and Friday 04:00 UTC schedule.
+   */
+  static publish_schedule xkcd_default();
+
+  /**
+   * Return the schedule learned from the publication dates of RSS items.
+   *
+   * Publication times within an hour of each other in the week are treated as
+   * the same slot. If no publication date can be parsed `xkcd_default()` is
+   * returned.
+   *
+   * @param items RSS items
+   */
+  static publish_schedule learn(const rss_item_vector& items);
+
+  /**
+   * Return the slots as sorted seconds since Monday 00:00 UTC.
+   */
+  const auto& slots() const noexcept { return slots_; }
+
+  /**
+   * Return the first slot time at or after the given time.
+   *
+   * @param time UNIX time
+   */
+  std::time_t next_slot(std::time_t time) const noexcept;
+
+private:
+  std::vector<std::time_t> slots_;
+};
+
+/**
+ * Struct holding the schedule-aware polling policy.
+ *
+ * @param dense_interval Interval between polls while in a slot's window
+ * @param window_before Time before a slot that its window opens
+ * @param window_after Time after a slot that its window closes
+ * @param min_backoff Initial interval between polls outside a window
+ * @param max_backoff Maximum interval between polls outside a window
+ */
+struct poll_policy {
+  std::chrono::seconds dense_interval{60};
+  std::chrono::seconds window_before{300};
+  std::chrono::seconds window_after{7200};
+  std::chrono::seconds min_backoff{300};
+  std::chrono::seconds max_backoff{21600};
+};
+
+/**
+ * Planner deciding when to next poll the feed.
+ *
+ * Polls are dense during the window around each expected publication slot
+ * until a new comic is seen for that slot. Outside windows the interval
+ * doubles after each unchanged poll, up to `max_backoff`, but never sleeps
+ * past the opening of the next window.
+ */
+class PDXKA_PUBLIC poll_planner {
+public:
+  /**
+   * Ctor.
+   *
+   * @param schedule Expected publication schedule
+   * @param policy Polling policy
+   */
+  poll_planner(publish_schedule schedule, poll_policy policy = {});
+
+  /**
+   * Return the delay until the next poll.
+   *
+   * @param now Current UNIX time
+   */
+  std::chrono::seconds next_delay(std::time_t now) const;
+
+  /**
+   * Record the result of a poll.
+   *
+   * @param now UNIX time of the poll
+   * @param changed `true` if a new comic was seen
+   */
+  void record(std::time_t now, bool changed);
+
+  /**
+   * Record that a comic published at the given time has already been seen.
+   *
+   * If the publication time falls in a slot's window, no dense polling is
+   * done for the rest of that window. This is used when watching starts
+   * after the current slot's comic was published.
+   *
+   * @param published UNIX publication time of the comic
+   */
+  void seen(std::time_t published) noexcept;
+
+  /**
+   * Replace the expected publication schedule.
+   *
+   * @param schedule New schedule
+   */
+  void reschedule(publish_schedule schedule);
+
+  /**
+   * Return the expected publication schedule.
+   */
+  const auto& schedule() const noexcept { return schedule_; }
+
+private:
+  publish_schedule schedule_;
+  poll_policy policy_;
+  std::chrono::seconds backoff_;
+  std::time_t satisfied_until_;
+
+  /**
+   * Return the slot whose window is current or next, i.e. the first slot
+   * whose window closes after `now`.
+   *
+   * @param now Current UNIX time
+   */
+  std::time_t current_slot(std::time_t now) const noexcept;
+
+  /**
+   * Return `true` if `now` is in a window still waiting for a new comic.
+   *
+   * @param now Current UNIX time
+   */
+  bool in_open_window(std::time_t now) const noexcept;
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_SCHEDULE_HH_
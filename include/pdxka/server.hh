@@ -0,0 +1,164 @@
+/**
+ * @file server.hh
+ * @author Derek Huang
+ * @brief C++ header for the xkcd-alt UNIX domain socket daemon
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_SERVER_HH_
+#define PDXKA_SERVER_HH_
+
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "pdxka/curl.hh"
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+/**
+ * Type alias for a callable that fetches the XKCD RSS XML.
+ *
+ * The argument is the UNIX time of the feed currently held by the caller or 0
+ * if there is none. A nonzero value should be used for a conditional request,
+ * e.g. with `CURLOPT_TIMECONDITION`, so the server can answer with `304 Not
+ * Modified` instead of resending the unchanged feed.
+ */
+using feed_fetcher = std::function<curl_result(std::time_t modified_since)>;
+
+/**
+ * Conditionally fetch and parse the XKCD RSS feed.
+ *
+ * The fetcher is given `modified` so it can make a conditional request. On a
+ * `304 Not Modified` response nothing is changed. Otherwise the payload is
+ * parsed into `items` and `modified` is set to the remote document time or,
+ * if that is unknown, to the current time.
+ *
+ * @param fetcher Callable to fetch the XKCD RSS XML with
+ * @param modified UNIX time of the currently held feed, 0 if none
+ * @param items RSS items to replace with the newly fetched items
+ * @returns `true` if `items` was replaced, `false` if not modified
+ *
+ * @throws std::runtime_error If the fetch or parse fails or there are no items
+ */
+PDXKA_PUBLIC
+bool refresh_feed(
+  const feed_fetcher& fetcher, std::time_t& modified, rss_item_vector& items);
+
+/**
+ * Struct holding daemon options.
+ *
+ * @param socket_path Filesystem path to bind the UNIX domain socket to
+ * @param refresh_interval Interval between conditional feed refreshes
+ */
+struct server_options {
+  std::string socket_path;
+  std::chrono::seconds refresh_interval{900};
+};
+
+/**
+ * Daemon serving XKCD RSS item queries over a UNIX domain socket.
+ *
+ * The parsed feed is held in memory and refreshed periodically on a
+ * background thread, which publishes each new `feed_snapshot` through a
+ * `snapshot_cell` so clients are never kept waiting by a refresh. Clients send
+ * newline-terminated queries and receive responses as described in
+ * `protocol.hh`. All clients are served by a single-threaded `poll` loop.
+ */
+class PDXKA_PUBLIC unix_server {
+public:
+  /**
+   * Ctor.
+   *
+   * Nothing is bound or fetched until `run()` is called.
+   *
+   * @param options Daemon options
+   * @param fetcher Callable to fetch the XKCD RSS XML with
+   *
+   * @throws std::runtime_error If the wakeup pipe cannot be created
+   */
+  unix_server(server_options options, feed_fetcher fetcher);
+
+  /**
+   * Deleted copy ctor.
+   */
+  unix_server(const unix_server&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Closes the wakeup pipe. The socket itself is cleaned up by `run()`.
+   */
+  ~unix_server();
+
+  /**
+   * Fetch the feed, bind the socket, and serve clients until stopped.
+   *
+   * On return the socket file has been removed.
+   *
+   * @throws std::runtime_error If the initial fetch, parse, or bind fails
+   */
+  void run();
+
+  /**
+   * Request that `run()` return.
+   *
+   * This only writes to a pipe and so is async-signal-safe.
+   */
+  void stop() noexcept;
+
+  /**
+   * Return the daemon options.
+   */
+  const auto& options() const noexcept { return options_; }
+
+  /**
+   * Return the feed snapshot currently being served, `nullptr` if none.
+   *
+   * This is safe to call while `run()` is serving and refreshing.
+   */
+  auto snapshot() const noexcept { return snapshot_.load(); }
+
+private:
+  server_options options_;
+  feed_fetcher fetcher_;
+  snapshot_cell snapshot_;
+  std::time_t modified_;
+  int wakeup_fds_[2];
+
+  /**
+   * Conditionally fetch the feed and publish a new snapshot if it has changed.
+   *
+   * @returns `true` if a new snapshot was published
+   * @throws std::runtime_error If the fetch or the parse fails
+   */
+  bool refresh();
+
+  /**
+   * Refresh the feed every refresh interval until stopped.
+   *
+   * Errors are reported but the current snapshot is kept.
+   */
+  void refresh_loop();
+};
+
+/**
+ * Run a `unix_server` until `SIGINT` or `SIGTERM` is received.
+ *
+ * Errors are printed to standard error.
+ *
+ * @param options Daemon options
+ * @param fetcher Callable to fetch the XKCD RSS XML with
+ * @returns `EXIT_SUCCESS` on clean shutdown, `EXIT_FAILURE` on error
+ */
+PDXKA_PUBLIC
+int serve(const server_options& options, const feed_fetcher& fetcher);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_SERVER_HH_
@@ -0,0 +1,137 @@
+/**
+ * @file simd.hh
+ * @author Derek Huang
+ * @brief C++ header for SIMD instruction set selection and byte scanning
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_SIMD_HH_
+#define PDXKA_SIMD_HH_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Nonzero if AVX2 instructions are enabled at compile time.
+ */
+#if defined(__AVX2__)
+#define PDXKA_AVX2 1
+#else
+#define PDXKA_AVX2 0
+#endif  // !defined(__AVX2__)
+
+/**
+ * Nonzero if SSE2 instructions are enabled at compile time.
+ *
+ * This is always the case on x86-64. MSVC doesn't define `__SSE2__`.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PDXKA_SSE2 1
+#else
+#define PDXKA_SSE2 0
+#endif  // !defined(__SSE2__) && !defined(_M_X64) && ...
+
+/**
+ * Name of the widest vector instruction set enabled at compile time.
+ */
+#if PDXKA_AVX2
+#define PDXKA_SIMD_NAME "avx2"
+#elif PDXKA_SSE2
+#define PDXKA_SIMD_NAME "sse2"
+#else
+#define PDXKA_SIMD_NAME "scalar"
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+
+#if PDXKA_AVX2
+#include <immintrin.h>
+#elif PDXKA_SSE2
+#include <emmintrin.h>
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+
+namespace pdxka {
+
+/**
+ * Return the index of the lowest set bit of a nonzero mask.
+ *
+ * @param mask Nonzero bitmask
+ */
+inline unsigned int lowest_set_bit(std::uint32_t mask) noexcept
+{
+#if defined(__GNUC__)
+  return static_cast<unsigned int>(__builtin_ctz(mask));
+#elif defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned int>(index);
+#else
+  unsigned int index = 0;
+  for (; !(mask & 1u); mask >>= 1)
+    index++;
+  return index;
+#endif  // !defined(__GNUC__) && !defined(_MSC_VER)
+}
+
+/**
+ * Return the index of the first byte that is one of `Chars` or, if
+ * `Control` is `true`, is an ASCII control character below 0x20.
+ *
+ * This is the scan used to find the next byte needing escaping when encoding
+ * strings. Bytes are compared 32 (AVX2) or 16 (SSE2) at a time.
+ *
+ * @tparam Control `true` to also match bytes below 0x20
+ * @tparam Chars Characters to match
+ *
+ * @param data Bytes to scan
+ * @param size Number of bytes
+ * @returns Index of the first match, `size` if there is none
+ */
+template <bool Control, char... Chars>
+std::size_t find_special(const char* data, std::size_t size) noexcept
+{
+  std::size_t i = 0;
+#if PDXKA_AVX2
+  for (; i + 32 <= size; i += 32) {
+    auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    auto match = _mm256_setzero_si256();
+    ((match = _mm256_or_si256(match, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(Chars)))), ...);
+    // saturating subtract is zero only for bytes <= 0x1f
+    if constexpr (Control)
+      match = _mm256_or_si256(
+        match,
+        _mm256_cmpeq_epi8(
+          _mm256_subs_epu8(block, _mm256_set1_epi8(0x1f)), _mm256_setzero_si256()
+        )
+      );
+    if (auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(match)))
+      return i + lowest_set_bit(mask);
+  }
+#elif PDXKA_SSE2
+  for (; i + 16 <= size; i += 16) {
+    auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    auto match = _mm_setzero_si128();
+    ((match = _mm_or_si128(match, _mm_cmpeq_epi8(block, _mm_set1_epi8(Chars)))), ...);
+    // saturating subtract is zero only for bytes <= 0x1f
+    if constexpr (Control)
+      match = _mm_or_si128(
+        match,
+        _mm_cmpeq_epi8(_mm_subs_epu8(block, _mm_set1_epi8(0x1f)), _mm_setzero_si128())
+      );
+    if (auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(match)))
+      return i + lowest_set_bit(mask);
+  }
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+  for (; i < size; i++) {
+    auto c = data[i];
+    if ((Control && static_cast<unsigned char>(c) < 0x20) || ((c == Chars) || ...))
+      return i;
+  }
+  return size;
+}
+
+}  // namespace pdxka
+
+#endif  // PDXKA_SIMD_HH_
@@ -0,0 +1,137 @@
+/**
+ * @file snapshot.hh
+ * @author Derek Huang
+ * @brief C++ header for immutable snapshots of the parsed XKCD RSS feed
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_SNAPSHOT_HH_
+#define PDXKA_SNAPSHOT_HH_
+
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/query.hh"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Immutable snapshot of the parsed XKCD RSS feed.
+ *
+ * Holds the items together with an index of comic numbers so `number` queries
+ * do not need to scan the items. Once constructed a snapshot is never
+ * modified, so any number of threads can read it without synchronization.
+ */
+class PDXKA_PUBLIC feed_snapshot {
+public:
+  /**
+   * Ctor.
+   *
+   * @param items RSS items ordered newest first
+   * @param modified UNIX time of the feed document, 0 if unknown
+   */
+  explicit feed_snapshot(rss_item_vector items, std::time_t modified = 0);
+
+  /**
+   * Return the RSS items ordered newest first.
+   */
+  const auto& items() const noexcept { return items_; }
+
+  /**
+   * Return the UNIX time of the feed document, 0 if unknown.
+   */
+  auto modified() const noexcept { return modified_; }
+
+  /**
+   * Return the number of RSS items.
+   */
+  auto size() const noexcept { return items_.size(); }
+
+  /**
+   * Return the item with the given comic number, `nullptr` if there is none.
+   *
+   * @param number XKCD comic number
+   */
+  const rss_item* find(unsigned int number) const noexcept;
+
+private:
+  rss_item_vector items_;
+  std::time_t modified_;
+  // (comic number, item index) pairs sorted by comic number
+  std::vector<std::pair<unsigned int, std::size_t>> number_index_;
+};
+
+/**
+ * Return the RSS items of a snapshot selected by a query.
+ *
+ * Same as `run_query` on `snapshot.items()` except that `number` queries are
+ * answered from the snapshot's comic number index.
+ *
+ * @param snapshot Feed snapshot
+ * @param q Query to run
+ */
+PDXKA_PUBLIC
+std::vector<const rss_item*> run_query(const feed_snapshot& snapshot, const query& q);
+
+/**
+ * Holder publishing the current `feed_snapshot` to concurrent readers.
+ *
+ * This is read-copy-update: a writer builds a new snapshot off to the side and
+ * swaps it in with `publish()`, while readers `load()` a reference to
+ * whichever snapshot is current. A reader never sees a partially built
+ * snapshot and keeps its snapshot alive until it drops the reference, so
+ * replaced snapshots are freed once their last reader is done.
+ *
+ * The pointer is swapped with the C++11 `std::atomic_load` and
+ * `std::atomic_store` overloads for `std::shared_ptr`. These are not lock-free
+ * with libstdc++, which guards them with one of a small pool of mutexes picked
+ * by the pointer's address, so readers may briefly wait on each other or on
+ * `publish()`. The mutex is only held to copy the pointer and adjust its
+ * reference count, never while a snapshot is built or destroyed, which is
+ * negligible next to answering a request. C++20's `std::atomic<shared_ptr>`
+ * would be the replacement once the project moves past C++17.
+ */
+class PDXKA_PUBLIC snapshot_cell {
+public:
+  /**
+   * Default ctor.
+   *
+   * No snapshot is published, so `load()` returns `nullptr`.
+   */
+  snapshot_cell() = default;
+
+  /**
+   * Deleted copy ctor.
+   */
+  snapshot_cell(const snapshot_cell&) = delete;
+
+  /**
+   * Return the currently published snapshot, `nullptr` if none.
+   */
+  std::shared_ptr<const feed_snapshot> load() const noexcept
+  {
+    return std::atomic_load(&snapshot_);
+  }
+
+  /**
+   * Publish a new snapshot, replacing the current one.
+   *
+   * @param snapshot Snapshot to publish
+   */
+  void publish(std::shared_ptr<const feed_snapshot> snapshot) noexcept
+  {
+    std::atomic_store(&snapshot_, std::move(snapshot));
+  }
+
+private:
+  std::shared_ptr<const feed_snapshot> snapshot_;
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_SNAPSHOT_HH_
@@ -10,37 +10,103 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 #include "pdxka/dllexport.h"
 
 namespace pdxka {
 
 /**
- * Return new string wrapped at `line_length`.
+ * Return the exact size of `orig` wrapped at `line_length`.
+ *
+ * This is the number of bytes `line_wrap` writes for the same arguments
+ * and can be used to size a caller-supplied output buffer.
+ *
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ */
+PDXKA_PUBLIC
+std::size_t line_wrap_size(
+  std::string_view orig, std::size_t line_length, bool hard_wrap = false) noexcept;
+
+/**
+ * Write `orig` wrapped at `line_length` into a caller-supplied buffer.
  *
  * Words (white-delimited tokens) will not split across lines unless
- * `hard_wrap` is `true` and the word is longer than `line_length`.
+ * `hard_wrap` is `true` and the word is wider than `line_length`. Whitespace
+ * is as classified by `std::isspace` in the `"C"` locale. No null terminator
+ * is written.
+ *
+ * Lengths are in terminal columns as given by `display_width`, so UTF-8 text
+ * with multibyte, combining, or double-width characters wraps by its
+ * displayed width. Hard wraps never split a character. Pure ASCII text is
+ * detected up front and wrapped using byte counts without decoding.
  *
- * @param orig `const std::string&` original string
- * @param line_length `std::size_t` line length to wrap at
- * @param hard_wrap `bool` to split a word whose length is longer than
- *  `line_length` across lines if `true`, otherwise allow oveflow
+ * @param out Output buffer with room for `line_wrap_size()` characters
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ * @returns Pointer one past the last character written
  */
 PDXKA_PUBLIC
-std::string line_wrap(
-  const std::string& orig, std::size_t line_length, bool hard_wrap = false);
+char* line_wrap(
+  char* out,
+  std::string_view orig,
+  std::size_t line_length,
+  bool hard_wrap = false) noexcept;
+
+/**
+ * Append `orig` wrapped at `line_length` to a string.
+ *
+ * The string grows by exactly the wrapped size so reusing the same string
+ * across calls avoids any allocation once its capacity is large enough.
+ *
+ * @param out String to append to
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ */
+PDXKA_PUBLIC
+void line_wrap(
+  std::string& out,
+  std::string_view orig,
+  std::size_t line_length,
+  bool hard_wrap = false);
+
+/**
+ * Return new string wrapped at `line_length`.
+ *
+ * Words (white-delimited tokens) will not split across lines unless
+ * `hard_wrap` is `true` and the word is wider than `line_length`.
+ *
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ */
+inline std::string line_wrap(
+  std::string_view orig, std::size_t line_length, bool hard_wrap = false)
+{
+  std::string out;
+  line_wrap(out, orig, line_length, hard_wrap);
+  return out;
+}
 
 /**
  * Return new string wrapped at 80 columns.
  *
  * Words (white-delimited tokens) will not split across lines unless
- * `hard_wrap` is `true` and the word is longer than `line_length`.
+ * `hard_wrap` is `true` and the word is wider than 80 columns.
  *
- * @param orig `const std::string&` original string
- * @param hard_wrap `bool` to split a word whose length is longer than
- *  `line_length` across lines if `true`, otherwise allow oveflow
+ * @param orig Original string
+ * @param hard_wrap `true` to split a word wider than 80 columns across
+ *  lines, otherwise allow overflow
  */
-inline std::string line_wrap(const std::string& orig, bool hard_wrap = false)
+inline std::string line_wrap(std::string_view orig, bool hard_wrap = false)
 {
   return line_wrap(orig, 80, hard_wrap);
 }
@@ -0,0 +1,110 @@
+/**
+ * @file template.hh
+ * @author Derek Huang
+ * @brief C++ header for user-defined output templates of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TEMPLATE_HH_
+#define PDXKA_TEMPLATE_HH_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+/**
+ * Output template compiled once into a list of instructions.
+ *
+ * Templates are text with `%` directives substituted by RSS item fields:
+ *
+ * `%n` comic number, `%t` title, `%a` alt text, `%l` link, `%i` image URL,
+ * `%d` publication date, `%g` GUID, and `%%` a literal `%`.
+ *
+ * The `\n`, `\t`, and `\\` escapes are also recognized so that templates can
+ * be given inside single quotes on the command line.
+ *
+ * Parsing happens once in the constructor, which produces a compact vector of
+ * instructions that either copy a literal run or emit a field. Rendering just
+ * executes the instructions, so no template text is scanned per item and the
+ * same template can be reused across any number of renders.
+ */
+class PDXKA_PUBLIC compiled_template {
+public:
+  /**
+   * Enum class for the item field an instruction emits.
+   *
+   * `literal` is not a field but marks an instruction copying literal text.
+   */
+  enum class field : std::uint8_t {
+    literal, number, title, alt, link, img, date, guid
+  };
+
+  /**
+   * A single template instruction.
+   *
+   * @param what Field to emit or `field::literal` to copy literal text
+   * @param offset Offset of the literal text in the literal pool
+   * @param size Size of the literal text
+   */
+  struct instruction {
+    field what;
+    std::uint32_t offset;
+    std::uint32_t size;
+  };
+
+  /**
+   * Ctor.
+   *
+   * @param spec Template text
+   *
+   * @throws std::invalid_argument If `spec` has an unknown directive or
+   *  escape or ends in an incomplete one
+   */
+  explicit compiled_template(std::string_view spec);
+
+  /**
+   * Append an RSS item rendered with the template.
+   *
+   * @param out String to append to
+   * @param item RSS item to render
+   */
+  void render(std::string& out, const rss_item& item) const;
+
+  /**
+   * Return a new string with an RSS item rendered with the template.
+   *
+   * @param item RSS item to render
+   */
+  std::string render(const rss_item& item) const
+  {
+    std::string out;
+    render(out, item);
+    return out;
+  }
+
+  /**
+   * Return the compiled instructions.
+   */
+  const auto& instructions() const noexcept { return instructions_; }
+
+private:
+  std::string literals_;
+  std::vector<instruction> instructions_;
+
+  /**
+   * Append literal text, extending the previous literal instruction if any.
+   *
+   * @param text Literal text
+   */
+  void add_literal(std::string_view text);
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_TEMPLATE_HH_
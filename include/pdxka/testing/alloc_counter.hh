@@ -0,0 +1,248 @@
+/**
+ * @file testing/alloc_counter.hh
+ * @author Derek Huang
+ * @brief C++ header for counting heap allocations made within a scope
+ * @copyright MIT License
+ *
+ * The counts come from replacing the global `operator new` and `operator
+ * delete`. Since a program may only have one replacement, the replacement is
+ * only defined in the one translation unit that defines
+ * `PDXKA_TESTING_ALLOC_COUNTER_MAIN` before including this header, much like
+ * `BOOST_TEST_MODULE`. Calls from shared libraries, e.g. `libpdxka`, resolve
+ * to the replacement too on ELF platforms.
+ */
+
+#ifndef PDXKA_TESTING_ALLOC_COUNTER_HH_
+#define PDXKA_TESTING_ALLOC_COUNTER_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace pdxka {
+namespace testing {
+namespace detail {
+
+/**
+ * Number of allocations made by the global `operator new`.
+ */
+inline std::atomic<std::size_t> alloc_count{0u};
+
+/**
+ * Number of non-null pointers freed by the global `operator delete`.
+ */
+inline std::atomic<std::size_t> free_count{0u};
+
+/**
+ * Total bytes requested from the global `operator new`.
+ */
+inline std::atomic<std::size_t> alloc_bytes{0u};
+
+/**
+ * Currently allocated bytes.
+ */
+inline std::atomic<std::size_t> live_bytes{0u};
+
+/**
+ * Highest `live_bytes` since the last `alloc_counter` was reset.
+ */
+inline std::atomic<std::size_t> peak_bytes{0u};
+
+/**
+ * Allocation header size, which keeps the default `operator new` alignment.
+ */
+inline constexpr std::size_t alloc_header_size = alignof(std::max_align_t);
+
+/**
+ * Allocate memory, recording the size in a header before the block.
+ *
+ * @param size Requested size
+ * @returns Pointer to the block or `nullptr` on failure
+ */
+inline void* counted_alloc(std::size_t size) noexcept
+{
+  auto block = static_cast<unsigned char*>(std::malloc(size + alloc_header_size));
+  if (!block)
+    return nullptr;
+  *reinterpret_cast<std::size_t*>(block) = size;
+  alloc_count++;
+  alloc_bytes += size;
+  auto live = live_bytes += size;
+  auto peak = peak_bytes.load();
+  while (live > peak && !peak_bytes.compare_exchange_weak(peak, live));
+  return block + alloc_header_size;
+}
+
+/**
+ * Free memory allocated with `counted_alloc`.
+ *
+ * @param ptr Pointer to the block, may be `nullptr`
+ */
+inline void counted_free(void* ptr) noexcept
+{
+  if (!ptr)
+    return;
+  auto block = static_cast<unsigned char*>(ptr) - alloc_header_size;
+  free_count++;
+  live_bytes -= *reinterpret_cast<std::size_t*>(block);
+// once inlined into the replacement operator delete, GCC sees this free a
+// pointer from operator new, not knowing the replacement used malloc too
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif  // defined(__GNUC__) && !defined(__clang__)
+  std::free(block);
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif  // defined(__GNUC__) && !defined(__clang__)
+}
+
+}  // namespace detail
+
+/**
+ * Counter of global `operator new` allocations made since its construction.
+ *
+ * Counts are process-wide, so no other thread should allocate while a
+ * counter is in use. Boost.Test assertions allocate, so read the counts into
+ * locals before asserting on them. For example:
+ *
+ * @code{.cc}
+ * pdxka::testing::alloc_counter counter;
+ * pdxka::line_wrap(out, text, 80);
+ * auto allocations = counter.allocations();
+ * BOOST_TEST(allocations == 0u);
+ * @endcode
+ *
+ * @note Nothing is counted unless `PDXKA_TESTING_ALLOC_COUNTER_MAIN` was
+ *  defined in one translation unit. Only one counter's peak is meaningful at
+ *  a time since constructing or resetting a counter resets the peak.
+ */
+class alloc_counter {
+public:
+  /**
+   * Ctor.
+   */
+  alloc_counter() noexcept
+  {
+    reset();
+  }
+
+  /**
+   * Restart counting from zero.
+   */
+  void reset() noexcept
+  {
+    allocations_ = detail::alloc_count.load();
+    deallocations_ = detail::free_count.load();
+    bytes_ = detail::alloc_bytes.load();
+    live_bytes_ = detail::live_bytes.load();
+    detail::peak_bytes = live_bytes_;
+  }
+
+  /**
+   * Return the number of allocations made.
+   */
+  std::size_t allocations() const noexcept
+  {
+    return detail::alloc_count.load() - allocations_;
+  }
+
+  /**
+   * Return the number of allocations freed, including older allocations.
+   */
+  std::size_t deallocations() const noexcept
+  {
+    return detail::free_count.load() - deallocations_;
+  }
+
+  /**
+   * Return the total number of bytes allocated.
+   */
+  std::size_t bytes() const noexcept
+  {
+    return detail::alloc_bytes.load() - bytes_;
+  }
+
+  /**
+   * Return the net number of bytes still allocated, negative if more was freed.
+   */
+  std::ptrdiff_t retained_bytes() const noexcept
+  {
+    return static_cast<std::ptrdiff_t>(detail::live_bytes.load() - live_bytes_);
+  }
+
+  /**
+   * Return the highest number of bytes allocated at once over the start.
+   */
+  std::size_t peak_bytes() const noexcept
+  {
+    auto peak = detail::peak_bytes.load();
+    return (peak > live_bytes_) ? peak - live_bytes_ : 0u;
+  }
+
+private:
+  std::size_t allocations_;
+  std::size_t deallocations_;
+  std::size_t bytes_;
+  std::size_t live_bytes_;
+};
+
+}  // namespace testing
+}  // namespace pdxka
+
+#ifdef PDXKA_TESTING_ALLOC_COUNTER_MAIN
+void* operator new(std::size_t size)
+{
+  if (auto ptr = pdxka::testing::detail::counted_alloc(size))
+    return ptr;
+  throw std::bad_alloc{};
+}
+
+void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+  return pdxka::testing::detail::counted_alloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+  return pdxka::testing::detail::counted_alloc(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+  pdxka::testing::detail::counted_free(ptr);
+}
+#endif  // PDXKA_TESTING_ALLOC_COUNTER_MAIN
+
+#endif  // PDXKA_TESTING_ALLOC_COUNTER_HH_
@@ -0,0 +1,443 @@
+/**
+ * @file testing/corpus.hh
+ * @author Derek Huang
+ * @brief C++ header for generating synthetic XKCD feed corpora
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TESTING_CORPUS_HH_
+#define PDXKA_TESTING_CORPUS_HH_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "pdxka/json.hh"
+#include "pdxka/random.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/schedule.hh"
+
+namespace pdxka {
+namespace testing {
+
+/**
+ * Append text with the XML special characters escaped.
+ *
+ * @param out String to append to
+ * @param text Text to escape
+ */
+inline void append_xml_escaped(std::string& out, std::string_view text)
+{
+  for (auto c : text) {
+    switch (c) {
+      case '&':
+        out += "&amp;";
+        break;
+      case '<':
+        out += "&lt;";
+        break;
+      case '>':
+        out += "&gt;";
+        break;
+      case '"':
+        out += "&quot;";
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+/**
+ * Struct holding a civil (proleptic Gregorian) date.
+ */
+struct civil_date {
+  long year;
+  unsigned int month;
+  unsigned int day;
+  unsigned int weekday;  // 0 is Sunday
+};
+
+/**
+ * Return the civil date for a day count relative to 1970-01-01.
+ *
+ * This is Howard Hinnant's `civil_from_days` algorithm.
+ *
+ * @param days Days since 1970-01-01
+ */
+inline civil_date civil_from_days(long days) noexcept
+{
+  auto weekday = static_cast<unsigned int>(days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6);
+  days += 719468;
+  auto era = (days >= 0 ? days : days - 146096) / 146097;
+  auto doe = static_cast<unsigned long>(days - era * 146097);
+  auto yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  auto doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  auto mp = (5 * doy + 2) / 153;
+  auto day = static_cast<unsigned int>(doy - (153 * mp + 2) / 5 + 1);
+  auto month = static_cast<unsigned int>(mp < 10 ? mp + 3 : mp - 9);
+  auto year = static_cast<long>(yoe) + era * 400 + (month <= 2);
+  return {year, month, day, weekday};
+}
+
+/**
+ * Generator for synthetic XKCD comics with realistic field distributions.
+ *
+ * Alt text word counts follow a mixture of two shifted exponentials, so most
+ * are a sentence or two but about 1 in 10 run to several hundred words like
+ * the longest real ones. Words are drawn from a small vocabulary including
+ * contractions, with occasional quotes, ampersands, and angle brackets that
+ * must be escaped, and about 3% of words are non-ASCII, e.g. accented Latin,
+ * Greek, CJK, and emoji. Comics are published Monday, Wednesday, and Friday
+ * from 2006/01/02 onwards.
+ *
+ * Generation is deterministic for a given seed.
+ */
+class corpus_generator {
+public:
+  /**
+   * Ctor.
+   *
+   * @param seed Seed, where equal seeds give equal corpora
+   */
+  explicit corpus_generator(std::uint64_t seed = 0) noexcept : rng_{seed} {}
+
+  /**
+   * Return synthetic items for comics `n_items` down to 1, newest first.
+   *
+   * @param n_items Number of items
+   */
+  rss_item_vector items(std::size_t n_items)
+  {
+    rss_item_vector items;
+    items.reserve(n_items);
+    for (auto number = n_items; number; number--)
+      items.push_back(item(number));
+    return items;
+  }
+
+  /**
+   * Return a synthetic item.
+   *
+   * @param number Comic number, must be positive
+   */
+  rss_item item(std::size_t number)
+  {
+    std::string title;
+    auto n_title = 1u + uniform_below(rng_, 4u);
+    for (unsigned int i = 0; i < n_title; i++) {
+      if (i)
+        title += ' ';
+      auto start = title.size();
+      title += word();
+      if (title[start] >= 'a' && title[start] <= 'z')
+        title[start] = static_cast<char>(title[start] - 'a' + 'A');
+    }
+    // image file names are the lowercase ASCII title with underscores
+    std::string img_src{"https://imgs.xkcd.com/comics/"};
+    for (auto c : title) {
+      if (c >= 'A' && c <= 'Z')
+        img_src += static_cast<char>(c - 'A' + 'a');
+      else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
+        img_src += c;
+      else if (c == ' ')
+        img_src += '_';
+    }
+    img_src += ".png";
+    auto alt = alt_text();
+    auto link = "https://xkcd.com/" + std::to_string(number) + "/";
+    return {
+      std::move(title),
+      link,
+      std::move(img_src),
+      alt,
+      alt,
+      pub_date(number),
+      link
+    };
+  }
+
+private:
+  xoshiro256ss rng_;
+
+  /**
+   * Return a uniform random double in (0, 1].
+   */
+  double uniform() noexcept
+  {
+    return static_cast<double>((rng_() >> 11) + 1) * 0x1p-53;
+  }
+
+  /**
+   * Return an exponential random variate with the given mean.
+   */
+  double exponential(double mean) noexcept
+  {
+    return -std::log(uniform()) * mean;
+  }
+
+  /**
+   * Return a random vocabulary word.
+   */
+  std::string_view word() noexcept
+  {
+    static constexpr std::string_view ascii_words[] = {
+      "the", "of", "and", "to", "a", "in", "is", "it's", "that", "I",
+      "you", "was", "for", "on", "are", "with", "they", "be", "at", "one",
+      "have", "this", "from", "by", "not", "but", "what", "all", "were",
+      "when", "we", "there", "can", "don't", "which", "their", "if", "will",
+      "each", "about", "how", "up", "out", "them", "then", "she", "many",
+      "some", "so", "these", "would", "other", "into", "has", "more", "two",
+      "like", "him", "see", "time", "could", "no", "make", "than", "first",
+      "been", "its", "who", "now", "people", "my", "made", "over", "did",
+      "down", "only", "way", "find", "use", "may", "long", "little", "very",
+      "after", "called", "just", "where", "most", "know", "physics",
+      "graph", "probably", "universe", "science", "computer", "orbit",
+      "velociraptor", "standards", "password", "correlation", "I'm",
+      "they're", "wouldn't", "theory", "balloon", "apparatus", "organism",
+      "spacecraft", "tectonic", "statistically", "Wikipedia", "2024",
+      "cryptographic", "antidisestablishmentarianism"
+    };
+    static constexpr std::string_view utf8_words[] = {
+      "café", "naïve", "façade", "Schrödinger", "Erdős", "π", "—", "…",
+      "±", "µm", "Ångström", "日本語", "λ-calculus", "∞", "°C", "😀", "🚀",
+      "über", "résumé", "Gödel"
+    };
+    if (uniform() <= 0.03)
+      return utf8_words[uniform_below(rng_, std::size(utf8_words))];
+    return ascii_words[uniform_below(rng_, std::size(ascii_words))];
+  }
+
+  /**
+   * Return random alt text.
+   */
+  std::string alt_text()
+  {
+    auto n_words = static_cast<std::size_t>(
+      uniform() <= 0.1 ? 40. + exponential(120.) : 8. + exponential(22.)
+    );
+    if (n_words > 600u)
+      n_words = 600u;
+    std::string text;
+    for (std::size_t i = 0; i < n_words; i++) {
+      if (i)
+        text += ' ';
+      // occasional markup-like tokens that need escaping
+      auto u = uniform();
+      if (u <= 0.01)
+        text += '&';
+      else if (u <= 0.015)
+        text += uniform() <= 0.5 ? "<" : ">";
+      else if (u <= 0.03) {
+        text += '"';
+        text += word();
+        text += '"';
+      }
+      else
+        text += word();
+      // sentence punctuation
+      u = uniform();
+      if (u <= 0.08)
+        text += ',';
+      else if (u <= 0.14 || i + 1 == n_words)
+        text += uniform() <= 0.9 ? "." : "?";
+    }
+    return text;
+  }
+
+  /**
+   * Return the RFC 822 publication date of a comic.
+   *
+   * @param number Comic number, must be positive
+   */
+  static std::string pub_date(std::size_t number)
+  {
+    static constexpr std::string_view weekdays[] = {
+      "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+    };
+    static constexpr std::string_view months[] = {
+      "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    // comic 1 is Monday 2006/01/02, which is day 13150 since the epoch
+    static constexpr unsigned int slot_days[] = {0u, 2u, 4u};
+    auto index = number - 1;
+    auto days = 13150L + 7L * static_cast<long>(index / 3) + slot_days[index % 3];
+    auto date = civil_from_days(days);
+    std::string text{weekdays[date.weekday]};
+    text += ", ";
+    if (date.day < 10)
+      text += '0';
+    text += std::to_string(date.day);
+    text += ' ';
+    text += months[date.month - 1];
+    text += ' ';
+    text += std::to_string(date.year);
+    text += " 04:00:00 -0000";
+    return text;
+  }
+};
+
+/**
+ * Return the `<img>` element an XKCD feed item's description holds.
+ *
+ * @param item Item
+ */
+inline std::string corpus_img_element(const rss_item& item)
+{
+  std::string img{"<img src=\""};
+  append_xml_escaped(img, item.img_src());
+  img += "\" title=\"";
+  append_xml_escaped(img, item.img_title());
+  img += "\" alt=\"";
+  append_xml_escaped(img, item.img_alt());
+  img += "\" />";
+  return img;
+}
+
+/**
+ * Return RSS 2.0 XML laid out like `https://xkcd.com/rss.xml` for items.
+ *
+ * @param items Items, usually newest first
+ */
+inline std::string corpus_rss(const rss_item_vector& items)
+{
+  std::string xml{
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<rss version=\"2.0\"><channel><title>xkcd.com</title>"
+    "<link>https://xkcd.com/</link>"
+    "<description>xkcd.com: A webcomic of romance and math humor.</description>"
+    "<language>en</language>\n"
+  };
+  for (const auto& item : items) {
+    xml += "<item><title>";
+    append_xml_escaped(xml, item.title());
+    xml += "</title><link>";
+    append_xml_escaped(xml, item.link());
+    // the description is an escaped <img> element with escaped attributes
+    xml += "</link><description>";
+    append_xml_escaped(xml, corpus_img_element(item));
+    xml += "</description><pubDate>";
+    append_xml_escaped(xml, item.pub_date());
+    xml += "</pubDate><guid>";
+    append_xml_escaped(xml, item.guid());
+    xml += "</guid></item>\n";
+  }
+  xml += "</channel></rss>\n";
+  return xml;
+}
+
+/**
+ * Return an ISO 8601 UTC timestamp for an RFC 822 date.
+ *
+ * @param date RFC 822 date
+ *
+ * @throws std::invalid_argument If the date is malformed
+ */
+inline std::string corpus_iso_date(std::string_view date)
+{
+  auto time = parse_rfc822_date(date);
+  auto days = static_cast<long>(time / 86400);
+  auto civil = civil_from_days(days);
+  auto seconds = static_cast<unsigned int>(time - days * 86400L);
+  // room for any long year and unsigned fields so nothing can be truncated
+  char buf[64];
+  std::snprintf(
+    buf,
+    sizeof buf,
+    "%04ld-%02u-%02uT%02u:%02u:%02uZ",
+    civil.year,
+    civil.month,
+    civil.day,
+    seconds / 3600,
+    seconds / 60 % 60,
+    seconds % 60
+  );
+  return buf;
+}
+
+/**
+ * Return Atom XML laid out like `https://xkcd.com/atom.xml` for items.
+ *
+ * @param items Items, usually newest first
+ *
+ * @throws std::invalid_argument If an item date is malformed
+ */
+inline std::string corpus_atom(const rss_item_vector& items)
+{
+  std::string xml{
+    "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+    "<feed xml:lang=\"en\" xmlns=\"http://www.w3.org/2005/Atom\">"
+    "<title>xkcd.com</title>"
+    "<link href=\"https://xkcd.com/\" rel=\"alternate\"></link>"
+    "<id>https://xkcd.com/</id><updated>"
+  };
+  if (items.size())
+    xml += corpus_iso_date(items.front().pub_date());
+  xml += "</updated>\n";
+  for (const auto& item : items) {
+    xml += "<entry><title>";
+    append_xml_escaped(xml, item.title());
+    xml += "</title><link href=\"";
+    append_xml_escaped(xml, item.link());
+    xml += "\" rel=\"alternate\"></link><updated>";
+    xml += corpus_iso_date(item.pub_date());
+    xml += "</updated><id>";
+    append_xml_escaped(xml, item.guid());
+    xml += "</id><summary type=\"html\">";
+    append_xml_escaped(xml, corpus_img_element(item));
+    xml += "</summary></entry>\n";
+  }
+  xml += "</feed>\n";
+  return xml;
+}
+
+/**
+ * Return newline-delimited `info.0.json` objects for items.
+ *
+ * Each line is laid out like `https://xkcd.com/N/info.0.json`. The JSON API
+ * gives the date as separate year, month, and day strings and has news,
+ * transcript, and link fields the feed lacks, which are left empty.
+ *
+ * @param items Items, usually newest first
+ *
+ * @throws std::invalid_argument If an item date is malformed
+ */
+inline std::string corpus_info_json(const rss_item_vector& items)
+{
+  std::string json;
+  for (const auto& item : items) {
+    auto civil = civil_from_days(
+      static_cast<long>(parse_rfc822_date(item.pub_date()) / 86400)
+    );
+    json += "{\"month\": ";
+    append_json_string(json, std::to_string(civil.month));
+    json += ", \"num\": ";
+    append_json_number(json, comic_number(item));
+    json += ", \"link\": \"\", \"year\": ";
+    append_json_string(json, std::to_string(civil.year));
+    json += ", \"news\": \"\", \"safe_title\": ";
+    append_json_string(json, item.title());
+    json += ", \"transcript\": \"\", \"alt\": ";
+    append_json_string(json, item.img_alt());
+    json += ", \"img\": ";
+    append_json_string(json, item.img_src());
+    json += ", \"title\": ";
+    append_json_string(json, item.title());
+    json += ", \"day\": ";
+    append_json_string(json, std::to_string(civil.day));
+    json += "}\n";
+  }
+  return json;
+}
+
+}  // namespace testing
+}  // namespace pdxka
+
+#endif  // PDXKA_TESTING_CORPUS_HH_
@@ -0,0 +1,196 @@
+/**
+ * @file testing/http_server.hh
+ * @author Derek Huang
+ * @brief C++ header with test helpers for http_server.hh
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TESTING_HTTP_SERVER_HH_
+#define PDXKA_TESTING_HTTP_SERVER_HH_
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "pdxka/http_server.hh"
+
+namespace pdxka {
+namespace testing {
+
+/**
+ * Context manager running an `http_server` on a background thread.
+ *
+ * The server is stopped and the thread joined on destruction or on `join()`.
+ */
+class scoped_http_server {
+public:
+  /**
+   * Ctor.
+   *
+   * Starts running the server on a new thread.
+   *
+   * @param options HTTP server options
+   * @param fetcher Callable to fetch the XKCD RSS XML with
+   */
+  scoped_http_server(http_server_options options, feed_fetcher fetcher)
+    : server_{std::move(options), std::move(fetcher)},
+      thread_{
+        [this]
+        {
+          try {
+            server_.run();
+          }
+          catch (...) {
+            error_ = std::current_exception();
+            failed_ = true;
+          }
+        }
+      }
+  {}
+
+  /**
+   * Deleted copy ctor.
+   */
+  scoped_http_server(const scoped_http_server&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Stops the server and joins the thread if not already joined.
+   */
+  ~scoped_http_server()
+  {
+    if (thread_.joinable()) {
+      server_.stop();
+      thread_.join();
+    }
+  }
+
+  /**
+   * Wait until the server is listening.
+   *
+   * @param timeout Maximum time to wait
+   * @returns `true` if the server is listening before the timeout
+   */
+  bool wait_ready(std::chrono::milliseconds timeout = std::chrono::seconds{5})
+  {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!server_.port()) {
+      if (failed_ || std::chrono::steady_clock::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return true;
+  }
+
+  /**
+   * Stop the server, join the thread, and rethrow any `run()` exception.
+   */
+  void join()
+  {
+    server_.stop();
+    thread_.join();
+    if (error_)
+      std::rethrow_exception(error_);
+  }
+
+  /**
+   * Return reference to the server.
+   */
+  auto& server() noexcept { return server_; }
+
+  /**
+   * Return the port the server is listening on, 0 if not yet listening.
+   */
+  auto port() const noexcept { return server_.port(); }
+
+private:
+  http_server server_;
+  std::exception_ptr error_;
+  std::atomic<bool> failed_{false};
+  std::thread thread_;
+};
+
+/**
+ * Return a socket connected to a TCP port on an IPv4 address.
+ *
+ * `TCP_NODELAY` is set so small pipelined requests are sent immediately.
+ *
+ * @param port Port to connect to
+ * @param address Numeric IPv4 address to connect to
+ * @returns Connected socket, -1 on error
+ */
+inline int tcp_connect(unsigned short port, const char* address = "127.0.0.1")
+{
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  if (inet_pton(AF_INET, address, &addr.sin_addr) != 1)
+    return -1;
+  auto fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) < 0) {
+    close(fd);
+    return -1;
+  }
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+  return fd;
+}
+
+/**
+ * Send data on a socket, retrying on partial writes.
+ *
+ * @param fd Connected socket
+ * @param data Data to send
+ * @returns `true` if all data was sent
+ */
+inline bool send_all(int fd, const std::string& data)
+{
+  std::size_t n_sent = 0;
+  while (n_sent < data.size()) {
+    auto n = send(fd, data.data() + n_sent, data.size() - n_sent, MSG_NOSIGNAL);
+    if (n <= 0)
+      return false;
+    n_sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * Send requests and return everything received until the server closes.
+ *
+ * @param port Port to connect to
+ * @param requests Raw HTTP request bytes to send
+ * @returns Received bytes, empty if the connection failed
+ */
+inline std::string http_exchange(unsigned short port, const std::string& requests)
+{
+  auto fd = tcp_connect(port);
+  if (fd < 0)
+    return {};
+  std::string received;
+  if (send_all(fd, requests)) {
+    char buf[4096];
+    for (ssize_t n; (n = recv(fd, buf, sizeof buf, 0)) > 0; )
+      received.append(buf, static_cast<std::size_t>(n));
+  }
+  close(fd);
+  return received;
+}
+
+}  // namespace testing
+}  // namespace pdxka
+
+#endif  // PDXKA_TESTING_HTTP_SERVER_HH_
@@ -11,13 +11,18 @@
 #include <cstdint>
 #include <cstring>
 #include <functional>
+#include <iostream>
 #include <limits>
 #include <ostream>
+#include <string>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "pdxka/program_main.hh"
+#include "pdxka/testing/stream_diverter.hh"
+#include "pdxka/version.h"
 
 namespace pdxka {
 namespace testing {
@@ -320,6 +325,35 @@ program_main(T&& argv, const rss_provider& provider)
   return program_main(argv.argc(), argv.argv(), provider);
 }
 
+/**
+ * `pdxka` CLI tool program main overload for run-time arguments.
+ *
+ * This is for arguments that are not literals, e.g. temporary file paths, and
+ * so can't make an `argument_vector`. Standard output and standard error are
+ * diverted to the given streams while the program main runs.
+ *
+ * @param args Command-line arguments excluding the program name
+ * @param provider Callable providing the RSS XML to parse
+ * @param out Stream to divert standard output to
+ * @param err_out Stream to divert standard error to
+ * @returns `EXIT_SUCCESS` on success, `EXIT_FAILURE` or higher or failure
+ */
+inline int program_main(
+  std::vector<std::string> args,
+  const rss_provider& provider,
+  std::ostream& out,
+  std::ostream& err_out)
+{
+  args.insert(args.begin(), PDXKA_PROGNAME);
+  std::vector<char*> argv;
+  for (auto& arg : args)
+    argv.push_back(arg.data());
+  argv.push_back(nullptr);
+  stream_diverter out_diverter{std::cout, out};
+  stream_diverter err_diverter{std::cerr, err_out};
+  return pdxka::program_main(static_cast<int>(args.size()), argv.data(), provider);
+}
+
 }  // namespace testing
 }  // namespace pdxka
 
@@ -0,0 +1,58 @@
+/**
+ * @file testing/rss.hh
+ * @author Derek Huang
+ * @brief C++ header with test helpers for rss.hh
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TESTING_RSS_HH_
+#define PDXKA_TESTING_RSS_HH_
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "pdxka/rss.hh"
+#include "pdxka/testing/path.hh"
+
+namespace pdxka {
+namespace testing {
+
+/**
+ * Return the path to the XKCD RSS XML retrieved on 2024/06/04.
+ */
+inline auto rss_fixture_path()
+{
+  return (data_dir() / "xkcd-rss-20240604.xml").string();
+}
+
+/**
+ * Return the XKCD RSS XML retrieved on 2024/06/04 used as a test fixture.
+ *
+ * The file is read once and the contents are returned unmodified.
+ */
+inline const auto& rss_fixture()
+{
+  static const auto xml = []
+  {
+    std::ifstream fs{rss_fixture_path()};
+    return std::string{
+      std::istreambuf_iterator<char>{fs}, std::istreambuf_iterator<char>{}
+    };
+  }();
+  return xml;
+}
+
+/**
+ * Return the RSS items parsed from the `rss_fixture()` XML.
+ */
+inline const auto& rss_fixture_items()
+{
+  static const auto items = to_item_vector(parse_rss(rss_fixture()));
+  return items;
+}
+
+}  // namespace testing
+}  // namespace pdxka
+
+#endif  // PDXKA_TESTING_RSS_HH_
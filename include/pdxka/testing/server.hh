@@ -0,0 +1,136 @@
+/**
+ * @file testing/server.hh
+ * @author Derek Huang
+ * @brief C++ header with test helpers for server.hh
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TESTING_SERVER_HH_
+#define PDXKA_TESTING_SERVER_HH_
+
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "pdxka/client.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/server.hh"
+
+namespace pdxka {
+namespace testing {
+
+/**
+ * Return a unique temporary UNIX domain socket path.
+ */
+inline auto temp_socket_path()
+{
+  namespace fs = boost::filesystem;
+  return (fs::temp_directory_path() / fs::unique_path("pdxka-%%%%%%%%.sock"))
+    .string();
+}
+
+/**
+ * Context manager running a `unix_server` on a background thread.
+ *
+ * The server is stopped and the thread joined on destruction or on `join()`.
+ */
+class scoped_server {
+public:
+  /**
+   * Ctor.
+   *
+   * Starts running the server on a new thread.
+   *
+   * @param options Daemon options
+   * @param fetcher Callable to fetch the XKCD RSS XML with
+   */
+  scoped_server(server_options options, feed_fetcher fetcher)
+    : server_{std::move(options), std::move(fetcher)},
+      thread_{
+        [this]
+        {
+          try {
+            server_.run();
+          }
+          catch (...) {
+            error_ = std::current_exception();
+          }
+        }
+      }
+  {}
+
+  /**
+   * Deleted copy ctor.
+   */
+  scoped_server(const scoped_server&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Stops the server and joins the thread if not already joined.
+   */
+  ~scoped_server()
+  {
+    if (thread_.joinable()) {
+      server_.stop();
+      thread_.join();
+    }
+  }
+
+  /**
+   * Wait until the server answers queries.
+   *
+   * @param timeout Maximum time to wait
+   * @returns `true` if the server answered before the timeout
+   */
+  bool wait_ready(std::chrono::milliseconds timeout = std::chrono::seconds{5})
+  {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    rss_item_vector items;
+    while (!query_daemon(server_.options().socket_path, "latest", items)) {
+      if (std::chrono::steady_clock::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    return true;
+  }
+
+  /**
+   * Stop the server, join the thread, and rethrow any `run()` exception.
+   */
+  void join()
+  {
+    server_.stop();
+    thread_.join();
+    if (error_)
+      std::rethrow_exception(error_);
+  }
+
+  /**
+   * Return reference to the server.
+   */
+  auto& server() noexcept { return server_; }
+
+  /**
+   * Return the server's socket path.
+   */
+  const auto& socket_path() const noexcept
+  {
+    return server_.options().socket_path;
+  }
+
+private:
+  unix_server server_;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+}  // namespace testing
+}  // namespace pdxka
+
+#endif  // PDXKA_TESTING_SERVER_HH_
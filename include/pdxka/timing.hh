@@ -0,0 +1,128 @@
+/**
+ * @file timing.hh
+ * @author Derek Huang
+ * @brief C++ header for per-phase latency breakdowns
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TIMING_HH_
+#define PDXKA_TIMING_HH_
+
+#include <chrono>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/curl.hh"
+#include "pdxka/dllexport.h"
+
+namespace pdxka {
+
+/**
+ * Timer splitting elapsed wall time into consecutive named phases.
+ *
+ * Each `mark()` ends the current phase and starts the next one, so the phases
+ * add up to the time since the timer started. Phase durations measured
+ * elsewhere, e.g. by libcurl, can be recorded with `add()` and are subtracted
+ * from the phase the next `mark()` ends so nothing is counted twice.
+ *
+ * A disabled timer never reads the clock or allocates, so timing points can
+ * be left in hot paths unconditionally.
+ */
+class PDXKA_PUBLIC phase_timer {
+public:
+  using clock = std::chrono::steady_clock;
+  using duration = clock::duration;
+
+  /**
+   * Struct holding a completed phase.
+   *
+   * @param name Phase name, which must outlive the timer, e.g. a literal
+   * @param elapsed Phase duration
+   */
+  struct phase {
+    std::string_view name;
+    duration elapsed;
+  };
+
+  /**
+   * Ctor.
+   *
+   * @param enabled `true` to record phases, `false` to do nothing
+   * @param start Time the first phase started
+   */
+  explicit phase_timer(bool enabled = false, clock::time_point start = {})
+    : enabled_{enabled}, start_{start}, last_{start}
+  {}
+
+  /**
+   * Return `true` if phases are being recorded.
+   */
+  bool enabled() const noexcept { return enabled_; }
+
+  /**
+   * End the current phase, recording it under `name`.
+   *
+   * @param name Phase name, which must outlive the timer
+   */
+  void mark(std::string_view name)
+  {
+    if (!enabled_)
+      return;
+    auto now = clock::now();
+    phases_.push_back({name, now - last_ - added_});
+    last_ = now;
+    added_ = {};
+  }
+
+  /**
+   * Record a phase of the current phase that was measured elsewhere.
+   *
+   * @param name Phase name, which must outlive the timer
+   * @param elapsed Phase duration
+   */
+  void add(std::string_view name, duration elapsed)
+  {
+    if (!enabled_)
+      return;
+    phases_.push_back({name, elapsed});
+    added_ += elapsed;
+  }
+
+  /**
+   * Return the completed phases in order.
+   */
+  const auto& phases() const noexcept { return phases_; }
+
+  /**
+   * Write the phases and the total time since the start in milliseconds.
+   *
+   * @param out Stream to write to
+   */
+  void report(std::ostream& out) const;
+
+private:
+  bool enabled_;
+  clock::time_point start_;
+  clock::time_point last_;
+  duration added_{};
+  std::vector<phase> phases_;
+};
+
+/**
+ * Record the phases of a libcurl transfer.
+ *
+ * These are DNS resolution, TCP connect, the TLS handshake if any, time to
+ * first byte, and the body transfer. If the transfer failed, the stage it
+ * failed in is the last phase and takes the remaining time. Nothing is
+ * recorded if the times are unknown, e.g. for results not from libcurl.
+ *
+ * @param timer Timer to record phases with
+ * @param times Transfer phase times
+ */
+PDXKA_PUBLIC
+void add_curl_phases(phase_timer& timer, const curl_times& times);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_TIMING_HH_
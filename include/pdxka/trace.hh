@@ -0,0 +1,181 @@
+/**
+ * @file trace.hh
+ * @author Derek Huang
+ * @brief C++ header for scoped trace spans exported as Chrome trace JSON
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_TRACE_HH_
+#define PDXKA_TRACE_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "pdxka/common.h"
+#include "pdxka/dllexport.h"
+#include "pdxka/features.h"
+
+namespace pdxka {
+
+/**
+ * Number of events each thread's trace ring buffer holds.
+ *
+ * When a buffer is full the oldest events are overwritten.
+ */
+inline constexpr std::size_t trace_buffer_size = 16384u;
+
+/**
+ * Value of a trace span argument indicating there is no argument.
+ */
+inline constexpr std::uint64_t trace_no_arg = ~std::uint64_t{0};
+
+#if PDXKA_TRACING
+/**
+ * Flag indicating if trace spans are being recorded.
+ *
+ * @note Use `start_tracing()` and `stop_tracing()` to change this.
+ */
+PDXKA_PUBLIC
+extern std::atomic<bool> trace_active;
+
+/**
+ * Return the current trace clock time in nanoseconds.
+ *
+ * This is a monotonic clock relative to when `libpdxka` was loaded.
+ */
+PDXKA_PUBLIC
+std::uint64_t trace_now() noexcept;
+
+/**
+ * Record a completed span in the calling thread's trace ring buffer.
+ *
+ * The first call on a thread allocates and registers its buffer. After that
+ * recording is wait-free, as each buffer is only written by its thread.
+ *
+ * @param name Span name, which must be a string literal or otherwise live
+ *  until the trace is written
+ * @param start Span start time from `trace_now()`
+ * @param end Span end time from `trace_now()`
+ * @param arg Span argument, e.g. a byte count, or `trace_no_arg`
+ */
+PDXKA_PUBLIC
+void trace_record(
+  const char* name, std::uint64_t start, std::uint64_t end, std::uint64_t arg) noexcept;
+
+/**
+ * Scoped trace span recorded from construction until destruction.
+ *
+ * If tracing is not active when the span is constructed nothing is recorded
+ * and the only cost is one relaxed atomic load. Use the `PDXKA_TRACE_SPAN`
+ * and `PDXKA_TRACE_SPAN_ARG` macros instead so spans can be compiled out.
+ */
+class trace_span {
+public:
+  /**
+   * Ctor.
+   *
+   * @param name Span name, which must be a string literal
+   * @param arg Span argument, e.g. a byte count or index
+   */
+  explicit trace_span(const char* name, std::uint64_t arg = trace_no_arg) noexcept
+    : name_{trace_active.load(std::memory_order_relaxed) ? name : nullptr},
+      start_{name_ ? trace_now() : 0u},
+      arg_{arg}
+  {}
+
+  /**
+   * Deleted copy ctor.
+   */
+  trace_span(const trace_span&) = delete;
+
+  /**
+   * Dtor.
+   *
+   * Records the span if tracing was active when it was constructed.
+   */
+  ~trace_span()
+  {
+    if (name_)
+      trace_record(name_, start_, trace_now(), arg_);
+  }
+
+private:
+  const char* name_;
+  std::uint64_t start_;
+  std::uint64_t arg_;
+};
+
+/**
+ * Trace the rest of the enclosing scope as a span.
+ *
+ * @param name Span name string literal
+ */
+#define PDXKA_TRACE_SPAN(name) \
+  ::pdxka::trace_span PDXKA_CONCAT(pdxka_trace_span_, __LINE__){name}
+
+/**
+ * Trace the rest of the enclosing scope as a span with an argument.
+ *
+ * @param name Span name string literal
+ * @param arg Unsigned span argument, e.g. a byte count or index
+ */
+#define PDXKA_TRACE_SPAN_ARG(name, arg) \
+  ::pdxka::trace_span PDXKA_CONCAT(pdxka_trace_span_, __LINE__){ \
+    name, static_cast<std::uint64_t>(arg) \
+  }
+#else
+#define PDXKA_TRACE_SPAN(name) static_cast<void>(0)
+#define PDXKA_TRACE_SPAN_ARG(name, arg) static_cast<void>(0)
+#endif  // !PDXKA_TRACING
+
+/**
+ * Start recording trace spans.
+ *
+ * @throws std::runtime_error If libpdxka was built without tracing
+ */
+PDXKA_PUBLIC
+void start_tracing();
+
+/**
+ * Stop recording trace spans.
+ *
+ * Spans already started are still recorded when they end.
+ */
+PDXKA_PUBLIC
+void stop_tracing() noexcept;
+
+/**
+ * Discard all recorded trace spans.
+ *
+ * @note Spans must not be recorded concurrently.
+ */
+PDXKA_PUBLIC
+void clear_trace() noexcept;
+
+/**
+ * Return the recorded trace spans as Chrome trace event JSON.
+ *
+ * Each span is a complete (`"ph":"X"`) event with microsecond timestamps and
+ * its recording thread's index as the thread ID, so the output can be opened
+ * in `chrome://tracing` or the Perfetto UI. Spans being recorded concurrently
+ * may be missed, but spans that are overwritten while being read are dropped
+ * rather than reported torn.
+ */
+PDXKA_PUBLIC
+std::string trace_json();
+
+/**
+ * Write the recorded trace spans as Chrome trace event JSON to a file.
+ *
+ * @param path File path
+ *
+ * @throws std::runtime_error On write failure
+ */
+PDXKA_PUBLIC
+void write_trace(const std::string& path);
+
+}  // namespace pdxka
+
+#endif  // PDXKA_TRACE_HH_
@@ -0,0 +1,112 @@
+/**
+ * @file utf8.hh
+ * @author Derek Huang
+ * @brief C++ header for UTF-8 decoding and display width
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_UTF8_HH_
+#define PDXKA_UTF8_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/simd.hh"
+
+namespace pdxka {
+
+/**
+ * Return `true` if text is pure ASCII, i.e. has no byte with the high bit set.
+ *
+ * The high bits are tested 32 (AVX2), 16 (SSE2), or 8 bytes at a time.
+ *
+ * @param text Text to check
+ */
+inline bool is_ascii(std::string_view text) noexcept
+{
+  auto data = text.data();
+  auto size = text.size();
+  std::size_t i = 0;
+#if PDXKA_AVX2
+  for (; i + 32 <= size; i += 32)
+    if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))))
+      return false;
+#elif PDXKA_SSE2
+  for (; i + 16 <= size; i += 16)
+    if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))))
+      return false;
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, data + i, sizeof word);
+    if (word & UINT64_C(0x8080808080808080))
+      return false;
+  }
+  for (; i < size; i++)
+    if (static_cast<unsigned char>(data[i]) & 0x80u)
+      return false;
+  return true;
+}
+
+/**
+ * Decode the UTF-8 character at the start of a byte range.
+ *
+ * Malformed sequences, i.e. bad continuation bytes, overlong encodings,
+ * surrogates, and values past U+10FFFF, decode to U+FFFD and consume one byte
+ * so that decoding always makes progress.
+ *
+ * @param data Pointer to the bytes to decode
+ * @param size Number of bytes available, must be positive
+ * @param cp Decoded code point
+ * @returns Number of bytes consumed, in [1, 4]
+ */
+PDXKA_PUBLIC
+std::size_t utf8_decode(const char* data, std::size_t size, char32_t& cp) noexcept;
+
+/**
+ * Return the number of terminal columns a code point occupies.
+ *
+ * This is 0 for combining marks, format and control characters, and Hangul
+ * medial vowels and final consonants, 2 for East Asian Wide and Fullwidth
+ * characters, and 1 otherwise. ASCII, including control characters, is always
+ * 1 so that ASCII text is as wide as it is long. The lookup is a two-stage
+ * table generated at compile time from Unicode 14.0 character ranges.
+ *
+ * @param cp Code point
+ */
+PDXKA_PUBLIC
+unsigned int char_width(char32_t cp) noexcept;
+
+/**
+ * Return the number of terminal columns UTF-8 text occupies.
+ *
+ * Pure ASCII text is detected with `is_ascii` and is not decoded.
+ *
+ * @param text UTF-8 text
+ */
+PDXKA_PUBLIC
+std::size_t display_width(std::string_view text) noexcept;
+
+/**
+ * Return the size of the longest prefix of UTF-8 text fitting in `columns`.
+ *
+ * Characters are never split and zero-width characters following the last
+ * character are included. The prefix always contains at least one character,
+ * even if that character alone is wider than `columns`, so that repeatedly
+ * taking prefixes always makes progress.
+ *
+ * @param text Nonempty UTF-8 text
+ * @param columns Number of columns available
+ * @param width Set to the number of columns the prefix occupies
+ * @returns Prefix size in bytes
+ */
+PDXKA_PUBLIC
+std::size_t display_prefix(
+  std::string_view text, std::size_t columns, std::size_t& width) noexcept;
+
+}  // namespace pdxka
+
+#endif  // PDXKA_UTF8_HH_
@@ -0,0 +1,66 @@
+/**
+ * @file watch.hh
+ * @author Derek Huang
+ * @brief C++ header for watching the XKCD RSS feed for new comics
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_WATCH_HH_
+#define PDXKA_WATCH_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+
+#include "pdxka/dllexport.h"
+#include "pdxka/rss.hh"
+#include "pdxka/schedule.hh"
+#include "pdxka/server.hh"
+
+namespace pdxka {
+
+/**
+ * Struct holding the clock and sleep hooks used by `watch_feed`.
+ *
+ * Empty members use `std::time` and `std::this_thread::sleep_for`, which never
+ * stops watching. Tests substitute a simulated clock.
+ *
+ * @param now Callable returning the current UNIX time
+ * @param sleep Callable sleeping for the given duration, returning `false` to
+ *  stop watching
+ */
+struct watch_hooks {
+  std::function<std::time_t()> now;
+  std::function<bool(std::chrono::seconds)> sleep;
+};
+
+/**
+ * Watch the XKCD RSS feed, calling a handler for each new comic.
+ *
+ * After an initial fetch, whose items are taken as already seen, the feed is
+ * polled with conditional requests as directed by a `poll_planner` using the
+ * publication schedule learned from the feed's `pubDate` history. The
+ * schedule is relearned whenever the feed changes. New items are passed to
+ * `on_new` oldest first. Fetch errors after the initial fetch are printed to
+ * standard error and treated as an unchanged feed, while exceptions thrown by
+ * `on_new` stop watching and propagate to the caller.
+ *
+ * @param fetcher Callable to fetch the XKCD RSS XML with
+ * @param on_new Callable to invoke on each new RSS item
+ * @param policy Polling policy
+ * @param hooks Clock and sleep hooks
+ * @returns Number of polls made after the initial fetch
+ *
+ * @throws std::runtime_error If the initial fetch or parse fails
+ */
+PDXKA_PUBLIC
+std::size_t watch_feed(
+  const feed_fetcher& fetcher,
+  const std::function<void(const rss_item&)>& on_new,
+  const poll_policy& policy = {},
+  watch_hooks hooks = {});
+
+}  // namespace pdxka
+
+#endif  // PDXKA_WATCH_HH_
@@ -0,0 +1,146 @@
+/**
+ * @file whitespace.hh
+ * @author Derek Huang
+ * @brief C++ header for vectorized whitespace segmentation
+ * @copyright MIT License
+ */
+
+#ifndef PDXKA_WHITESPACE_HH_
+#define PDXKA_WHITESPACE_HH_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "pdxka/simd.hh"
+
+/**
+ * Name of the whitespace classification kernel selected at compile time.
+ */
+#define PDXKA_WHITESPACE_KERNEL PDXKA_SIMD_NAME
+
+namespace pdxka {
+
+/**
+ * Return `true` if a character is whitespace in the C locale.
+ *
+ * This matches `std::isspace` in the `"C"` locale, i.e. space, tab, newline,
+ * vertical tab, form feed, and carriage return, without the function call.
+ *
+ * @param c Character to classify
+ */
+constexpr bool is_ascii_space(char c) noexcept
+{
+  return c == ' ' || static_cast<unsigned char>(c - '\t') <= '\r' - '\t';
+}
+
+/**
+ * Number of bytes classified by each `whitespace_mask` call.
+ */
+#if PDXKA_AVX2
+inline constexpr std::size_t whitespace_block_size = 32u;
+#elif PDXKA_SSE2
+inline constexpr std::size_t whitespace_block_size = 16u;
+#else
+inline constexpr std::size_t whitespace_block_size = 8u;
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+
+/**
+ * Return a bitmask of the whitespace in a block of `whitespace_block_size`.
+ *
+ * Bit `i` is set if `data[i]` is whitespace as given by `is_ascii_space`.
+ *
+ * @param data Pointer to at least `whitespace_block_size` readable bytes
+ */
+inline std::uint32_t whitespace_mask(const char* data) noexcept
+{
+#if PDXKA_AVX2
+  auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  // bytes >= 0x80 are negative so are never in the signed (8, 14) range
+  auto is_space = _mm256_cmpeq_epi8(block, _mm256_set1_epi8(' '));
+  auto is_control = _mm256_and_si256(
+    _mm256_cmpgt_epi8(block, _mm256_set1_epi8('\t' - 1)),
+    _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), block)
+  );
+  return static_cast<std::uint32_t>(
+    _mm256_movemask_epi8(_mm256_or_si256(is_space, is_control))
+  );
+#elif PDXKA_SSE2
+  auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  auto is_space = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+  auto is_control = _mm_and_si128(
+    _mm_cmpgt_epi8(block, _mm_set1_epi8('\t' - 1)),
+    _mm_cmplt_epi8(block, _mm_set1_epi8('\r' + 1))
+  );
+  return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_or_si128(is_space, is_control)));
+#else
+  std::uint32_t mask = 0;
+  for (std::size_t i = 0; i < whitespace_block_size; i++)
+    mask |= static_cast<std::uint32_t>(is_ascii_space(data[i])) << i;
+  return mask;
+#endif  // !PDXKA_AVX2 && !PDXKA_SSE2
+}
+
+/**
+ * Forward iterator over the positions of whitespace in a string.
+ *
+ * Text is classified a block at a time by `whitespace_mask` and positions are
+ * produced by walking the set bits of each mask, so runs of non-whitespace
+ * cost one mask per block instead of one classification per byte. The final
+ * partial block is classified with `is_ascii_space`.
+ */
+class whitespace_finder {
+public:
+  /**
+   * Ctor.
+   *
+   * @param text Text to scan, which must outlive the finder
+   */
+  explicit whitespace_finder(std::string_view text) noexcept
+    : text_{text}, base_{0}, mask_{load(0)}
+  {}
+
+  /**
+   * Return the position of the next whitespace character.
+   *
+   * Positions are returned in increasing order. Once there is no more
+   * whitespace, the text size is returned on every call.
+   */
+  std::size_t next() noexcept
+  {
+    while (!mask_) {
+      base_ += whitespace_block_size;
+      if (base_ >= text_.size())
+        return text_.size();
+      mask_ = load(base_);
+    }
+    auto pos = base_ + lowest_set_bit(mask_);
+    // clear the lowest set bit
+    mask_ &= mask_ - 1;
+    return pos;
+  }
+
+private:
+  std::string_view text_;
+  std::size_t base_;
+  std::uint32_t mask_;
+
+  /**
+   * Return the whitespace mask of the block starting at `base`.
+   *
+   * @param base Block start, less than the text size unless the text is empty
+   */
+  std::uint32_t load(std::size_t base) const noexcept
+  {
+    if (base + whitespace_block_size <= text_.size())
+      return whitespace_mask(text_.data() + base);
+    std::uint32_t mask = 0;
+    for (auto i = base; i < text_.size(); i++)
+      mask |= static_cast<std::uint32_t>(is_ascii_space(text_[i])) << (i - base);
+    return mask;
+  }
+};
+
+}  // namespace pdxka
+
+#endif  // PDXKA_WHITESPACE_HH_
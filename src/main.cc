@@ -5,9 +5,14 @@
  * @copyright MIT License
  */
 
+#include <exception>
+#include <iostream>
+#include <tuple>
+
 #include <curl/curl.h>
 
 #include "pdxka/curl.hh"
+#include "pdxka/curl_debug.hh"
 #include "pdxka/program_main.hh"
 #include "pdxka/rss.hh"
 
@@ -16,15 +21,43 @@ namespace {
 /**
  * Callable that uses `pdxka::get_rss` to get the XKCD RSS content.
  *
+ * If a cURL debug log path is given, libcurl's debug output is captured and
+ * written there as JSON instead of being printed in verbose mode.
+ *
  * @param opts Struct holding parsed command-line options
  * @returns `curl_result` with XKCD website RSS response
  */
-auto get_xkcd_rss(const pdxka::cliopts& opts)
+pdxka::curl_result get_xkcd_rss(const pdxka::cliopts& opts)
 {
-  return pdxka::get_rss(
-    pdxka::curl_option<long>{CURLOPT_VERBOSE, opts.verbose},
-    pdxka::curl_option<long>{CURLOPT_SSL_VERIFYPEER, !opts.insecure}
-  );
+  auto get = [&opts](auto... extra_options)
+  {
+    return pdxka::get_rss(
+      pdxka::curl_option<long>{CURLOPT_SSL_VERIFYPEER, !opts.insecure},
+      // remote document time is needed for later conditional requests
+      pdxka::curl_option<long>{CURLOPT_FILETIME, 1L},
+      // only transfer the feed if modified since the given time (if any)
+      pdxka::curl_option<long>{
+        CURLOPT_TIMECONDITION,
+        opts.modified_since ? CURL_TIMECOND_IFMODSINCE : CURL_TIMECOND_NONE
+      },
+      pdxka::curl_option<curl_off_t>{
+        CURLOPT_TIMEVALUE_LARGE, static_cast<curl_off_t>(opts.modified_since)
+      },
+      extra_options...
+    );
+  };
+  if (opts.curl_log_path.empty())
+    return get(pdxka::curl_option<long>{CURLOPT_VERBOSE, opts.verbose});
+  // log is written even if the request failed since that is when it helps
+  pdxka::curl_debug_log log;
+  auto res = std::apply(get, log.options());
+  try {
+    log.write(opts.curl_log_path);
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: --curl-log: " << ex.what() << std::endl;
+  }
+  return res;
 }
 
 }  // namespace
@@ -0,0 +1,92 @@
+/**
+ * @file batch.cc
+ * @author Derek Huang
+ * @brief C++ source for answering batches of queries
+ * @copyright MIT License
+ */
+
+#include "pdxka/batch.hh"
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#include "pdxka/output.hh"
+#include "pdxka/query.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Append the answer to a single query line, without the newline.
+ *
+ * @param out String to append to
+ * @param snapshot Feed snapshot to answer from
+ * @param line Query line
+ */
+void append_answer(std::string& out, const feed_snapshot& snapshot, const std::string& line)
+{
+  query q;
+  try {
+    q = parse_query(line);
+  }
+  catch (const std::invalid_argument& ex) {
+    out += "error: ";
+    out += ex.what();
+    return;
+  }
+  auto selected = run_query(snapshot, q);
+  // search and all answer with all matches, possibly none
+  if (q.type == query_type::search || q.type == query_type::all) {
+    for (std::size_t i = 0; i < selected.size(); i++) {
+      if (i)
+        out += ' ';
+      out += selected[i]->guid();
+    }
+    return;
+  }
+  if (selected.empty()) {
+    out += "error: no such comic";
+    return;
+  }
+  out += selected.front()->img_title();
+  out += " -- ";
+  out += selected.front()->guid();
+}
+
+}  // namespace
+
+std::size_t run_batch(
+  const feed_snapshot& snapshot,
+  std::istream& in,
+  output_buffer& out,
+  std::size_t flush_every)
+{
+  std::size_t n_answered = 0;
+  for (std::string line; std::getline(in, line); ) {
+    append_answer(out.buffer(), snapshot, line);
+    out.put('\n');
+    n_answered++;
+    if (!out.end_record() && flush_every && !(n_answered % flush_every))
+      out.flush();
+  }
+  out.flush();
+  return n_answered;
+}
+
+std::size_t run_batch(
+  const feed_snapshot& snapshot,
+  std::istream& in,
+  std::ostream& out,
+  std::size_t flush_every,
+  std::size_t buffer_size)
+{
+  output_buffer buffer{out, buffer_size};
+  return run_batch(snapshot, in, buffer, flush_every);
+}
+
+}  // namespace pdxka
@@ -0,0 +1,136 @@
+/**
+ * @file client.cc
+ * @author Derek Huang
+ * @brief C++ source for the xkcd-alt UNIX domain socket daemon client
+ * @copyright MIT License
+ */
+
+#include "pdxka/client.hh"
+
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <string_view>
+
+#include "pdxka/protocol.hh"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * `send` flags. A daemon closing early must not raise `SIGPIPE`.
+ */
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif  // !MSG_NOSIGNAL
+
+/**
+ * Owning wrapper for a socket file descriptor.
+ */
+class socket_fd {
+public:
+  /**
+   * Ctor.
+   *
+   * Creates a new UNIX domain stream socket. Check `valid()` for success.
+   */
+  socket_fd() noexcept : fd_{socket(AF_UNIX, SOCK_STREAM, 0)} {}
+
+  /**
+   * Deleted copy ctor.
+   */
+  socket_fd(const socket_fd&) = delete;
+
+  /**
+   * Dtor.
+   */
+  ~socket_fd()
+  {
+    if (valid())
+      close(fd_);
+  }
+
+  /**
+   * Return `true` if the socket was created successfully.
+   */
+  bool valid() const noexcept { return fd_ >= 0; }
+
+  /**
+   * Return the raw file descriptor.
+   */
+  operator int() const noexcept { return fd_; }
+
+private:
+  int fd_;
+};
+
+}  // namespace
+
+bool query_daemon(
+  const std::string& socket_path,
+  std::string_view request,
+  rss_item_vector& items,
+  std::chrono::milliseconds timeout)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (socket_path.empty() || socket_path.size() >= sizeof addr.sun_path)
+    return false;
+  std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+  socket_fd fd;
+  if (!fd.valid())
+    return false;
+  // bound send and receive time so a wedged daemon can't hang us
+  timeval tv{};
+  tv.tv_sec = static_cast<decltype(tv.tv_sec)>(timeout.count() / 1000);
+  tv.tv_usec = static_cast<decltype(tv.tv_usec)>(timeout.count() % 1000 * 1000);
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof tv);
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof tv);
+  if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) < 0)
+    return false;
+  // send single request line and signal that there are no more
+  std::string line{request};
+  line += '\n';
+  for (std::size_t n_sent = 0; n_sent < line.size(); ) {
+    auto n = send(fd, line.data() + n_sent, line.size() - n_sent, send_flags);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      return false;
+    n_sent += static_cast<std::size_t>(n);
+  }
+  shutdown(fd, SHUT_WR);
+  // daemon closes the connection after answering
+  std::string response;
+  char buf[4096];
+  while (true) {
+    auto n = recv(fd, buf, sizeof buf, 0);
+    if (n > 0)
+      response.append(buf, static_cast<std::size_t>(n));
+    else if (!n)
+      break;
+    else if (errno != EINTR)
+      return false;
+  }
+  // malformed or error response
+  try {
+    items = decode_response(response);
+  }
+  catch (const std::exception&) {
+    return false;
+  }
+  return true;
+}
+
+}  // namespace pdxka
@@ -0,0 +1,166 @@
+/**
+ * @file curl_debug.cc
+ * @author Derek Huang
+ * @brief C++ source for structured capture of libcurl debug output
+ * @copyright MIT License
+ */
+
+#include "pdxka/curl_debug.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <curl/curl.h>
+
+#include "pdxka/json.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Debug info types in the order they appear in the JSON byte totals.
+ */
+constexpr curl_infotype curl_debug_types[] = {
+  CURLINFO_TEXT,
+  CURLINFO_HEADER_IN,
+  CURLINFO_HEADER_OUT,
+  CURLINFO_DATA_IN,
+  CURLINFO_DATA_OUT,
+  CURLINFO_SSL_DATA_IN,
+  CURLINFO_SSL_DATA_OUT
+};
+
+/**
+ * Return `true` if events of the debug info type only keep their size.
+ *
+ * @param type libcurl debug info type
+ */
+constexpr bool is_data(curl_infotype type) noexcept
+{
+  return type != CURLINFO_TEXT && type != CURLINFO_HEADER_IN &&
+    type != CURLINFO_HEADER_OUT;
+}
+
+}  // namespace
+
+std::string_view curl_debug_type_name(curl_infotype type) noexcept
+{
+  switch (type) {
+    case CURLINFO_TEXT:
+      return "text";
+    case CURLINFO_HEADER_IN:
+      return "header_in";
+    case CURLINFO_HEADER_OUT:
+      return "header_out";
+    case CURLINFO_DATA_IN:
+      return "data_in";
+    case CURLINFO_DATA_OUT:
+      return "data_out";
+    case CURLINFO_SSL_DATA_IN:
+      return "ssl_data_in";
+    case CURLINFO_SSL_DATA_OUT:
+      return "ssl_data_out";
+    default:
+      return "unknown";
+  }
+}
+
+std::size_t curl_debug_log::bytes(curl_infotype type) const noexcept
+{
+  std::size_t total = 0;
+  for (const auto& event : events_)
+    if (event.type == type)
+      total += event.size;
+  return total;
+}
+
+void curl_debug_log::record(curl_infotype type, std::string_view data)
+{
+  auto time = static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      clock::now() - start_
+    ).count()
+  );
+  if (is_data(type)) {
+    events_.push_back({time, type, {}, data.size()});
+    return;
+  }
+  // outgoing headers arrive as a whole block and text may span lines
+  while (data.size()) {
+    auto end = data.find('\n');
+    auto line = data.substr(0, end);
+    auto size = (end == std::string_view::npos) ? data.size() : end + 1;
+    data.remove_prefix(size);
+    if (line.size() && line.back() == '\r')
+      line.remove_suffix(1);
+    if (line.size())
+      events_.push_back({time, type, std::string{line}, size});
+  }
+}
+
+std::string curl_debug_log::json() const
+{
+  std::string out{"{\"start\":"};
+  out += std::to_string(start_unix_);
+  out += ",\"events\":[";
+  for (std::size_t i = 0; i < events_.size(); i++) {
+    const auto& event = events_[i];
+    if (i)
+      out += ',';
+    out += "{\"time\":";
+    append_json_number(out, event.time);
+    out += ",\"type\":";
+    append_json_string(out, curl_debug_type_name(event.type));
+    if (is_data(event.type)) {
+      out += ",\"bytes\":";
+      append_json_number(out, event.size);
+    }
+    else {
+      out += ",\"text\":";
+      append_json_string(out, event.text);
+    }
+    out += '}';
+  }
+  out += "],\"bytes\":{";
+  for (auto type : curl_debug_types) {
+    if (type != curl_debug_types[0])
+      out += ',';
+    append_json_string(out, curl_debug_type_name(type));
+    out += ':';
+    append_json_number(out, bytes(type));
+  }
+  out += "}}";
+  return out;
+}
+
+void curl_debug_log::write(const std::string& path) const
+{
+  auto text = json();
+  text += '\n';
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  if (!out.write(text.data(), static_cast<std::streamsize>(text.size())).flush())
+    throw std::runtime_error{"error writing " + path};
+}
+
+int curl_debug_log::callback(
+  CURL* /*handle*/, curl_infotype type, char* data, std::size_t size, void* log) noexcept
+{
+  if (!log || !data)
+    return 0;
+  // libcurl is C so nothing may be thrown. on allocation failure the event
+  // is just dropped since the log is purely informational
+  try {
+    static_cast<curl_debug_log*>(log)->record(type, {data, size});
+  }
+  catch (...) {}
+  return 0;
+}
+
+}  // namespace pdxka
@@ -0,0 +1,207 @@
+/**
+ * @file format.cc
+ * @author Derek Huang
+ * @brief C++ source for machine-readable output formats of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#include "pdxka/format.hh"
+
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "pdxka/json.hh"
+#include "pdxka/output.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/simd.hh"
+#include "pdxka/string.hh"
+#include "pdxka/trace.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Header row naming the delimited fields, joined by `Delim`.
+ *
+ * Field order matches the keys written by `append_json`.
+ *
+ * @tparam Delim Field delimiter
+ */
+template <char Delim>
+constexpr char delimited_header[] = {
+  'n', 'u', 'm', 'b', 'e', 'r', Delim,
+  't', 'i', 't', 'l', 'e', Delim,
+  'l', 'i', 'n', 'k', Delim,
+  'i', 'm', 'g', '_', 's', 'r', 'c', Delim,
+  'i', 'm', 'g', '_', 't', 'i', 't', 'l', 'e', Delim,
+  'i', 'm', 'g', '_', 'a', 'l', 't', Delim,
+  'p', 'u', 'b', '_', 'd', 'a', 't', 'e', Delim,
+  'g', 'u', 'i', 'd', '\n'
+};
+
+/**
+ * Append an RSS item as a delimited record.
+ *
+ * @tparam Delim Field delimiter
+ * @tparam AppendField Callable appending an escaped field
+ *
+ * @param out String to append to
+ * @param item RSS item to encode
+ * @param append_field Callable taking the output string and field value
+ */
+template <char Delim, typename AppendField>
+void append_delimited(std::string& out, const rss_item& item, AppendField append_field)
+{
+  append_json_number(out, comic_number(item));
+  // views so the fields are not copied
+  for (
+    auto field : std::initializer_list<std::string_view>{
+      item.title(),
+      item.link(),
+      item.img_src(),
+      item.img_title(),
+      item.img_alt(),
+      item.pub_date(),
+      item.guid()
+    }
+  ) {
+    out += Delim;
+    append_field(out, field);
+  }
+  out += '\n';
+}
+
+}  // namespace
+
+output_format parse_output_format(std::string_view name)
+{
+  if (name == "text")
+    return output_format::text;
+  if (name == "json")
+    return output_format::json;
+  if (name == "ndjson")
+    return output_format::ndjson;
+  if (name == "csv")
+    return output_format::csv;
+  if (name == "tsv")
+    return output_format::tsv;
+  throw std::invalid_argument{
+    "unknown output format \"" + std::string{name} +
+    "\", expected text, json, ndjson, csv, or tsv"
+  };
+}
+
+void append_csv_field(std::string& out, std::string_view value)
+{
+  // most fields need no quoting so they are copied unchanged
+  auto n = find_special<false, ',', '"', '\r', '\n'>(value.data(), value.size());
+  if (n == value.size()) {
+    out.append(value);
+    return;
+  }
+  out += '"';
+  while (true) {
+    n = find_special<false, '"'>(value.data(), value.size());
+    out.append(value.data(), n);
+    if (n == value.size())
+      break;
+    out += "\"\"";
+    value.remove_prefix(n + 1);
+  }
+  out += '"';
+}
+
+void append_tsv_field(std::string& out, std::string_view value)
+{
+  while (true) {
+    auto n = find_special<false, '\\', '\t', '\n', '\r'>(value.data(), value.size());
+    out.append(value.data(), n);
+    if (n == value.size())
+      break;
+    const char escape[] = {
+      '\\',
+      (value[n] == '\\') ? '\\' : (value[n] == '\t') ? 't' : (value[n] == '\n') ? 'n' : 'r'
+    };
+    out.append(escape, sizeof escape);
+    value.remove_prefix(n + 1);
+  }
+}
+
+void append_text(std::string& out, const rss_item& item, bool one_line)
+{
+  // if printing as one line
+  if (one_line) {
+    out.append(item.img_title());
+    out.append(" -- ");
+  }
+  // else print fortune-style
+  else {
+    line_wrap(out, item.img_title(), 80);
+    out.append("\n\t\t-- ");
+  }
+  out.append(item.guid());
+  out += '\n';
+}
+
+void record_writer::begin()
+{
+  switch (format_) {
+    case output_format::json:
+      out_.put('[');
+      break;
+    case output_format::csv:
+      out_.append({delimited_header<','>, sizeof delimited_header<','>});
+      break;
+    case output_format::tsv:
+      out_.append({delimited_header<'\t'>, sizeof delimited_header<'\t'>});
+      break;
+    default:
+      break;
+  }
+}
+
+void record_writer::write(const rss_item& item)
+{
+  PDXKA_TRACE_SPAN("format_item");
+  if (!count_)
+    begin();
+  auto& buf = out_.buffer();
+  switch (format_) {
+    case output_format::text:
+      if (template_)
+        template_->render(buf, item);
+      else
+        append_text(buf, item, one_line_);
+      break;
+    case output_format::json:
+      // one object per line inside the array
+      buf += count_ ? ",\n" : "\n";
+      append_json(buf, item);
+      break;
+    case output_format::ndjson:
+      append_json(buf, item);
+      buf += '\n';
+      break;
+    case output_format::csv:
+      append_delimited<','>(buf, item, append_csv_field);
+      break;
+    case output_format::tsv:
+      append_delimited<'\t'>(buf, item, append_tsv_field);
+      break;
+  }
+  count_++;
+  out_.end_record();
+}
+
+void record_writer::finish()
+{
+  if (!count_)
+    begin();
+  if (format_ == output_format::json)
+    out_.append(count_ ? "\n]\n" : "]\n");
+}
+
+}  // namespace pdxka
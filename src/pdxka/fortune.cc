@@ -0,0 +1,266 @@
+/**
+ * @file fortune.cc
+ * @author Derek Huang
+ * @brief C++ source for exporting XKCD alt text as a fortune(6) database
+ * @copyright MIT License
+ */
+
+#include "pdxka/fortune.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pdxka/format.hh"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Cookie delimiter line.
+ */
+constexpr std::string_view delimiter_line{"%\n"};
+
+/**
+ * `strfile` flags for randomized, ordered, or rotated cookie files.
+ *
+ * The offsets of such files are not in file order so they are not extended.
+ */
+constexpr std::uint32_t unordered_flags = 0x1u | 0x2u | 0x4u;
+
+/**
+ * Append a 32-bit value in big-endian byte order.
+ *
+ * @param out String to append to
+ * @param value Value to append
+ */
+void put_be32(std::string& out, std::uint32_t value)
+{
+  const char bytes[] = {
+    static_cast<char>(value >> 24),
+    static_cast<char>(value >> 16),
+    static_cast<char>(value >> 8),
+    static_cast<char>(value)
+  };
+  out.append(bytes, sizeof bytes);
+}
+
+/**
+ * Read a 32-bit big-endian value.
+ *
+ * @param data Pointer to at least 4 readable bytes
+ */
+std::uint32_t get_be32(const char* data) noexcept
+{
+  auto bytes = reinterpret_cast<const unsigned char*>(data);
+  return (std::uint32_t{bytes[0]} << 24) | (std::uint32_t{bytes[1]} << 16) |
+    (std::uint32_t{bytes[2]} << 8) | std::uint32_t{bytes[3]};
+}
+
+/**
+ * Read a file's contents, or part of them.
+ *
+ * @param path File path
+ * @param offset Offset to start reading from
+ * @param size Number of bytes to read, all remaining bytes if `npos`
+ *
+ * @throws std::runtime_error If the file cannot be read
+ */
+std::string read_file(
+  const std::filesystem::path& path,
+  std::size_t offset = 0u,
+  std::size_t size = std::string::npos)
+{
+  std::ifstream in{path, std::ios::binary};
+  if (!in)
+    throw std::runtime_error{"cannot open " + path.string() + " for reading"};
+  std::string data;
+  if (size == std::string::npos) {
+    in.seekg(static_cast<std::streamoff>(offset));
+    data.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+  }
+  else {
+    data.resize(size);
+    in.seekg(static_cast<std::streamoff>(offset));
+    in.read(data.data(), static_cast<std::streamsize>(size));
+  }
+  if (in.bad() || (size != std::string::npos && !in))
+    throw std::runtime_error{"error reading " + path.string()};
+  return data;
+}
+
+/**
+ * Return the GUID from a cookie's attestation line, empty if there is none.
+ *
+ * @param cookie Cookie text
+ */
+std::string_view cookie_guid(std::string_view cookie) noexcept
+{
+  constexpr std::string_view attestation{"\t\t-- "};
+  auto pos = cookie.rfind(attestation);
+  if (pos == std::string_view::npos)
+    return {};
+  auto guid = cookie.substr(pos + attestation.size());
+  return guid.substr(0, guid.find('\n'));
+}
+
+}  // namespace
+
+void strfile_index::add(std::uint32_t size)
+{
+  push(static_cast<std::uint64_t>(offsets_.back()) + size + delimiter_line.size(), size);
+}
+
+void strfile_index::push(std::uint64_t next, std::uint32_t size)
+{
+  if (next > std::numeric_limits<std::uint32_t>::max())
+    throw std::runtime_error{"cookie file too large for 32-bit strfile offsets"};
+  offsets_.push_back(static_cast<std::uint32_t>(next));
+  longest_ = std::max(longest_, size);
+  shortest_ = std::min(shortest_, size);
+}
+
+std::string strfile_index::serialize() const
+{
+  std::string out;
+  out.reserve(strfile_header_size + 4u * offsets_.size());
+  put_be32(out, strfile_version);
+  put_be32(out, static_cast<std::uint32_t>(count()));
+  put_be32(out, longest_);
+  put_be32(out, shortest());
+  // flags, none since the offsets are in file order
+  put_be32(out, 0u);
+  // delimiter followed by padding
+  out.append({delimiter_line[0], '\0', '\0', '\0'});
+  for (auto offset : offsets_)
+    put_be32(out, offset);
+  return out;
+}
+
+strfile_index strfile_index::parse(std::string_view data)
+{
+  if (data.size() < strfile_header_size)
+    throw std::runtime_error{"strfile index too short"};
+  if (get_be32(data.data()) != strfile_version)
+    throw std::runtime_error{"unsupported strfile index version"};
+  auto n_cookies = get_be32(data.data() + 4);
+  if (data.size() != strfile_header_size + 4u * (std::size_t{n_cookies} + 1u))
+    throw std::runtime_error{"strfile index size does not match cookie count"};
+  if (get_be32(data.data() + 16) & unordered_flags)
+    throw std::runtime_error{"strfile index offsets are not in file order"};
+  if (data[20] != delimiter_line[0])
+    throw std::runtime_error{"strfile index has an unsupported delimiter"};
+  strfile_index index;
+  index.longest_ = get_be32(data.data() + 8);
+  index.shortest_ = n_cookies ? get_be32(data.data() + 12) : no_cookies;
+  index.offsets_.clear();
+  for (std::size_t i = 0; i <= n_cookies; i++)
+    index.offsets_.push_back(get_be32(data.data() + strfile_header_size + 4u * i));
+  if (index.offsets_.front() || !std::is_sorted(index.offsets_.begin(), index.offsets_.end()))
+    throw std::runtime_error{"strfile index offsets are not in file order"};
+  return index;
+}
+
+strfile_index strfile_index::scan(std::string_view cookies)
+{
+  strfile_index index;
+  // start of the current cookie, which like strfile only moves past empty
+  // cookies without recording an offset for them
+  std::size_t start = 0;
+  for (std::size_t pos = 0; pos < cookies.size(); ) {
+    auto end = cookies.find('\n', pos);
+    if (end == std::string_view::npos)
+      break;
+    end++;
+    if (cookies.substr(pos, end - pos) == delimiter_line) {
+      if (pos > start)
+        index.push(end, static_cast<std::uint32_t>(pos - start));
+      start = end;
+    }
+    pos = end;
+  }
+  return index;
+}
+
+fortune_export_result export_fortune(
+  const std::filesystem::path& dir,
+  const rss_item_vector& items,
+  std::string_view name)
+{
+  namespace fs = std::filesystem;
+  fs::create_directories(dir);
+  const auto cookie_path = dir / name;
+  const auto dat_path = dir / (std::string{name} + ".dat");
+  // index of the existing cookies, from the index file if it is up to date
+  std::uintmax_t cookie_size = fs::exists(cookie_path) ? fs::file_size(cookie_path) : 0u;
+  strfile_index index;
+  if (cookie_size) {
+    auto indexed = false;
+    if (fs::exists(dat_path)) {
+      try {
+        index = strfile_index::parse(read_file(dat_path));
+        indexed = (index.offsets().back() == cookie_size);
+      }
+      catch (const std::runtime_error&) {}
+    }
+    if (!indexed)
+      index = strfile_index::scan(read_file(cookie_path));
+    if (index.offsets().back() != cookie_size)
+      throw std::runtime_error{
+        cookie_path.string() + " does not end with a % delimiter line"
+      };
+  }
+  // only the last cookie is read to find where the feed picks up
+  std::string last_cookie;
+  if (auto n = index.count()) {
+    const auto& offsets = index.offsets();
+    last_cookie = read_file(cookie_path, offsets[n - 1], offsets[n] - offsets[n - 1]);
+  }
+  const auto last_guid = cookie_guid(last_cookie);
+  auto n_new = items.size();
+  if (last_guid.size()) {
+    auto last = std::find_if(
+      items.begin(),
+      items.end(),
+      [last_guid](const rss_item& item) { return item.guid() == last_guid; }
+    );
+    if (last != items.end())
+      n_new = static_cast<std::size_t>(last - items.begin());
+  }
+  // append new cookies oldest first with a single write
+  std::string cookies;
+  for (auto i = n_new; i-- > 0; ) {
+    auto start = cookies.size();
+    append_text(cookies, items[i], false);
+    index.add(static_cast<std::uint32_t>(cookies.size() - start));
+    cookies.append(delimiter_line);
+  }
+  if (cookies.size()) {
+    std::ofstream out{cookie_path, std::ios::binary | std::ios::app};
+    if (!out.write(cookies.data(), static_cast<std::streamsize>(cookies.size())).flush())
+      throw std::runtime_error{"error writing " + cookie_path.string()};
+  }
+  // replace the index so fortune never sees a partially written one
+  auto tmp_path = dat_path;
+  tmp_path += ".tmp";
+  {
+    auto dat = index.serialize();
+    std::ofstream out{tmp_path, std::ios::binary | std::ios::trunc};
+    if (!out.write(dat.data(), static_cast<std::streamsize>(dat.size())).flush())
+      throw std::runtime_error{"error writing " + tmp_path.string()};
+  }
+  fs::rename(tmp_path, dat_path);
+  return {n_new, index.count()};
+}
+
+}  // namespace pdxka
@@ -0,0 +1,812 @@
+/**
+ * @file http_server.cc
+ * @author Derek Huang
+ * @brief C++ source for the xkcd-alt HTTP/JSON server
+ * @copyright MIT License
+ */
+
+#include "pdxka/http_server.hh"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pdxka/json.hh"
+#include "pdxka/query.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/server.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/trace.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Maximum size of a request's line and headers.
+ */
+constexpr std::size_t max_header_size = 8192u;
+
+/**
+ * Maximum size of a request body, which is read and ignored.
+ */
+constexpr std::size_t max_body_size = 65536u;
+
+/**
+ * Maximum number of unsent response bytes per connection.
+ *
+ * Past this, no more requests are answered or read from the connection until
+ * the client has read some of its responses.
+ */
+constexpr std::size_t max_output_backlog = 1u << 20;
+
+/**
+ * Time to stop accepting connections for after running out of descriptors.
+ */
+constexpr std::chrono::milliseconds accept_backoff{100};
+
+/**
+ * Maximum number of events handled per `epoll_wait` call.
+ */
+constexpr int max_events = 64;
+
+/**
+ * Return a `std::runtime_error` describing the last `errno` value.
+ *
+ * @param what Description of the operation that failed
+ */
+auto errno_error(const std::string& what)
+{
+  return std::runtime_error{what + ": " + std::strerror(errno)};
+}
+
+/**
+ * Return the reason phrase for an HTTP status code.
+ *
+ * @param status HTTP status code
+ */
+const char* reason_phrase(int status) noexcept
+{
+  switch (status) {
+    case 200:
+      return "OK";
+    case 400:
+      return "Bad Request";
+    case 404:
+      return "Not Found";
+    case 405:
+      return "Method Not Allowed";
+    case 413:
+      return "Payload Too Large";
+    case 431:
+      return "Request Header Fields Too Large";
+    default:
+      return "Internal Server Error";
+  }
+}
+
+/**
+ * Return an error response with a JSON error message body.
+ *
+ * @param status HTTP status code
+ * @param message Error message
+ */
+http_response error_response(int status, std::string_view message)
+{
+  http_response response{status, "{\"error\":"};
+  append_json_string(response.body, message);
+  response.body += '}';
+  return response;
+}
+
+/**
+ * Parse a non-negative integral path segment.
+ *
+ * @param text Path segment
+ * @param value Parsed value
+ * @returns `true` on success
+ */
+bool parse_unsigned(std::string_view text, unsigned int& value) noexcept
+{
+  auto [end, err] = std::from_chars(text.data(), text.data() + text.size(), value);
+  return text.size() && err == std::errc{} && end == text.data() + text.size();
+}
+
+/**
+ * Return the value of a hexadecimal digit, -1 if not a hex digit.
+ *
+ * @param c Character
+ */
+int hex_value(char c) noexcept
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+/**
+ * Decode a URL-encoded query string component.
+ *
+ * Plus signs are decoded as spaces. Invalid percent escapes are kept as is.
+ *
+ * @param text Encoded text
+ */
+std::string url_decode(std::string_view text)
+{
+  std::string out;
+  out.reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); i++) {
+    if (text[i] == '+')
+      out += ' ';
+    else if (
+      text[i] == '%' && i + 2 < text.size() &&
+      hex_value(text[i + 1]) >= 0 && hex_value(text[i + 2]) >= 0
+    ) {
+      out += static_cast<char>(hex_value(text[i + 1]) * 16 + hex_value(text[i + 2]));
+      i += 2;
+    }
+    else
+      out += text[i];
+  }
+  return out;
+}
+
+/**
+ * Return the decoded value of a query string parameter.
+ *
+ * @param query_string Query string without the leading `?`
+ * @param name Parameter name
+ * @param value Decoded parameter value
+ * @returns `true` if the parameter was found
+ */
+bool find_query_param(
+  std::string_view query_string, std::string_view name, std::string& value)
+{
+  while (query_string.size()) {
+    auto amp_pos = query_string.find('&');
+    auto param = query_string.substr(0, amp_pos);
+    auto eq_pos = param.find('=');
+    if (param.substr(0, eq_pos) == name) {
+      value = (eq_pos == std::string_view::npos) ?
+        std::string{} : url_decode(param.substr(eq_pos + 1));
+      return true;
+    }
+    if (amp_pos == std::string_view::npos)
+      break;
+    query_string.remove_prefix(amp_pos + 1);
+  }
+  return false;
+}
+
+/**
+ * Return `true` if two strings are equal ignoring ASCII case.
+ *
+ * @param a First string
+ * @param b Second string
+ */
+bool iequals(std::string_view a, std::string_view b) noexcept
+{
+  return a.size() == b.size() && std::equal(
+    a.begin(),
+    a.end(),
+    b.begin(),
+    [](char x, char y)
+    {
+      return std::tolower(static_cast<unsigned char>(x)) ==
+        std::tolower(static_cast<unsigned char>(y));
+    }
+  );
+}
+
+/**
+ * Append a complete HTTP/1.1 response to a string.
+ *
+ * @param out String to append to
+ * @param response Response status and body
+ * @param keep_alive `false` to announce that the connection will be closed
+ * @param head `true` to omit the body, as for a `HEAD` request
+ */
+void append_http_response(
+  std::string& out, const http_response& response, bool keep_alive, bool head)
+{
+  out += "HTTP/1.1 ";
+  out += std::to_string(response.status);
+  out += ' ';
+  out += reason_phrase(response.status);
+  out += "\r\nContent-Type: application/json\r\nContent-Length: ";
+  out += std::to_string(response.body.size());
+  if (!keep_alive)
+    out += "\r\nConnection: close";
+  out += "\r\n\r\n";
+  if (!head)
+    out += response.body;
+}
+
+/**
+ * Connection state.
+ *
+ * @param in Received bytes not yet consumed as complete requests
+ * @param out Response bytes not yet sent
+ * @param closing `true` if the connection is closed once `out` is sent
+ */
+struct http_connection {
+  std::string in;
+  std::string out;
+  bool closing = false;
+};
+
+/**
+ * Append a final error response and close the connection once it is sent.
+ *
+ * @param conn Connection state
+ * @param status HTTP status code
+ * @param message Error message
+ */
+void reject_request(http_connection& conn, int status, std::string_view message)
+{
+  append_http_response(conn.out, error_response(status, message), false, false);
+  conn.closing = true;
+}
+
+/**
+ * Append responses for the complete requests buffered on a connection.
+ *
+ * Requests are answered in order, which is what makes pipelining work.
+ * Answering stops early once `max_output_backlog` response bytes are pending.
+ *
+ * @param conn Connection state
+ * @param snapshot Feed snapshot to answer from
+ * @returns `true` if stopped early with complete requests possibly left over
+ */
+bool process_requests(http_connection& conn, const feed_snapshot& snapshot)
+{
+  std::string_view in{conn.in};
+  std::size_t consumed = 0;
+  auto backlogged = false;
+  while (!conn.closing) {
+    if (conn.out.size() > max_output_backlog) {
+      backlogged = true;
+      break;
+    }
+    auto pending = in.substr(consumed);
+    auto header_end = pending.find("\r\n\r\n");
+    if (
+      (header_end == std::string_view::npos && pending.size() > max_header_size) ||
+      (header_end != std::string_view::npos && header_end > max_header_size)
+    ) {
+      reject_request(conn, 431, "request header too large");
+      break;
+    }
+    if (header_end == std::string_view::npos)
+      break;
+    // request line
+    auto line_end = pending.find("\r\n");
+    auto request_line = pending.substr(0, line_end);
+    auto sp1 = request_line.find(' ');
+    auto sp2 = request_line.rfind(' ');
+    if (sp1 == std::string_view::npos || sp1 == sp2) {
+      reject_request(conn, 400, "malformed request line");
+      break;
+    }
+    auto method = request_line.substr(0, sp1);
+    auto target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+    auto version = request_line.substr(sp2 + 1);
+    // headers relevant to framing and persistence
+    auto keep_alive = (version == "HTTP/1.1");
+    std::size_t content_length = 0;
+    auto valid_length = true;
+    auto headers = pending.substr(line_end + 2, header_end - line_end);
+    while (headers.size()) {
+      auto header_line = headers.substr(0, headers.find("\r\n"));
+      headers.remove_prefix(std::min(headers.size(), header_line.size() + 2));
+      auto colon = header_line.find(':');
+      if (colon == std::string_view::npos)
+        continue;
+      auto name = header_line.substr(0, colon);
+      auto value = header_line.substr(colon + 1);
+      while (value.size() && value.front() == ' ')
+        value.remove_prefix(1);
+      if (iequals(name, "connection")) {
+        if (iequals(value, "close"))
+          keep_alive = false;
+        else if (iequals(value, "keep-alive"))
+          keep_alive = true;
+      }
+      else if (iequals(name, "content-length")) {
+        while (value.size() && value.back() == ' ')
+          value.remove_suffix(1);
+        auto [end, err] = std::from_chars(
+          value.data(), value.data() + value.size(), content_length
+        );
+        valid_length = value.size() && err == std::errc{} &&
+          end == value.data() + value.size();
+      }
+    }
+    // framing of later requests is unknown so the connection is closed
+    if (!valid_length) {
+      reject_request(conn, 400, "invalid Content-Length");
+      break;
+    }
+    if (content_length > max_body_size) {
+      reject_request(conn, 413, "request body too large");
+      break;
+    }
+    // wait for any request body, which is ignored
+    auto request_size = header_end + 4 + content_length;
+    if (pending.size() < request_size)
+      break;
+    consumed += request_size;
+    // answer request
+    PDXKA_TRACE_SPAN("http_request");
+    auto head = (method == "HEAD");
+    auto response = (method == "GET" || head) ?
+      handle_http_request(snapshot, method, target) :
+      error_response(405, "only GET and HEAD are supported");
+    append_http_response(conn.out, response, keep_alive, head);
+    if (!keep_alive)
+      conn.closing = true;
+  }
+  conn.in.erase(0, consumed);
+  return backlogged;
+}
+
+/**
+ * Send as much of the pending response bytes as possible.
+ *
+ * @param fd Connection socket
+ * @param conn Connection state
+ * @returns `false` if the connection failed
+ */
+bool write_pending(int fd, http_connection& conn)
+{
+  std::size_t n_sent = 0;
+  while (n_sent < conn.out.size()) {
+    auto n = send(
+      fd, conn.out.data() + n_sent, conn.out.size() - n_sent, MSG_NOSIGNAL
+    );
+    if (n >= 0) {
+      n_sent += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      break;
+    if (errno != EINTR)
+      return false;
+  }
+  conn.out.erase(0, n_sent);
+  return true;
+}
+
+/**
+ * Return a non-blocking listening TCP socket.
+ *
+ * @param options HTTP server options providing the address
+ * @param port Port to bind to, 0 for any free port
+ * @param reuse_port `true` to set `SO_REUSEPORT` for multiple workers
+ *
+ * @throws std::runtime_error On error
+ */
+int make_tcp_listener(
+  const http_server_options& options, unsigned short port, bool reuse_port)
+{
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV;
+  addrinfo* info;
+  auto port_str = std::to_string(port);
+  if (auto err = getaddrinfo(options.address.c_str(), port_str.c_str(), &hints, &info))
+    throw std::runtime_error{
+      "invalid address " + options.address + ": " + gai_strerror(err)
+    };
+  std::unique_ptr<addrinfo, decltype(&freeaddrinfo)> info_guard{info, freeaddrinfo};
+  auto fd = socket(
+    info->ai_family, info->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0
+  );
+  if (fd < 0)
+    throw errno_error("socket");
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof on);
+  if (
+    (reuse_port && setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof on) < 0) ||
+    bind(fd, info->ai_addr, info->ai_addrlen) < 0 ||
+    listen(fd, SOMAXCONN) < 0
+  ) {
+    auto ex = errno_error(
+      "cannot listen on " + options.address + ":" + port_str
+    );
+    close(fd);
+    throw ex;
+  }
+  return fd;
+}
+
+/**
+ * Return the local port a socket is bound to.
+ *
+ * @param fd Bound socket
+ */
+unsigned short bound_port(int fd)
+{
+  sockaddr_storage addr{};
+  socklen_t len = sizeof addr;
+  if (getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) < 0)
+    throw errno_error("getsockname");
+  if (addr.ss_family == AF_INET6)
+    return ntohs(reinterpret_cast<sockaddr_in6*>(&addr)->sin6_port);
+  return ntohs(reinterpret_cast<sockaddr_in*>(&addr)->sin_port);
+}
+
+/**
+ * Server stopped by the signal handler.
+ */
+std::atomic<http_server*> signal_server{nullptr};
+
+/**
+ * Signal handler that stops the `signal_server`.
+ */
+extern "C" void stop_signal_http_server(int /*signum*/)
+{
+  if (auto server = signal_server.load())
+    server->stop();
+}
+
+}  // namespace
+
+void parse_endpoint(std::string_view endpoint, http_server_options& options)
+{
+  auto colon = endpoint.rfind(':');
+  if (colon == std::string_view::npos)
+    throw std::invalid_argument{"endpoint must be HOST:PORT"};
+  auto host = endpoint.substr(0, colon);
+  // strip IPv6 brackets
+  if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+    host = host.substr(1, host.size() - 2);
+  if (host.empty())
+    throw std::invalid_argument{"endpoint host is empty"};
+  auto port_str = endpoint.substr(colon + 1);
+  unsigned short port;
+  auto [end, err] = std::from_chars(
+    port_str.data(), port_str.data() + port_str.size(), port
+  );
+  if (port_str.empty() || err != std::errc{} || end != port_str.data() + port_str.size())
+    throw std::invalid_argument{
+      "invalid endpoint port \"" + std::string{port_str} + "\""
+    };
+  options.address = host;
+  options.port = port;
+}
+
+http_response handle_http_request(
+  const feed_snapshot& snapshot, std::string_view method, std::string_view target)
+{
+  if (method != "GET" && method != "HEAD")
+    return error_response(405, "only GET and HEAD are supported");
+  // split off query string
+  auto query_pos = target.find('?');
+  auto path = target.substr(0, query_pos);
+  auto query_string = (query_pos == std::string_view::npos) ?
+    std::string_view{} : target.substr(query_pos + 1);
+  // map route to item query
+  query q;
+  if (path == "/latest")
+    q.type = query_type::latest;
+  else if (path.substr(0, 6) == "/back/") {
+    q.type = query_type::back;
+    if (!parse_unsigned(path.substr(6), q.value))
+      return error_response(400, "invalid number of comics to go back");
+  }
+  else if (path.substr(0, 7) == "/comic/") {
+    q.type = query_type::number;
+    if (!parse_unsigned(path.substr(7), q.value))
+      return error_response(400, "invalid comic number");
+  }
+  else if (path == "/search") {
+    q.type = query_type::search;
+    if (!find_query_param(query_string, "q", q.text) || q.text.empty())
+      return error_response(400, "missing search text parameter q");
+  }
+  else
+    return error_response(404, "no such route");
+  auto selected = run_query(snapshot, q);
+  // search returns an array of all matches
+  http_response response{200, {}};
+  if (q.type == query_type::search) {
+    response.body += '[';
+    for (std::size_t i = 0; i < selected.size(); i++) {
+      if (i)
+        response.body += ',';
+      append_json(response.body, *selected[i]);
+    }
+    response.body += ']';
+    return response;
+  }
+  // otherwise single item
+  if (selected.empty())
+    return error_response(404, "no such comic");
+  append_json(response.body, *selected.front());
+  return response;
+}
+
+http_server::http_server(http_server_options options, feed_fetcher fetcher)
+  : options_{std::move(options)},
+    fetcher_{std::move(fetcher)},
+    modified_{},
+    port_{0}
+{
+  if (pipe2(wakeup_fds_, O_NONBLOCK | O_CLOEXEC) < 0)
+    throw errno_error("pipe2");
+}
+
+http_server::~http_server()
+{
+  close(wakeup_fds_[0]);
+  close(wakeup_fds_[1]);
+}
+
+void http_server::stop() noexcept
+{
+  char byte = 0;
+  // pipe is never drained so every waiting thread sees it as readable
+  [[maybe_unused]] auto n = write(wakeup_fds_[1], &byte, 1);
+}
+
+bool http_server::refresh()
+{
+  rss_item_vector items;
+  if (!refresh_feed(fetcher_, modified_, items))
+    return false;
+  // build snapshot off to the side then swap it in for the workers
+  snapshot_.publish(std::make_shared<const feed_snapshot>(std::move(items), modified_));
+  return true;
+}
+
+void http_server::serve_worker(int listen_fd)
+{
+  auto epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (epoll_fd < 0) {
+    std::cerr << "Error: epoll_create1: " << std::strerror(errno) << std::endl;
+    return;
+  }
+  // wakeup pipe and listener are identified by their file descriptors
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = wakeup_fds_[0];
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup_fds_[0], &event);
+  event.data.fd = listen_fd;
+  epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+  std::unordered_map<int, http_connection> conns;
+  // close connection and stop watching it
+  auto drop = [&conns, epoll_fd](int fd)
+  {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    conns.erase(fd);
+  };
+  // listener is unwatched for a while after running out of descriptors
+  using clock_type = std::chrono::steady_clock;
+  auto accept_paused = false;
+  clock_type::time_point accept_resume;
+  epoll_event events[max_events];
+  auto running = true;
+  while (running) {
+    auto timeout = -1;
+    if (accept_paused)
+      timeout = std::max(
+        1 + static_cast<int>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            accept_resume - clock_type::now()
+          ).count()
+        ),
+        0
+      );
+    auto n_events = epoll_wait(epoll_fd, events, max_events, timeout);
+    if (n_events < 0 && errno != EINTR) {
+      std::cerr << "Error: epoll_wait: " << std::strerror(errno) << std::endl;
+      break;
+    }
+    if (accept_paused && clock_type::now() >= accept_resume) {
+      event.events = EPOLLIN;
+      event.data.fd = listen_fd;
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event);
+      accept_paused = false;
+    }
+    for (int i = 0; i < n_events; i++) {
+      auto fd = events[i].data.fd;
+      // stop requested
+      if (fd == wakeup_fds_[0]) {
+        running = false;
+        break;
+      }
+      // accept all pending connections
+      if (fd == listen_fd) {
+        while (true) {
+          auto conn_fd = accept4(
+            listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC
+          );
+          if (conn_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+              continue;
+            // listener stays readable so back off instead of spinning
+            if (
+              errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM
+            ) {
+              epoll_ctl(epoll_fd, EPOLL_CTL_DEL, listen_fd, nullptr);
+              accept_paused = true;
+              accept_resume = clock_type::now() + accept_backoff;
+            }
+            break;
+          }
+          int on = 1;
+          setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof on);
+          event.events = EPOLLIN | EPOLLRDHUP;
+          event.data.fd = conn_fd;
+          epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn_fd, &event);
+          conns.emplace(conn_fd, http_connection{});
+        }
+        continue;
+      }
+      auto iter = conns.find(fd);
+      if (iter == conns.end())
+        continue;
+      auto& conn = iter->second;
+      if (events[i].events & EPOLLERR) {
+        drop(fd);
+        continue;
+      }
+      // read what is available, unless the client isn't reading its responses,
+      // but no more than one maximum size request beyond what is buffered
+      auto peer_closed = false;
+      if (
+        events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP) &&
+        conn.out.size() <= max_output_backlog
+      ) {
+        char buf[16384];
+        while (conn.in.size() <= max_header_size + max_body_size) {
+          auto n = recv(fd, buf, sizeof buf, 0);
+          if (n > 0) {
+            conn.in.append(buf, static_cast<std::size_t>(n));
+            continue;
+          }
+          if (!n || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+            peer_closed = true;
+          if (!n || errno != EINTR)
+            break;
+        }
+      }
+      // answer complete requests, sending in between if the backlog fills up.
+      // hold reference so a refresh can't free the snapshot mid-request
+      auto snapshot = snapshot_.load();
+      auto failed = !write_pending(fd, conn);
+      for (
+        auto backlogged = true;
+        !failed && backlogged && conn.out.size() <= max_output_backlog;
+      ) {
+        backlogged = process_requests(conn, *snapshot);
+        failed = !write_pending(fd, conn);
+      }
+      if (failed || (conn.out.empty() && (conn.closing || peer_closed))) {
+        drop(fd);
+        continue;
+      }
+      // only wait for writability while there are pending responses and
+      // stop reading, including hangups, while the client isn't reading them
+      event.events = (conn.out.size() > max_output_backlog) ?
+        EPOLLOUT : EPOLLIN | EPOLLRDHUP | (conn.out.size() ? EPOLLOUT : 0u);
+      event.data.fd = fd;
+      epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    }
+  }
+  for (const auto& [fd, conn] : conns)
+    close(fd);
+  close(epoll_fd);
+}
+
+void http_server::run()
+{
+  // initial fetch must succeed, otherwise there is nothing to serve
+  try {
+    refresh();
+  }
+  catch (const std::exception& ex) {
+    throw std::runtime_error{std::string{"initial refresh failed: "} + ex.what()};
+  }
+  // bind first listener to learn the port, then bind any others to it
+  auto n_workers = std::max(options_.workers, 1u);
+  std::vector<int> listen_fds;
+  try {
+    listen_fds.push_back(make_tcp_listener(options_, options_.port, n_workers > 1));
+    auto port = bound_port(listen_fds.front());
+    while (listen_fds.size() < n_workers)
+      listen_fds.push_back(make_tcp_listener(options_, port, true));
+    port_ = port;
+  }
+  catch (...) {
+    for (auto fd : listen_fds)
+      close(fd);
+    throw;
+  }
+  // start workers then refresh on this thread until stop is requested
+  std::vector<std::thread> workers;
+  for (auto fd : listen_fds)
+    workers.emplace_back(&http_server::serve_worker, this, fd);
+  pollfd wakeup{wakeup_fds_[0], POLLIN, 0};
+  auto timeout = static_cast<int>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::min(options_.refresh_interval, std::chrono::seconds{86400})
+    ).count()
+  );
+  while (true) {
+    auto n_ready = poll(&wakeup, 1, timeout);
+    if (n_ready < 0 && errno == EINTR)
+      continue;
+    if (n_ready)
+      break;
+    try {
+      refresh();
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Error: refresh failed: " << ex.what() << std::endl;
+    }
+  }
+  for (auto& worker : workers)
+    worker.join();
+  for (auto fd : listen_fds)
+    close(fd);
+  port_ = 0;
+}
+
+int serve_http(const http_server_options& options, const feed_fetcher& fetcher)
+{
+  try {
+    http_server server{options, fetcher};
+    // stop gracefully on SIGINT and SIGTERM
+    struct sigaction action{};
+    action.sa_handler = stop_signal_http_server;
+    sigemptyset(&action.sa_mask);
+    signal_server = &server;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+    server.run();
+    signal_server = nullptr;
+  }
+  catch (const std::exception& ex) {
+    signal_server = nullptr;
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace pdxka
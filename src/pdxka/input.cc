@@ -0,0 +1,249 @@
+/**
+ * @file input.cc
+ * @author Derek Huang
+ * @brief C++ source for reading the RSS feed from a file or standard input
+ * @copyright MIT License
+ */
+
+#include "pdxka/input.hh"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/features.h"
+#include "pdxka/trace.hh"
+
+#if !PDXKA_WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // !PDXKA_WIN32
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Size of each read from standard input or an unmappable file.
+ */
+constexpr std::size_t read_chunk_size = 65536u;
+
+/**
+ * Return a `std::runtime_error` for a failed system call on a file.
+ *
+ * @param what Failed operation, e.g. `"open"`
+ * @param path File path
+ */
+std::runtime_error file_error(std::string_view what, const std::string& path)
+{
+  return std::runtime_error{
+    std::string{what} + " " + path + ": " + std::strerror(errno)
+  };
+}
+
+/**
+ * Read all of standard input.
+ *
+ * `std::cin` is read rather than the file descriptor so that standard input
+ * can be redirected within the process, e.g. in tests.
+ *
+ * @param out String to append to
+ *
+ * @throws std::runtime_error If standard input cannot be read
+ */
+void read_stdin(std::string& out)
+{
+  auto buf = std::cin.rdbuf();
+  while (true) {
+    auto offset = out.size();
+    out.resize(offset + read_chunk_size);
+    auto n = buf->sgetn(out.data() + offset, read_chunk_size);
+    out.resize(offset + static_cast<std::size_t>(n));
+    if (n < static_cast<std::streamsize>(read_chunk_size))
+      break;
+  }
+  if (std::cin.bad())
+    throw std::runtime_error{"error reading standard input"};
+}
+
+#if !PDXKA_WIN32
+/**
+ * Read all remaining bytes of a file descriptor.
+ *
+ * @param fd File descriptor
+ * @param path File path for error messages
+ * @param out String to append to
+ *
+ * @throws std::runtime_error On read error
+ */
+void read_fd(int fd, const std::string& path, std::string& out)
+{
+  while (true) {
+    auto offset = out.size();
+    out.resize(offset + read_chunk_size);
+    auto n = ::read(fd, out.data() + offset, read_chunk_size);
+    if (n < 0) {
+      out.resize(offset);
+      if (errno == EINTR)
+        continue;
+      throw file_error("read", path);
+    }
+    out.resize(offset + static_cast<std::size_t>(n));
+    if (!n)
+      break;
+  }
+}
+
+/**
+ * File descriptor closed on scope exit.
+ */
+class scoped_fd {
+public:
+  explicit scoped_fd(int fd) noexcept : fd_{fd} {}
+
+  scoped_fd(const scoped_fd&) = delete;
+
+  ~scoped_fd()
+  {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  int get() const noexcept { return fd_; }
+
+private:
+  int fd_;
+};
+#endif  // !PDXKA_WIN32
+
+}  // namespace
+
+feed_input::feed_input(const std::string& path)
+{
+  PDXKA_TRACE_SPAN("read_input");
+  if (path == "-") {
+    read_stdin(buffer_);
+    view_ = buffer_;
+    return;
+  }
+#if PDXKA_WIN32
+  struct _stat64 info;
+  if (_stat64(path.c_str(), &info))
+    throw file_error("stat", path);
+  file_time_ = static_cast<std::time_t>(info.st_mtime);
+  std::ifstream stream{path, std::ios::binary};
+  if (!stream)
+    throw file_error("open", path);
+  buffer_.assign(std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{});
+  if (stream.bad())
+    throw file_error("read", path);
+  view_ = buffer_;
+#else
+  scoped_fd fd{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd.get() < 0)
+    throw file_error("open", path);
+  struct stat info;
+  if (::fstat(fd.get(), &info))
+    throw file_error("stat", path);
+  file_time_ = info.st_mtime;
+  // empty files can't be mapped and pipes, sockets, etc. must be read
+  if (S_ISREG(info.st_mode) && info.st_size > 0) {
+    auto size = static_cast<std::size_t>(info.st_size);
+    auto map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+    if (map != MAP_FAILED) {
+      // parsing reads the feed once front to back
+      ::posix_madvise(map, size, POSIX_MADV_SEQUENTIAL);
+      map_ = map;
+      map_size_ = size;
+      view_ = {static_cast<const char*>(map_), map_size_};
+      return;
+    }
+  }
+  read_fd(fd.get(), path, buffer_);
+  view_ = buffer_;
+#endif  // !PDXKA_WIN32
+}
+
+feed_input::feed_input(feed_input&& other) noexcept
+  : map_{std::exchange(other.map_, nullptr)},
+    map_size_{std::exchange(other.map_size_, 0u)},
+    buffer_{std::move(other.buffer_)},
+    file_time_{other.file_time_}
+{
+  // a view of the moved buffer would be invalidated by small string moves
+  view_ = map_ ? other.view_ : std::string_view{buffer_};
+  other.view_ = {};
+}
+
+feed_input& feed_input::operator=(feed_input&& other) noexcept
+{
+  if (this == &other)
+    return *this;
+  unmap();
+  map_ = std::exchange(other.map_, nullptr);
+  map_size_ = std::exchange(other.map_size_, 0u);
+  buffer_ = std::move(other.buffer_);
+  file_time_ = other.file_time_;
+  view_ = map_ ? other.view_ : std::string_view{buffer_};
+  other.view_ = {};
+  return *this;
+}
+
+feed_input::~feed_input()
+{
+  unmap();
+}
+
+void feed_input::unmap() noexcept
+{
+#if !PDXKA_WIN32
+  if (map_)
+    ::munmap(map_, map_size_);
+#endif  // !PDXKA_WIN32
+  map_ = nullptr;
+  map_size_ = 0u;
+}
+
+curl_result read_input(const std::string& path, std::time_t modified_since)
+{
+  curl_result res{CURLE_OK, "", request_type::get, ""};
+  try {
+    // unchanged files are answered like a server's 304 without reading them
+    if (modified_since && path != "-") {
+      struct stat info;
+      if (::stat(path.c_str(), &info))
+        throw file_error("stat", path);
+      if (info.st_mtime <= modified_since) {
+        res.response_code = 304;
+        res.file_time = static_cast<curl_off_t>(info.st_mtime);
+        return res;
+      }
+    }
+    feed_input input{path};
+    res.payload = input.view();
+    res.response_code = 200;
+    res.file_time = static_cast<curl_off_t>(input.file_time());
+  }
+  catch (const std::exception& ex) {
+    res.status = CURLE_READ_ERROR;
+    res.reason = ex.what();
+  }
+  return res;
+}
+
+}  // namespace pdxka
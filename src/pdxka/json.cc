@@ -0,0 +1,95 @@
+/**
+ * @file json.cc
+ * @author Derek Huang
+ * @brief C++ source for JSON encoding of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#include "pdxka/json.hh"
+
+#include <charconv>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "pdxka/rss.hh"
+#include "pdxka/simd.hh"
+
+namespace pdxka {
+
+void append_json_string(std::string& out, std::string_view value)
+{
+  static constexpr char hex_digits[] = "0123456789abcdef";
+  out += '"';
+  while (!value.empty()) {
+    // copy the run before the next character needing escaping in one go
+    auto n = find_special<true, '"', '\\'>(value.data(), value.size());
+    out.append(value.data(), n);
+    if (n == value.size())
+      break;
+    switch (auto c = value[n]) {
+      case '"':
+        out += "\\\"";
+        break;
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\b':
+        out += "\\b";
+        break;
+      case '\f':
+        out += "\\f";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      // remaining control characters use \u00XX form
+      default: {
+        const char escape[] = {
+          '\\', 'u', '0', '0',
+          hex_digits[static_cast<unsigned char>(c) >> 4],
+          hex_digits[static_cast<unsigned char>(c) & 0xf]
+        };
+        out.append(escape, sizeof escape);
+      }
+    }
+    value.remove_prefix(n + 1);
+  }
+  out += '"';
+}
+
+void append_json_number(std::string& out, unsigned long value)
+{
+  char digits[std::numeric_limits<unsigned long>::digits10 + 1];
+  // buffer always has room so the result cannot be an error
+  out.append(digits, std::to_chars(digits, digits + sizeof digits, value).ptr);
+}
+
+void append_json(std::string& out, const rss_item& item)
+{
+  out += "{\"number\":";
+  append_json_number(out, comic_number(item));
+  out += ",\"title\":";
+  append_json_string(out, item.title());
+  out += ",\"link\":";
+  append_json_string(out, item.link());
+  out += ",\"img_src\":";
+  append_json_string(out, item.img_src());
+  out += ",\"img_title\":";
+  append_json_string(out, item.img_title());
+  out += ",\"img_alt\":";
+  append_json_string(out, item.img_alt());
+  out += ",\"pub_date\":";
+  append_json_string(out, item.pub_date());
+  out += ",\"guid\":";
+  append_json_string(out, item.guid());
+  out += '}';
+}
+
+}  // namespace pdxka
@@ -0,0 +1,130 @@
+/**
+ * @file output.cc
+ * @author Derek Huang
+ * @brief C++ source for buffered output written straight to a file descriptor
+ * @copyright MIT License
+ */
+
+#include "pdxka/output.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "pdxka/features.h"
+#include "pdxka/trace.hh"
+
+#if PDXKA_WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif  // !PDXKA_WIN32
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * `std::cout` stream buffer at startup, used to detect redirection.
+ *
+ * `<iostream>` is included above so `std::cout` is initialized first.
+ */
+std::streambuf* const default_cout_buf = std::cout.rdbuf();
+
+/**
+ * Write all bytes to a file descriptor, retrying short writes and `EINTR`.
+ *
+ * @param fd File descriptor
+ * @param data Bytes to write
+ * @param size Number of bytes to write
+ *
+ * @throws std::runtime_error If writing fails
+ */
+void write_all(int fd, const char* data, std::size_t size)
+{
+  while (size) {
+#if PDXKA_WIN32
+    // _write takes an unsigned int count
+    auto n = _write(fd, data, static_cast<unsigned int>(std::min<std::size_t>(size, 1u << 30)));
+#else
+    auto n = ::write(fd, data, size);
+#endif  // !PDXKA_WIN32
+    if (n < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::runtime_error{std::string{"write: "} + std::strerror(errno)};
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+}
+
+}  // namespace
+
+output_buffer::output_buffer(int fd, std::size_t capacity)
+  : fd_{fd}, stream_{}, capacity_{capacity}
+{
+  buffer_.reserve(capacity_);
+}
+
+output_buffer::output_buffer(std::ostream& out, std::size_t capacity)
+  : fd_{-1}, stream_{&out}, capacity_{capacity}
+{
+  buffer_.reserve(capacity_);
+}
+
+output_buffer::output_buffer(output_buffer&& other) noexcept
+  : fd_{other.fd_},
+    stream_{other.stream_},
+    capacity_{other.capacity_},
+    buffer_{std::move(other.buffer_)}
+{
+  // moved-from buffer must have nothing left to flush
+  other.buffer_.clear();
+}
+
+output_buffer::~output_buffer()
+{
+  try {
+    flush();
+  }
+  catch (...) {}
+}
+
+void output_buffer::flush()
+{
+  if (buffer_.empty())
+    return;
+  PDXKA_TRACE_SPAN_ARG("output_flush", buffer_.size());
+  if (stream_) {
+    stream_->write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    stream_->flush();
+  }
+  else {
+    // drop output that failed to write so the dtor doesn't retry it
+    try {
+      write_all(fd_, buffer_.data(), buffer_.size());
+    }
+    catch (...) {
+      buffer_.clear();
+      throw;
+    }
+  }
+  buffer_.clear();
+}
+
+output_buffer stdout_buffer(std::size_t capacity)
+{
+  std::cout.flush();
+  if (std::cout.rdbuf() != default_cout_buf)
+    return output_buffer{std::cout, capacity};
+  return output_buffer{1, capacity};
+}
+
+}  // namespace pdxka
@@ -7,70 +7,209 @@
 
 #include "pdxka/program_main.hh"
 
+#include <charconv>
+#include <chrono>
+#include <cstddef>
 #include <cstdlib>
+#include <ctime>
 #include <exception>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <system_error>
 #include <utility>
+#include <vector>
 
 #include <boost/exception/diagnostic_information.hpp>
 
+#include "pdxka/batch.hh"
 #include "pdxka/curl.hh"
 #include "pdxka/features.h"
+#include "pdxka/format.hh"
+#include "pdxka/fortune.hh"
+#include "pdxka/input.hh"
+#include "pdxka/output.hh"
 #include "pdxka/program_options.hh"
+#include "pdxka/provider_chain.hh"
+#include "pdxka/random.hh"
 #include "pdxka/rss.hh"
-#include "pdxka/string.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/template.hh"
+#include "pdxka/timing.hh"
+#include "pdxka/trace.hh"
 
-#if !PDXKA_USE_BOOST_PROGRAM_OPTIONS
-#include <stdexcept>
-#include <utility>
-#endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
+#if !PDXKA_WIN32
+#include "pdxka/server.hh"
+#include "pdxka/watch.hh"
+#endif  // !PDXKA_WIN32
+
+#if PDXKA_LINUX
+#include "pdxka/http_server.hh"
+#endif  // PDXKA_LINUX
 
 namespace pdxka {
 
 namespace {
 
+/**
+ * Extract a non-negative integral argument value.
+ *
+ * Both option parsers use this so that they accept exactly the same values.
+ * The whole value must be decimal digits, so e.g. `3x`, `-1`, and `+1` are
+ * rejected, and it must fit in an `unsigned int`.
+ *
+ * @param input Argument value
+ * @param name Option name(s) to use in error messages, e.g. `-b, --back`
+ * @param value Value to set
+ * @returns `true` if the value is valid, `false` with an error printed
+ */
+bool extract_unsigned(const std::string& input, const char* name, unsigned int& value)
+{
+  auto end = input.data() + input.size();
+  auto [ptr, ec] = std::from_chars(input.data(), end, value);
+  if (ec == std::errc::result_out_of_range) {
+    std::cerr << "Error: " << input << " is out of range for " << name <<
+      std::endl;
+    return false;
+  }
+  if (input.empty() || ec != std::errc{} || ptr != end) {
+    std::cerr << "Error: " << input << " is an invalid argument for " << name <<
+      ". Specified value must be a non-negative integer" << std::endl;
+    return false;
+  }
+  return true;
+}
+
 #if !PDXKA_USE_BOOST_PROGRAM_OPTIONS
 /**
- * Extract the value of the `previous` argument from the CLI option map.
+ * Extract a non-negative integral argument value from the CLI option map.
  *
  * @param opt_map Command-line option map from `pdxka::parse_options`
- * @returns Pair of `previous` and boolean indicating if the value is valid
- */
-std::pair<unsigned int, bool> extract_previous(cliopt_map& opt_map)
-{
-  // if not specified, we just return 0
-  auto back_iter = opt_map.find("back");
-  if (back_iter == opt_map.end())
-    return {0, true};
-  // specified, so get const reference to string value + declare int value
-  const auto& back_input = opt_map.at("back")[0];
-  int back;
-  // we need to convert to integral value; int is accepted for input sanity
-  try {
-    back = std::stoi(back_input);
-  }
-  // catch conversion failure or overflow
-  catch (const std::invalid_argument&) {
-    std::cerr << "Error: " << back_input << " is an invalid argument " <<
-      "for -b, --back" << std::endl;
+ * @param key Option map key of the argument
+ * @param name Option name(s) to use in error messages, e.g. `-b, --back`
+ * @param default_value Value to use if the option was not specified
+ * @returns Pair of the value and boolean indicating if the value is valid
+ */
+std::pair<unsigned int, bool> extract_unsigned(
+  cliopt_map& opt_map,
+  const std::string& key,
+  const char* name,
+  unsigned int default_value)
+{
+  // if not specified, we just return the default
+  auto iter = opt_map.find(key);
+  if (iter == opt_map.end())
+    return {default_value, true};
+  unsigned int value;
+  if (!extract_unsigned(iter->second[0], name, value))
     return {0, false};
+  return {value, true};
+}
+#endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
+
+/**
+ * Check that the options selecting which comics to print are not combined.
+ *
+ * @param back `true` if `-b, --back` was given
+ * @param all `true` if `--all` was given
+ * @param random `true` if `--random` was given
+ * @returns `true` if at most one was given, `false` with an error printed
+ */
+bool check_selection(bool back, bool all, bool random)
+{
+  const char* given[3];
+  std::size_t n_given = 0;
+  if (back)
+    given[n_given++] = "-b, --back";
+  if (all)
+    given[n_given++] = "--all";
+  if (random)
+    given[n_given++] = "--random";
+  if (n_given > 1) {
+    std::cerr << "Error: " << given[0] << " and " << given[1] <<
+      " are mutually exclusive" << std::endl;
+    return false;
   }
-  catch (const std::out_of_range&) {
-    std::cerr << "Error: " << back_input << " is out of integer range " <<
+  return true;
+}
+
+/**
+ * Check that a `--random` count is positive.
+ *
+ * @param random `--random` value
+ * @returns `true` if the count is positive, `false` with an error printed
+ */
+bool check_random(unsigned int random)
+{
+  if (!random) {
+    std::cerr << "Error: Invalid argument 0 for --random. Specified value " <<
+      "must be positive" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Extract the range of strips to go back from the `-b, --back` value.
+ *
+ * The value is either a single number `N`, selecting the Nth previous strip,
+ * or an inclusive range `A..B`, selecting the Ath through Bth previous strips.
+ *
+ * @param value Argument value
+ * @param first Index of the first selected strip to set
+ * @param last Index of the last selected strip to set
+ * @returns `true` if the value is valid, `false` with an error printed
+ */
+bool extract_back(const std::string& value, unsigned int& first, unsigned int& last)
+{
+  auto parse = [](std::string_view text, unsigned int& number)
+  {
+    auto end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, number);
+    return text.size() && ec == std::errc{} && ptr == end;
+  };
+  std::string_view text{value};
+  auto sep = text.find("..");
+  auto valid = (sep == std::string_view::npos) ?
+    parse(text, first) && parse(text, last) :
+    parse(text.substr(0, sep), first) && parse(text.substr(sep + 2), last);
+  if (!valid) {
+    std::cerr << "Error: " << value << " is an invalid argument for -b, " <<
+      "--back. Specified value must be N or A..B for non-negative N, A, B" <<
       std::endl;
-    return {0, false};
+    return false;
   }
-  // can't be negative
-  if (back < 0) {
-    std::cerr << "Error: Invalid argument " << back << " for -b, --back. " <<
-      "Specified value must be positive" << std::endl;
-    return {0, false};
+  if (first > last) {
+    std::cerr << "Error: Invalid range " << value << " for -b, --back. " <<
+      "Range start must not be after its end" << std::endl;
+    return false;
   }
-  return {back, true};
+  return true;
+}
+
+/**
+ * Extract the output format from the `--format` argument value.
+ *
+ * @param name Format name
+ * @param format Output format to set
+ * @returns `true` if the format is valid, `false` with an error printed
+ */
+bool extract_format(const std::string& name, output_format& format)
+{
+  try {
+    format = parse_output_format(name);
+  }
+  catch (const std::invalid_argument& ex) {
+    std::cerr << "Error: --format: " << ex.what() << std::endl;
+    return false;
+  }
+  return true;
 }
-#endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
 
 /**
  * Parse the command-line arguments and extract the relevant argument values.
@@ -102,12 +241,68 @@ cliopts extract_args(int argc, char* argv[])
     std::exit(EXIT_SUCCESS);
   }
   // extract variables from parse_result variable map
-  return {
-    parse_result.map["one-line"].as<bool>(),
-    parse_result.map["back"].as<unsigned int>(),
-    parse_result.map["verbose"].as<bool>(),
-    parse_result.map["insecure"].as<bool>()
+  cliopts opts;
+  opts.one_line = parse_result.map["one-line"].as<bool>();
+  if (
+    !extract_back(
+      parse_result.map["back"].as<std::string>(), opts.previous, opts.previous_last
+    )
+  )
+    std::exit(EXIT_FAILURE);
+  // unsigned values are parsed as strings so both parsers accept the same
+  auto extract = [&parse_result](const char* key, const char* name, auto& value)
+  {
+    if (!parse_result.map.count(key))
+      return;
+    unsigned int number;
+    if (!extract_unsigned(parse_result.map[key].as<std::string>(), name, number))
+      std::exit(EXIT_FAILURE);
+    value = number;
   };
+  opts.all = parse_result.map["all"].as<bool>();
+  extract("random", "--random", opts.random);
+  if (
+    !check_selection(
+      !parse_result.map["back"].defaulted(), opts.all, parse_result.map.count("random")
+    ) ||
+    (parse_result.map.count("random") && !check_random(opts.random))
+  )
+    std::exit(EXIT_FAILURE);
+  extract("seed", "--seed", opts.seed);
+  if (parse_result.map.count("fortune"))
+    opts.fortune_dir = parse_result.map["fortune"].as<std::string>();
+  opts.verbose = parse_result.map["verbose"].as<bool>();
+  if (parse_result.map.count("curl-log"))
+    opts.curl_log_path = parse_result.map["curl-log"].as<std::string>();
+  opts.insecure = parse_result.map["insecure"].as<bool>();
+  opts.timing = parse_result.map["timing"].as<bool>();
+  if (parse_result.map.count("trace"))
+    opts.trace_path = parse_result.map["trace"].as<std::string>();
+  if (parse_result.map.count("serve"))
+    opts.serve_path = parse_result.map["serve"].as<std::string>();
+  extract("refresh", "--refresh", opts.refresh);
+  if (parse_result.map.count("input"))
+    opts.input_path = parse_result.map["input"].as<std::string>();
+  if (parse_result.map.count("cache"))
+    opts.cache_path = parse_result.map["cache"].as<std::string>();
+  else if (auto cache_env = std::getenv(PDXKA_CACHE_ENV))
+    opts.cache_path = cache_env;
+  extract("cache-ttl", "--cache-ttl", opts.cache_ttl);
+  if (parse_result.map.count("socket"))
+    opts.socket_path = parse_result.map["socket"].as<std::string>();
+  else if (auto socket_env = std::getenv(PDXKA_SOCKET_ENV))
+    opts.socket_path = socket_env;
+  if (parse_result.map.count("http"))
+    opts.http_endpoint = parse_result.map["http"].as<std::string>();
+  extract("workers", "--workers", opts.workers);
+  opts.batch = parse_result.map["batch"].as<bool>();
+  extract("flush-every", "--flush-every", opts.flush_every);
+  opts.watch = parse_result.map["watch"].as<bool>();
+  if (!extract_format(parse_result.map["format"].as<std::string>(), opts.format))
+    std::exit(EXIT_FAILURE);
+  if (parse_result.map.count("template"))
+    opts.output_template = parse_result.map["template"].as<std::string>();
+  return opts;
 #else
   cliopt_map opt_map;
   if (!parse_options(opt_map, argc, argv))
@@ -124,64 +319,680 @@ cliopts extract_args(int argc, char* argv[])
   }
   // extract variables from options map
   const auto one_line = (opt_map.find("one_line") != opt_map.end());
-  const auto [previous, previous_valid] = extract_previous(opt_map);
-  if (!previous_valid)
+  unsigned int previous = 0u;
+  unsigned int previous_last = 0u;
+  if (
+    const auto back_iter = opt_map.find("back");
+    back_iter != opt_map.end() &&
+    !extract_back(back_iter->second[0], previous, previous_last)
+  )
+    std::exit(EXIT_FAILURE);
+  const auto all = (opt_map.find("all") != opt_map.end());
+  const auto [random, random_valid] = extract_unsigned(
+    opt_map, "random", "--random", cliopts{}.random
+  );
+  if (
+    !random_valid ||
+    !check_selection(
+      opt_map.find("back") != opt_map.end(), all, opt_map.find("random") != opt_map.end()
+    ) ||
+    (opt_map.find("random") != opt_map.end() && !check_random(random))
+  )
+    std::exit(EXIT_FAILURE);
+  const auto seed_iter = opt_map.find("seed");
+  const auto fortune_iter = opt_map.find("fortune");
+  const auto [seed, seed_valid] = extract_unsigned(opt_map, "seed", "--seed", 0u);
+  if (!seed_valid)
     std::exit(EXIT_FAILURE);
   const auto verbose = (opt_map.find("verbose") != opt_map.end());
+  const auto curl_log_iter = opt_map.find("curl_log");
   const auto insecure = (opt_map.find("insecure") != opt_map.end());
+  const auto timing = (opt_map.find("timing") != opt_map.end());
+  const auto trace_iter = opt_map.find("trace");
+  const auto serve_iter = opt_map.find("serve");
+  const auto socket_iter = opt_map.find("socket");
+  const auto input_iter = opt_map.find("input");
+  const auto cache_iter = opt_map.find("cache");
+  const auto [cache_ttl, cache_ttl_valid] = extract_unsigned(
+    opt_map, "cache_ttl", "--cache-ttl", cliopts{}.cache_ttl
+  );
+  if (!cache_ttl_valid)
+    std::exit(EXIT_FAILURE);
+  const auto [refresh, refresh_valid] = extract_unsigned(
+    opt_map, "refresh", "--refresh", cliopts{}.refresh
+  );
+  if (!refresh_valid)
+    std::exit(EXIT_FAILURE);
+  const auto http_iter = opt_map.find("http");
+  const auto [workers, workers_valid] = extract_unsigned(
+    opt_map, "workers", "--workers", cliopts{}.workers
+  );
+  if (!workers_valid)
+    std::exit(EXIT_FAILURE);
+  const auto batch = (opt_map.find("batch") != opt_map.end());
+  const auto [flush_every, flush_every_valid] = extract_unsigned(
+    opt_map, "flush_every", "--flush-every", cliopts{}.flush_every
+  );
+  if (!flush_every_valid)
+    std::exit(EXIT_FAILURE);
+  const auto watch = (opt_map.find("watch") != opt_map.end());
+  auto format = cliopts{}.format;
+  if (
+    const auto format_iter = opt_map.find("format");
+    format_iter != opt_map.end() && !extract_format(format_iter->second[0], format)
+  )
+    std::exit(EXIT_FAILURE);
+  const auto template_iter = opt_map.find("template");
   // done, populate struct
-  return {one_line, previous, verbose, insecure};
+  cliopts opts;
+  opts.one_line = one_line;
+  opts.previous = previous;
+  opts.previous_last = previous_last;
+  opts.all = all;
+  opts.random = random;
+  if (seed_iter != opt_map.end())
+    opts.seed = seed;
+  if (fortune_iter != opt_map.end())
+    opts.fortune_dir = fortune_iter->second[0];
+  opts.verbose = verbose;
+  if (curl_log_iter != opt_map.end())
+    opts.curl_log_path = curl_log_iter->second[0];
+  opts.insecure = insecure;
+  opts.timing = timing;
+  if (trace_iter != opt_map.end())
+    opts.trace_path = trace_iter->second[0];
+  if (serve_iter != opt_map.end())
+    opts.serve_path = serve_iter->second[0];
+  opts.refresh = refresh;
+  if (socket_iter != opt_map.end())
+    opts.socket_path = socket_iter->second[0];
+  else if (auto socket_env = std::getenv(PDXKA_SOCKET_ENV))
+    opts.socket_path = socket_env;
+  if (input_iter != opt_map.end())
+    opts.input_path = input_iter->second[0];
+  if (cache_iter != opt_map.end())
+    opts.cache_path = cache_iter->second[0];
+  else if (auto cache_env = std::getenv(PDXKA_CACHE_ENV))
+    opts.cache_path = cache_env;
+  opts.cache_ttl = cache_ttl;
+  if (http_iter != opt_map.end())
+    opts.http_endpoint = http_iter->second[0];
+  opts.workers = workers;
+  opts.batch = batch;
+  opts.flush_every = flush_every;
+  opts.watch = watch;
+  opts.format = format;
+  if (template_iter != opt_map.end())
+    opts.output_template = template_iter->second[0];
+  return opts;
 #endif  // !PDXKA_USE_BOOST_PROGRAM_OPTIONS
 }
 
-}  // namespace
+/**
+ * Return a record writer for the output format or template.
+ *
+ * @param out Output buffer to write to
+ * @param opts Parsed command-line options
+ * @param tmpl Compiled `--template`, `nullptr` to use the output format
+ * @param format Output format to use if there is no template
+ */
+record_writer make_writer(
+  output_buffer& out,
+  const cliopts& opts,
+  const compiled_template* tmpl,
+  output_format format)
+{
+  if (tmpl)
+    return {out, *tmpl};
+  return {out, format, opts.one_line};
+}
 
-int program_main(
-  int argc,
-  char* argv[],
+/**
+ * Run the daemon, serving queries until interrupted.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @returns `EXIT_SUCCESS` on clean shutdown, `EXIT_FAILURE` on error
+ */
+int serve_main(
+  const cliopts& opts,
   const std::function<curl_result(const cliopts&)>& rss_factory)
 {
-  // parse and extract command-line arguments, printing error messages or
-  // information output and exiting appropriately as necessary
-  auto opts = extract_args(argc, argv);
-  // get XKCD RSS as a string using cURL. this may be an actual network call,
-  // e.g. using get_rss, or some mocked output (for testing)
-  auto res = rss_factory(opts);
-  // if request error, just print the reason and exit
-  PDXKA_CURL_NOT_OK(res.status) {
-    std::cerr << "cURL error " << res.status << ": " << res.reason << std::endl;
+#if PDXKA_WIN32
+  std::cerr << "Error: --serve is not supported on Windows" << std::endl;
+  return EXIT_FAILURE;
+#else
+  // zero interval would refresh continuously
+  if (!opts.refresh) {
+    std::cerr << "Error: --refresh must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+  server_options server_opts;
+  server_opts.socket_path = opts.serve_path;
+  server_opts.refresh_interval = std::chrono::seconds{opts.refresh};
+  // forward last modification time to provider for conditional requests
+  return serve(
+    server_opts,
+    [&opts, &rss_factory](std::time_t modified_since)
+    {
+      auto fetch_opts = opts;
+      fetch_opts.modified_since = modified_since;
+      return rss_factory(fetch_opts);
+    }
+  );
+#endif  // !PDXKA_WIN32
+}
+
+/**
+ * Run the HTTP/JSON server, serving requests until interrupted.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @returns `EXIT_SUCCESS` on clean shutdown, `EXIT_FAILURE` on error
+ */
+int http_main(
+  const cliopts& opts,
+  const std::function<curl_result(const cliopts&)>& rss_factory)
+{
+#if !PDXKA_LINUX
+  std::cerr << "Error: --http is only supported on Linux" << std::endl;
+  return EXIT_FAILURE;
+#else
+  if (!opts.refresh) {
+    std::cerr << "Error: --refresh must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (!opts.workers) {
+    std::cerr << "Error: --workers must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+  http_server_options server_opts;
+  try {
+    parse_endpoint(opts.http_endpoint, server_opts);
+  }
+  catch (const std::invalid_argument& ex) {
+    std::cerr << "Error: --http: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  server_opts.workers = opts.workers;
+  server_opts.refresh_interval = std::chrono::seconds{opts.refresh};
+  // forward last modification time to provider for conditional requests
+  return serve_http(
+    server_opts,
+    [&opts, &rss_factory](std::time_t modified_since)
+    {
+      auto fetch_opts = opts;
+      fetch_opts.modified_since = modified_since;
+      return rss_factory(fetch_opts);
+    }
+  );
+#endif  // PDXKA_LINUX
+}
+
+/**
+ * Watch the feed, printing each new comic as it appears until interrupted.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @param tmpl Compiled `--template`, `nullptr` to use the output format
+ * @returns `EXIT_SUCCESS` if watching stops, `EXIT_FAILURE` on error
+ */
+int watch_main(
+  const cliopts& opts,
+  const std::function<curl_result(const cliopts&)>& rss_factory,
+  const compiled_template* tmpl)
+{
+#if PDXKA_WIN32
+  std::cerr << "Error: --watch is not supported on Windows" << std::endl;
+  return EXIT_FAILURE;
+#else
+  auto out = stdout_buffer();
+  // the output never ends so a JSON array would never be closed
+  auto format = (opts.format == output_format::json) ? output_format::ndjson : opts.format;
+  auto writer = make_writer(out, opts, tmpl, format);
+  try {
+    // forward last modification time to provider for conditional requests
+    watch_feed(
+      [&opts, &rss_factory](std::time_t modified_since)
+      {
+        auto fetch_opts = opts;
+        fetch_opts.modified_since = modified_since;
+        return rss_factory(fetch_opts);
+      },
+      [&out, &writer](const rss_item& item)
+      {
+        // one write per new comic as it appears
+        writer.write(item);
+        out.flush();
+      }
+    );
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
     return EXIT_FAILURE;
   }
+  return EXIT_SUCCESS;
+#endif  // !PDXKA_WIN32
+}
+
+/**
+ * Parse RSS XML into items.
+ *
+ * Errors are printed to standard error.
+ *
+ * @param xml RSS XML to parse
+ * @param rss_items RSS items to populate
+ * @param timer Timer to record the parsing phases with
+ * @returns `EXIT_SUCCESS` if there is at least one item, nonzero on error
+ */
+int parse_items(std::string_view xml, rss_item_vector& rss_items, phase_timer& timer)
+{
   // try to get XKCD RSS as a vector of rss_items, throw on error
-  rss_item_vector rss_items;
   try {
-    rss_items = to_item_vector(parse_rss(res.payload));
+    auto tree = parse_rss(xml);
+    timer.mark("parse_rss");
+    rss_items = to_item_vector(tree);
+    timer.mark("to_item_vector");
   }
   catch (...) {
     std::cerr << boost::current_exception_diagnostic_information() << std::endl;
     return EXIT_FAILURE + 1;
   }
   // if empty, error out
-  const auto n_items = rss_items.size();
-  if (!n_items) {
+  if (rss_items.empty()) {
+    std::cerr << "Error: Couldn't find any one-liners in RSS feed!" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Fetch and parse the XKCD RSS feed.
+ *
+ * Errors are printed to standard error. When timing, libcurl global
+ * initialization is done up front so it is timed separately from the fetch.
+ * If there is an `--input` file it is parsed in place instead.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @param rss_items RSS items to populate
+ * @param timer Timer to record the fetch and parsing phases with
+ * @returns `EXIT_SUCCESS` if there is at least one item, nonzero on error
+ */
+int fetch_items(
+  const cliopts& opts,
+  const std::function<curl_result(const cliopts&)>& rss_factory,
+  rss_item_vector& rss_items,
+  phase_timer& timer)
+{
+  // --input is memory-mapped if possible and parsed without copying
+  if (opts.input_path.size()) {
+    std::optional<feed_input> input;
+    try {
+      input.emplace(opts.input_path);
+    }
+    catch (const std::runtime_error& ex) {
+      std::cerr << "Error: --input: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    timer.mark("read_input");
+    return parse_items(input->view(), rss_items, timer);
+  }
+  if (timer.enabled()) {
+    init_curl();
+    timer.mark("curl_global_init");
+  }
+  // get XKCD RSS as a string using cURL. this may be an actual network call,
+  // e.g. using get_rss, or some mocked output (for testing)
+  auto res = rss_factory(opts);
+  // remainder of the fetch is easy handle setup and cleanup, or mocking
+  add_curl_phases(timer, res.times);
+  timer.mark("fetch_other");
+  // if request error, just print the reason and exit
+  PDXKA_CURL_NOT_OK(res.status) {
+    std::cerr << "cURL error " << res.status << ": " << res.reason << std::endl;
+    return EXIT_FAILURE;
+  }
+  return parse_items(res.payload, rss_items, timer);
+}
+
+/**
+ * Get the XKCD RSS feed from the cheapest tier that can answer.
+ *
+ * The tiers are the `--cache` file, the `--socket` daemon, and finally the
+ * provider or `--input` file as read by `fetch_items`, which prints its own
+ * errors. A feed from a later tier is written to the cache file. An `--input`
+ * file is always read since it was asked for explicitly. Errors of earlier
+ * tiers are printed as warnings if a later tier answered. When timing, each
+ * tier's counters are also printed if there is more than one tier.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @param feed Feed to populate
+ * @param timer Timer to record phases with
+ * @returns `EXIT_SUCCESS` if there is at least one item, nonzero on error
+ */
+int fetch_feed(
+  const cliopts& opts,
+  const std::function<curl_result(const cliopts&)>& rss_factory,
+  feed_ptr& feed,
+  phase_timer& timer)
+{
+  provider_chain chain;
+  if (opts.input_path.empty()) {
+    if (opts.cache_path.size())
+      chain.add(
+        std::make_unique<cache_tier>(opts.cache_path, std::chrono::seconds{opts.cache_ttl})
+      );
+#if !PDXKA_WIN32
+    if (opts.socket_path.size())
+      chain.add(std::make_unique<daemon_tier>(opts.socket_path));
+#endif  // !PDXKA_WIN32
+  }
+  auto status = EXIT_SUCCESS;
+  chain.add(
+    std::make_unique<function_tier>(
+      opts.input_path.empty() ? "network" : "input",
+      [&opts, &rss_factory, &timer, &status]() -> feed_ptr
+      {
+        rss_item_vector rss_items;
+        if ((status = fetch_items(opts, rss_factory, rss_items, timer)))
+          return nullptr;
+        return std::make_shared<const feed_snapshot>(std::move(rss_items));
+      }
+    )
+  );
+  feed = chain.get();
+  // a single tier has nothing to compare
+  if (chain.size() > 1) {
+    timer.mark("tiers");
+    if (opts.timing)
+      chain.report(std::cerr);
+  }
+  // tier errors are only warnings if a later tier answered instead. the last
+  // tier prints its own errors
+  for (std::size_t i = 0; i < chain.size(); i++)
+    if (const auto& error = chain.stats(i).last_error; error.size())
+      std::cerr << (feed ? "Warning: " : "Error: ") << chain.tier(i).name() <<
+        " tier: " << error << std::endl;
+  if (!feed)
+    return status;
+  // check here too so an empty feed from any tier is an error
+  if (!feed->size()) {
     std::cerr << "Error: Couldn't find any one-liners in RSS feed!" << std::endl;
     return EXIT_FAILURE;
   }
-  // if previous is size or greater, too far back
-  if (opts.previous >= n_items) {
-    std::cerr << "Error: Can only go back at most " << n_items - 1 <<
-      " strips, not " << opts.previous << " strips" << std::endl;
+  return EXIT_SUCCESS;
+}
+
+/**
+ * Guard writing a timer's phases to standard error when it goes out of scope.
+ *
+ * This lets the breakdown be printed however `program_main` returns.
+ */
+class timing_report {
+public:
+  /**
+   * Ctor.
+   *
+   * @param timer Timer to report, which must outlive the guard
+   */
+  explicit timing_report(const phase_timer& timer) noexcept : timer_{timer} {}
+
+  /**
+   * Dtor.
+   *
+   * Writes the phases if the timer is enabled.
+   */
+  ~timing_report()
+  {
+    timer_.report(std::cerr);
+  }
+
+private:
+  const phase_timer& timer_;
+};
+
+/**
+ * Guard recording trace spans and writing them to a file on scope exit.
+ *
+ * Like `timing_report`, this lets the trace be written however `program_main`
+ * returns, including after a daemon mode is interrupted.
+ */
+class trace_file {
+public:
+  /**
+   * Ctor.
+   *
+   * Any previously recorded spans are discarded before tracing starts.
+   *
+   * @param path File to write the trace to, empty to not trace
+   */
+  explicit trace_file(const std::string& path) : path_{path}
+  {
+    if (path_.empty())
+      return;
+    try {
+      clear_trace();
+      start_tracing();
+    }
+    catch (const std::runtime_error& ex) {
+      std::cerr << "Error: --trace: " << ex.what() << std::endl;
+      failed_ = true;
+      path_.clear();
+    }
+  }
+
+  /**
+   * Return `true` if tracing could not be started.
+   */
+  bool failed() const noexcept { return failed_; }
+
+  /**
+   * Dtor.
+   *
+   * Stops tracing and writes the trace if tracing was started.
+   */
+  ~trace_file()
+  {
+    if (path_.empty())
+      return;
+    stop_tracing();
+    try {
+      write_trace(path_);
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Error: --trace: " << ex.what() << std::endl;
+    }
+  }
+
+private:
+  std::string path_;
+  bool failed_ = false;
+};
+
+/**
+ * Run the export command, exporting the feed as a fortune database.
+ *
+ * @param opts Parsed command-line options
+ * @param rss_factory Callable providing the RSS XML to parse
+ * @param timer Timer to record phases with
+ * @returns `EXIT_SUCCESS` on success, nonzero on error
+ */
+int export_main(
+  const cliopts& opts,
+  const std::function<curl_result(const cliopts&)>& rss_factory,
+  phase_timer& timer)
+{
+  if (opts.fortune_dir.empty()) {
+    std::cerr << "Error: export requires --fortune DIR" << std::endl;
+    return EXIT_FAILURE;
+  }
+  feed_ptr feed;
+  if (auto status = fetch_feed(opts, rss_factory, feed, timer))
+    return status;
+  try {
+    auto result = export_fortune(opts.fortune_dir, feed->items());
+    timer.mark("export");
+    std::cout << "Exported " << result.added << " new comics to " <<
+      opts.fortune_dir << " (" << result.total << " total)" << std::endl;
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int program_main(
+  int argc,
+  char* argv[],
+  const std::function<curl_result(const cliopts&)>& rss_factory)
+{
+  // start time is taken before option parsing so that it is timed too
+  const auto start = phase_timer::clock::now();
+  // export command, whose options follow the command name
+  if (argc > 1 && std::string_view{argv[1]} == "export") {
+    std::vector<char*> export_argv{argv[0]};
+    export_argv.insert(export_argv.end(), argv + 2, argv + argc);
+    export_argv.push_back(nullptr);
+    const auto opts = extract_args(argc - 1, export_argv.data());
+    phase_timer timer{opts.timing, start};
+    timing_report report{timer};
+    timer.mark("parse_options");
+    trace_file trace{opts.trace_path};
+    if (trace.failed())
+      return EXIT_FAILURE;
+    return export_main(opts, rss_factory, timer);
+  }
+  // parse and extract command-line arguments, printing error messages or
+  // information output and exiting appropriately as necessary
+  auto opts = extract_args(argc, argv);
+  // --timing breakdown, printed on return
+  phase_timer timer{opts.timing, start};
+  timing_report report{timer};
+  timer.mark("parse_options");
+  // --trace spans, written on return
+  trace_file trace{opts.trace_path};
+  if (trace.failed())
+    return EXIT_FAILURE;
+  if (opts.fortune_dir.size()) {
+    std::cerr << "Error: --fortune is only valid with export" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // compile the output template once up front
+  std::optional<compiled_template> tmpl;
+  if (opts.output_template.size()) {
+    if (opts.format != output_format::text) {
+      std::cerr << "Error: --template cannot be used with --format" << std::endl;
+      return EXIT_FAILURE;
+    }
+    try {
+      tmpl.emplace(opts.output_template);
+    }
+    catch (const std::invalid_argument& ex) {
+      std::cerr << "Error: --template: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    timer.mark("compile_template");
+  }
+  // --input replaces the provider, rereading the file only if it was modified
+  const rss_provider input_factory = [](const cliopts& fetch_opts)
+  {
+    return read_input(fetch_opts.input_path, fetch_opts.modified_since);
+  };
+  const auto& provider = opts.input_path.empty() ? rss_factory : input_factory;
+  // standard input can only be read once and batch queries are read from it
+  if (
+    opts.input_path == "-" &&
+    (opts.serve_path.size() || opts.http_endpoint.size() || opts.watch || opts.batch)
+  ) {
+    std::cerr << "Error: --input - cannot be used with --serve, --http, " <<
+      "--watch, or --batch" << std::endl;
+    return EXIT_FAILURE;
+  }
+  // if serving, run daemon until interrupted
+  if (opts.serve_path.size())
+    return serve_main(opts, provider);
+  if (opts.http_endpoint.size())
+    return http_main(opts, provider);
+  if (opts.watch)
+    return watch_main(opts, provider, tmpl ? &*tmpl : nullptr);
+  // batch mode: fetch and parse once, then answer all queries from stdin
+  if (opts.batch) {
+    // batch answers are lines of alt text, one per query
+    if (opts.format != output_format::text || tmpl) {
+      std::cerr << "Error: --format and --template are not supported with " <<
+        "--batch" << std::endl;
+      return EXIT_FAILURE;
+    }
+    feed_ptr feed;
+    if (auto status = fetch_feed(opts, provider, feed, timer))
+      return status;
+    auto out = stdout_buffer();
+    try {
+      run_batch(*feed, std::cin, out, opts.flush_every);
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Error: " << ex.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+    timer.mark("batch");
+    return EXIT_SUCCESS;
+  }
+  // get the RSS items from the cheapest tier, printing any errors
+  feed_ptr feed;
+  if (auto status = fetch_feed(opts, provider, feed, timer))
+    return status;
+  const auto& rss_items = feed->items();
+  const auto n_items = rss_items.size();
+  // indices of the selected items
+  std::vector<std::size_t> selected;
+  // random items, sampled without replacement
+  if (opts.random) {
+    if (opts.random > n_items) {
+      std::cerr << "Error: Can only choose at most " << n_items <<
+        " random strips, not " << opts.random << std::endl;
+      return EXIT_FAILURE;
+    }
+    xoshiro256ss rng{opts.seed ? *opts.seed : std::random_device{}()};
+    selected = sample_indices(rng, n_items, opts.random);
+  }
+  // all items or the selected range, where being too far back is an error
+  else {
+    std::size_t first = 0;
+    std::size_t last = n_items - 1;
+    if (!opts.all) {
+      if (opts.previous_last >= n_items) {
+        std::cerr << "Error: Can only go back at most " << n_items - 1 <<
+          " strips, not " << opts.previous_last << " strips" << std::endl;
+        return EXIT_FAILURE;
+      }
+      first = opts.previous;
+      last = opts.previous_last;
+    }
+    for (auto i = first; i <= last; i++)
+      selected.push_back(i);
+  }
+  // format selected items from the one fetched feed and emit them together
+  auto out = stdout_buffer();
+  auto writer = make_writer(out, opts, tmpl ? &*tmpl : nullptr, opts.format);
+  // writes can fail, e.g. if standard output is a full disk
+  try {
+    for (auto i : selected)
+      writer.write(rss_items[i]);
+    writer.finish();
+    // formatting includes selection and line wrapping
+    timer.mark("format");
+    out.flush();
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "Error: " << ex.what() << std::endl;
     return EXIT_FAILURE;
   }
-  // if printing as one line
-  const auto& item = rss_items[opts.previous];
-  if (opts.one_line)
-    std::cout << item.img_title() << " -- " << item.guid();
-  // else print fortune-style
-  else
-    std::cout << line_wrap(item.img_title()) << "\n\t\t-- " << item.guid();
-  // last newline + finally flush the buffer
-  std::cout << std::endl;
+  timer.mark("output");
   return EXIT_SUCCESS;
 }
 
@@ -37,15 +37,128 @@ option_parse_result parse_options(int argc, char* argv[])
   desc.add_options()
     (
       "back,b",
-      po::value<unsigned int>()->default_value(0)->implicit_value(1),
+      po::value<std::string>()->default_value("0")->implicit_value("1"),
       "Print alt text for bth previous XKCD strip. If not given a value, "
-      "implicitly sets b=1."
+      "implicitly sets b=1. A range A..B prints the Ath through Bth previous "
+      "strips from a single fetch."
+    )
+    (
+      "all",
+      po::bool_switch(),
+      "Print every strip in the feed from a single fetch."
+    )
+    (
+      "random",
+      po::value<std::string>()->implicit_value("1")->value_name("N"),
+      "Print N distinct strips chosen uniformly at random from the feed. If "
+      "not given a value, implicitly sets N=1."
+    )
+    (
+      "seed",
+      po::value<std::string>()->value_name("SEED"),
+      "Seed for --random so that the same strips are chosen."
     )
     (
       "one-line,o",
       po::bool_switch(),
       "Print alt text and attestation on one line."
     )
+    (
+      "format",
+      po::value<std::string>()->default_value("text")->value_name("FMT"),
+      "Print comics as text, a json array, ndjson objects, or csv or tsv with "
+      "a header row. Machine-readable formats include every feed field."
+    )
+    (
+      "template",
+      po::value<std::string>()->value_name("TMPL"),
+      "Print comics using TMPL, where %n, %t, %a, %l, %i, %d, and %g are the "
+      "number, title, alt text, link, image URL, date, and GUID, %% is a "
+      "literal %, and \\n, \\t, and \\\\ are escapes, e.g. '%n\\t%a\\n'."
+    )
+    (
+      "batch",
+      po::bool_switch(),
+      "Fetch the feed once then answer newline-delimited queries (latest, "
+      "back N, number N, search TEXT) read from stdin, writing one line per "
+      "query."
+    )
+    (
+      "flush-every",
+      po::value<std::string>()->default_value("0")->value_name("N"),
+      "Flush batch output every N answers. If 0, output is flushed when the "
+      "buffer fills."
+    )
+    (
+      "watch",
+      po::bool_switch(),
+      "Stay resident, printing each new comic's alt text as it appears. "
+      "Polling is dense around expected publication times learned from the "
+      "feed."
+    )
+  ;
+  // export command options group
+  po::options_description desc_export("Export options (" PDXKA_PROGNAME " export)");
+  desc_export.add_options()
+    (
+      "fortune",
+      po::value<std::string>()->value_name("DIR"),
+      "Append new comics to the fortune cookie file DIR/xkcd and rewrite its "
+      "strfile index DIR/xkcd.dat so fortune can pick comics directly."
+    )
+  ;
+  // daemon options group
+  po::options_description desc_daemon("Daemon options");
+  desc_daemon.add_options()
+    (
+      "input",
+      po::value<std::string>()->value_name("FILE"),
+      "Read the RSS feed from FILE instead of the network, or from stdin if "
+      "FILE is -. Files are memory-mapped and reread on refresh only if "
+      "modified."
+    )
+    (
+      "cache",
+      po::value<std::string>()->value_name("FILE"),
+      "Share the feed between runs through the cache file FILE, which is used "
+      "before the daemon or network while younger than --cache-ttl. Defaults "
+      "to the value of the " PDXKA_CACHE_ENV " environment variable."
+    )
+    (
+      "cache-ttl",
+      po::value<std::string>()->default_value("900")->value_name("SECS"),
+      "Seconds a cache file is used for."
+    )
+    (
+      "socket",
+      po::value<std::string>()->value_name("PATH"),
+      "Try the daemon at UNIX domain socket PATH before making a network "
+      "request. Defaults to the value of the " PDXKA_SOCKET_ENV " environment "
+      "variable."
+    )
+    (
+      "serve",
+      po::value<std::string>()->value_name("PATH"),
+      "Serve alt text queries from memory over a UNIX domain socket at PATH "
+      "until interrupted."
+    )
+    (
+      "http",
+      po::value<std::string>()->value_name("HOST:PORT"),
+      "Serve alt text queries from memory as JSON over HTTP at HOST:PORT "
+      "until interrupted. Linux only."
+    )
+    (
+      "workers",
+      po::value<std::string>()->default_value("1")->value_name("N"),
+      "Number of HTTP worker threads. Each has its own SO_REUSEPORT listening "
+      "socket."
+    )
+    (
+      "refresh",
+      po::value<std::string>()->default_value("900")->value_name("SECS"),
+      "Seconds between conditional feed refreshes when serving."
+    )
   ;
   // debug options group
   po::options_description desc_debug("Debug options");
@@ -56,12 +169,31 @@ option_parse_result parse_options(int argc, char* argv[])
       "Allow cURL to print what's going on to stderr. Useful for debugging "
       "or satisfying curiosity."
     )
+    (
+      "curl-log",
+      po::value<std::string>()->value_name("FILE"),
+      "Write cURL's debug output to FILE as JSON instead, with timestamped "
+      "text, header lines, and data and TLS byte counts."
+    )
     (
       "insecure,k",
       po::bool_switch(),
       "Allow cURL to skip verification of the server's SSL certificate. Try "
       "not to specify this."
     )
+    (
+      "timing",
+      po::bool_switch(),
+      "Print a breakdown of where time was spent to stderr, e.g. option "
+      "parsing, DNS, connect, TLS, first byte, transfer, parsing, formatting, "
+      "and output."
+    )
+    (
+      "trace",
+      po::value<std::string>()->value_name("FILE"),
+      "Write a Chrome trace of internal spans to FILE on exit for "
+      "chrome://tracing or the Perfetto UI."
+    )
   ;
   // "other" options group
   po::options_description desc_other("Other options");
@@ -69,8 +201,8 @@ option_parse_result parse_options(int argc, char* argv[])
     ("help,h", "Print this usage and exit")
     ("version,V", "Print version information and exit")
   ;
-  // add debug + other options to top-level options description
-  desc.add(desc_debug).add(desc_other);
+  // add export + daemon + debug + other options to top-level description
+  desc.add(desc_export).add(desc_daemon).add(desc_debug).add(desc_other);
   // variable map storing options + exit code main should return
   po::variables_map vm;
   int exit_code = EXIT_SUCCESS;
@@ -99,8 +231,77 @@ option_parse_result parse_options(int argc, char* argv[])
   return {exit_code, std::move(desc), std::move(vm)};
 }
 #else
+namespace {
+
+/**
+ * Enum class for the result of matching an option that requires a value.
+ */
+enum class value_match { none, ok, error };
+
+/**
+ * Match a long option that requires a value.
+ *
+ * Both the `--name VALUE` and `--name=VALUE` forms are accepted. On match the
+ * value is inserted under `key`, overwriting any previous value.
+ *
+ * @param opt_map Command-line option map to populate
+ * @param key Key to insert the option value under
+ * @param name Long option name including the leading `--`
+ * @param argc Argument count from `main()`
+ * @param argv Argument vector from `main()`
+ * @param i Index of the current argument, advanced past a separate value
+ * @returns `value_match::none` if not matched, `value_match::ok` if matched,
+ *  `value_match::error` if matched but the value is missing
+ */
+value_match match_value_option(
+  cliopt_map& opt_map,
+  const char* key,
+  std::string_view name,
+  int argc,
+  char* argv[],
+  int& i)
+{
+  using mapped_type = typename cliopt_map::mapped_type;
+  std::string_view arg{argv[i]};
+  // --name=VALUE
+  if (arg.size() > name.size() && arg.substr(0, name.size()) == name &&
+      arg[name.size()] == '=') {
+    opt_map.insert_or_assign(key, mapped_type{arg.substr(name.size() + 1).data()});
+    return value_match::ok;
+  }
+  if (arg != name)
+    return value_match::none;
+  // --name VALUE, where VALUE is required
+  if (i + 1 >= argc) {
+    std::cerr << "Error: " << name << " requires a value" << std::endl;
+    return value_match::error;
+  }
+  opt_map.insert_or_assign(key, mapped_type{argv[++i]});
+  return value_match::ok;
+}
+
+}  // namespace
+
 bool parse_options(cliopt_map& opt_map, int argc, char* argv[])
 {
+  // long options requiring a value as option map key + option name pairs
+  static constexpr std::pair<const char*, std::string_view> value_options[] = {
+    {"socket", "--socket"},
+    {"serve", "--serve"},
+    {"refresh", "--refresh"},
+    {"http", "--http"},
+    {"workers", "--workers"},
+    {"flush_every", "--flush-every"},
+    {"format", "--format"},
+    {"template", "--template"},
+    {"seed", "--seed"},
+    {"fortune", "--fortune"},
+    {"trace", "--trace"},
+    {"curl_log", "--curl-log"},
+    {"input", "--input"},
+    {"cache", "--cache"},
+    {"cache_ttl", "--cache-ttl"}
+  };
   using mapped_type = typename std::decay_t<decltype(opt_map)>::mapped_type;
   // loop through arguments
   for (int i = 1; i < argc; i++) {
@@ -118,9 +319,30 @@ bool parse_options(cliopt_map& opt_map, int argc, char* argv[])
     // run verbosely
     else if (arg == "-v" || arg == "--verbose")
       opt_map.try_emplace("verbose", mapped_type{});
+    // print per-phase latency breakdown
+    else if (arg == "--timing")
+      opt_map.try_emplace("timing", mapped_type{});
     // print alt text and attestation on one line
     else if (arg == "-o" || arg == "--one-line")
       opt_map.try_emplace("one_line", mapped_type{});
+    // answer queries read from stdin
+    else if (arg == "--batch")
+      opt_map.try_emplace("batch", mapped_type{});
+    // print new comics as they appear
+    else if (arg == "--watch")
+      opt_map.try_emplace("watch", mapped_type{});
+    // print every comic in the feed
+    else if (arg == "--all")
+      opt_map.try_emplace("all", mapped_type{});
+    // print random comics, where like -b the count is optional
+    else if (arg == "--random") {
+      if (i + 1 >= argc || (std::strlen(argv[i + 1]) && argv[i + 1][0] == '-'))
+        opt_map.insert_or_assign("random", mapped_type{"1"});
+      else
+        opt_map.insert_or_assign("random", mapped_type{argv[++i]});
+    }
+    else if (arg.substr(0, 9) == "--random=")
+      opt_map.insert_or_assign("random", mapped_type{arg.substr(9).data()});
     // option to print alt text for bth previous XKCD strip
     else if (arg == "-b" || arg == "--back") {
       // advance to find argument for number of strips, use 1 if none
@@ -145,10 +367,21 @@ bool parse_options(cliopt_map& opt_map, int argc, char* argv[])
     // number of strips to go back is appended, e.g. --back=2
     else if (arg.substr(0, 7) == "--back=")
       opt_map.insert_or_assign("back", mapped_type{arg.substr(7).data()});
-    // unknown option
+    // options requiring a value
     else {
-      std::cerr << "Error: unknown option " << arg << std::endl;
-      return false;
+      auto match = value_match::none;
+      for (auto [key, name] : value_options) {
+        match = match_value_option(opt_map, key, name, argc, argv, i);
+        if (match != value_match::none)
+          break;
+      }
+      if (match == value_match::error)
+        return false;
+      // unknown option
+      if (match == value_match::none) {
+        std::cerr << "Error: unknown option " << arg << std::endl;
+        return false;
+      }
     }
   }
   return true;
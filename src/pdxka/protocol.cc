@@ -0,0 +1,209 @@
+/**
+ * @file protocol.cc
+ * @author Derek Huang
+ * @brief C++ source for the xkcd-alt daemon line protocol
+ * @copyright MIT License
+ */
+
+#include "pdxka/protocol.hh"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "pdxka/query.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/snapshot.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Number of fields in an encoded RSS item.
+ */
+constexpr std::size_t n_item_fields = 7u;
+
+/**
+ * Append an escaped field value to a string.
+ *
+ * @param out String to append to
+ * @param value Field value to escape
+ */
+void append_escaped(std::string& out, std::string_view value)
+{
+  for (auto c : value) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+/**
+ * Return an unescaped field value.
+ *
+ * @param value Escaped field value
+ *
+ * @throws std::invalid_argument If `value` contains an invalid escape
+ */
+std::string unescape(std::string_view value)
+{
+  std::string out;
+  out.reserve(value.size());
+  for (std::size_t i = 0; i < value.size(); i++) {
+    if (value[i] != '\\') {
+      out += value[i];
+      continue;
+    }
+    // escape must be followed by another character
+    if (++i == value.size())
+      throw std::invalid_argument{"trailing backslash in item field"};
+    switch (value[i]) {
+      case '\\':
+        out += '\\';
+        break;
+      case 't':
+        out += '\t';
+        break;
+      case 'r':
+        out += '\r';
+        break;
+      case 'n':
+        out += '\n';
+        break;
+      default:
+        throw std::invalid_argument{
+          std::string{"invalid escape \\"} + value[i] + " in item field"
+        };
+    }
+  }
+  return out;
+}
+
+}  // namespace
+
+void encode_item(std::string& out, const rss_item& item)
+{
+  append_escaped(out, item.title());
+  out += '\t';
+  append_escaped(out, item.link());
+  out += '\t';
+  append_escaped(out, item.img_src());
+  out += '\t';
+  append_escaped(out, item.img_title());
+  out += '\t';
+  append_escaped(out, item.img_alt());
+  out += '\t';
+  append_escaped(out, item.pub_date());
+  out += '\t';
+  append_escaped(out, item.guid());
+  out += '\n';
+}
+
+rss_item decode_item(std::string_view line)
+{
+  // drop terminating newline if any
+  if (line.size() && line.back() == '\n')
+    line.remove_suffix(1);
+  // split into the tab-separated fields
+  std::array<std::string, n_item_fields> fields;
+  std::size_t n_fields = 0;
+  while (true) {
+    auto tab_pos = line.find('\t');
+    if (n_fields == n_item_fields)
+      throw std::invalid_argument{"too many item fields"};
+    fields[n_fields++] = unescape(line.substr(0, tab_pos));
+    if (tab_pos == std::string_view::npos)
+      break;
+    line.remove_prefix(tab_pos + 1);
+  }
+  if (n_fields != n_item_fields)
+    throw std::invalid_argument{
+      "expected " + std::to_string(n_item_fields) + " item fields, got " +
+      std::to_string(n_fields)
+    };
+  return {
+    std::move(fields[0]),
+    std::move(fields[1]),
+    std::move(fields[2]),
+    std::move(fields[3]),
+    std::move(fields[4]),
+    std::move(fields[5]),
+    std::move(fields[6])
+  };
+}
+
+std::string respond(const feed_snapshot& snapshot, std::string_view request)
+{
+  // parse query, responding with error message if malformed
+  query q;
+  try {
+    q = parse_query(request);
+  }
+  catch (const std::invalid_argument& ex) {
+    std::string response{"error "};
+    append_escaped(response, ex.what());
+    return response += '\n';
+  }
+  // write number of matching items + each item
+  auto selected = run_query(snapshot, q);
+  auto response = "ok " + std::to_string(selected.size()) + "\n";
+  for (auto item : selected)
+    encode_item(response, *item);
+  return response;
+}
+
+rss_item_vector decode_response(std::string_view response)
+{
+  // split off status line
+  auto line_end = response.find('\n');
+  if (line_end == std::string_view::npos)
+    throw std::invalid_argument{"incomplete response status line"};
+  auto status = response.substr(0, line_end);
+  response.remove_prefix(line_end + 1);
+  if (status.substr(0, 6) == "error ")
+    throw std::runtime_error{unescape(status.substr(6))};
+  if (status.substr(0, 3) != "ok ")
+    throw std::invalid_argument{"unknown response status"};
+  // number of items that follow
+  std::size_t n_items;
+  auto count = status.substr(3);
+  auto [end, err] = std::from_chars(
+    count.data(), count.data() + count.size(), n_items
+  );
+  if (err != std::errc{} || end != count.data() + count.size())
+    throw std::invalid_argument{"invalid response item count"};
+  // decode each item line
+  rss_item_vector items;
+  items.reserve(n_items);
+  for (std::size_t i = 0; i < n_items; i++) {
+    line_end = response.find('\n');
+    if (line_end == std::string_view::npos)
+      throw std::invalid_argument{"incomplete response item"};
+    items.push_back(decode_item(response.substr(0, line_end)));
+    response.remove_prefix(line_end + 1);
+  }
+  if (response.size())
+    throw std::invalid_argument{"trailing data after response items"};
+  return items;
+}
+
+}  // namespace pdxka
@@ -0,0 +1,180 @@
+/**
+ * @file provider_chain.cc
+ * @author Derek Huang
+ * @brief C++ source for getting the feed from the cheapest of several tiers
+ * @copyright MIT License
+ */
+
+#include "pdxka/provider_chain.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "pdxka/curl.hh"
+#include "pdxka/features.h"
+#include "pdxka/input.hh"
+#include "pdxka/protocol.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/trace.hh"
+
+#if !PDXKA_WIN32
+#include "pdxka/client.hh"
+#endif  // !PDXKA_WIN32
+
+namespace pdxka {
+
+feed_ptr memory_tier::get()
+{
+  std::lock_guard lock{mut_};
+  if (!feed_ || clock::now() - stored_ > max_age_)
+    return nullptr;
+  return feed_;
+}
+
+bool memory_tier::put(const feed_ptr& feed)
+{
+  std::lock_guard lock{mut_};
+  feed_ = feed;
+  stored_ = clock::now();
+  return true;
+}
+
+feed_ptr cache_tier::get()
+{
+  PDXKA_TRACE_SPAN("cache_get");
+  // a missing cache file is a miss, not an error
+  std::error_code ec;
+  if (!std::filesystem::is_regular_file(path_, ec))
+    return nullptr;
+  feed_input input{path_};
+  if (std::time(nullptr) - input.file_time() > max_age_.count())
+    return nullptr;
+  // an empty feed is never useful, so treat it like a missing file
+  auto items = decode_response(input.view());
+  if (items.empty())
+    return nullptr;
+  return std::make_shared<const feed_snapshot>(std::move(items));
+}
+
+bool cache_tier::put(const feed_ptr& feed)
+{
+  PDXKA_TRACE_SPAN("cache_put");
+  namespace fs = std::filesystem;
+  const fs::path path{path_};
+  if (path.has_parent_path())
+    fs::create_directories(path.parent_path());
+  // write a uniquely named file and rename it over the cache file
+  std::error_code ec;
+  auto temp_path = path;
+  temp_path += ".tmp" + std::to_string(std::random_device{}());
+  {
+    std::ofstream out{temp_path, std::ios::binary | std::ios::trunc};
+    if (!(out << respond(*feed, "all")) || !out.flush()) {
+      out.close();
+      fs::remove(temp_path, ec);
+      throw std::runtime_error{"error writing " + temp_path.string()};
+    }
+  }
+  fs::rename(temp_path, path, ec);
+  if (ec) {
+    auto message = "rename " + path_ + ": " + ec.message();
+    fs::remove(temp_path, ec);
+    throw std::runtime_error{message};
+  }
+  return true;
+}
+
+#if !PDXKA_WIN32
+feed_ptr daemon_tier::get()
+{
+  rss_item_vector items;
+  if (!query_daemon(socket_path_, "all", items, timeout_) || items.empty())
+    return nullptr;
+  return std::make_shared<const feed_snapshot>(std::move(items));
+}
+#endif  // !PDXKA_WIN32
+
+feed_ptr fetch_tier::get()
+{
+  auto res = fetch_();
+  PDXKA_CURL_NOT_OK(res.status) {
+    throw std::runtime_error{
+      "cURL error " + std::to_string(res.status) + ": " + res.reason
+    };
+  }
+  auto items = to_item_vector(parse_rss(res.payload));
+  if (items.empty())
+    throw std::runtime_error{"Couldn't find any one-liners in RSS feed"};
+  return std::make_shared<const feed_snapshot>(
+    std::move(items), (res.file_time > 0) ? static_cast<std::time_t>(res.file_time) : 0
+  );
+}
+
+provider_chain& provider_chain::add(std::unique_ptr<feed_tier> tier)
+{
+  tiers_.push_back({std::move(tier), {}});
+  return *this;
+}
+
+feed_ptr provider_chain::get()
+{
+  for (std::size_t i = 0; i < tiers_.size(); i++) {
+    auto& [tier, stats] = tiers_[i];
+    feed_ptr feed;
+    try {
+      feed = tier->get();
+    }
+    catch (const std::exception& ex) {
+      stats.errors++;
+      stats.last_error = ex.what();
+      continue;
+    }
+    if (!feed) {
+      stats.misses++;
+      continue;
+    }
+    stats.hits++;
+    // promotion is best effort since the feed was already answered
+    for (std::size_t j = 0; j < i; j++) {
+      try {
+        if (tiers_[j].tier->put(feed))
+          tiers_[j].stats.promotions++;
+      }
+      catch (const std::exception& ex) {
+        tiers_[j].stats.errors++;
+        tiers_[j].stats.last_error = ex.what();
+      }
+    }
+    return feed;
+  }
+  return nullptr;
+}
+
+void provider_chain::report(std::ostream& out) const
+{
+  auto flags = out.flags();
+  out << "Tiers:\n";
+  for (const auto& [tier, stats] : tiers_)
+    out << "  " << std::left << std::setw(18) << tier->name() << std::right <<
+      std::setw(4) << stats.hits << " hits" << std::setw(4) << stats.misses <<
+      " misses" << std::setw(4) << stats.errors << " errors" <<
+      std::setw(4) << stats.promotions << " promotions\n";
+  out << std::flush;
+  out.flags(flags);
+}
+
+}  // namespace pdxka
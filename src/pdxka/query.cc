@@ -0,0 +1,151 @@
+/**
+ * @file query.cc
+ * @author Derek Huang
+ * @brief C++ source for XKCD RSS item queries
+ * @copyright MIT License
+ */
+
+#include "pdxka/query.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Return view with leading and trailing whitespace removed.
+ *
+ * @param text Text to trim
+ */
+std::string_view trim(std::string_view text) noexcept
+{
+  while (text.size() && std::isspace(static_cast<unsigned char>(text.front())))
+    text.remove_prefix(1);
+  while (text.size() && std::isspace(static_cast<unsigned char>(text.back())))
+    text.remove_suffix(1);
+  return text;
+}
+
+/**
+ * Parse the non-negative integral argument of a query.
+ *
+ * @param arg Query argument text
+ * @param name Query name used in error messages
+ *
+ * @throws std::invalid_argument If `arg` is not a valid unsigned integer
+ */
+unsigned int parse_query_value(std::string_view arg, std::string_view name)
+{
+  unsigned int value;
+  auto [end, err] = std::from_chars(arg.data(), arg.data() + arg.size(), value);
+  if (err != std::errc{} || end != arg.data() + arg.size())
+    throw std::invalid_argument{
+      std::string{name} + " requires a non-negative integer, got \"" +
+      std::string{arg} + "\""
+    };
+  return value;
+}
+
+/**
+ * Return `true` if `text` contains `needle` ignoring ASCII case.
+ *
+ * @param text Text to search in
+ * @param needle Text to search for
+ */
+bool icontains(std::string_view text, std::string_view needle) noexcept
+{
+  return std::search(
+    text.begin(),
+    text.end(),
+    needle.begin(),
+    needle.end(),
+    [](char a, char b)
+    {
+      return std::tolower(static_cast<unsigned char>(a)) ==
+        std::tolower(static_cast<unsigned char>(b));
+    }
+  ) != text.end();
+}
+
+}  // namespace
+
+query parse_query(std::string_view line)
+{
+  line = trim(line);
+  // split into query name and argument on first whitespace
+  auto name_end = std::find_if(
+    line.begin(),
+    line.end(),
+    [](char c) { return std::isspace(static_cast<unsigned char>(c)); }
+  );
+  auto name = line.substr(0, name_end - line.begin());
+  auto arg = trim(line.substr(name.size()));
+  // dispatch on query name
+  if (name == "latest") {
+    if (arg.size())
+      throw std::invalid_argument{"latest takes no argument"};
+    return {query_type::latest, 0u, {}};
+  }
+  if (name == "back")
+    return {query_type::back, parse_query_value(arg, name), {}};
+  if (name == "number")
+    return {query_type::number, parse_query_value(arg, name), {}};
+  if (name == "search") {
+    if (arg.empty())
+      throw std::invalid_argument{"search requires search text"};
+    return {query_type::search, 0u, std::string{arg}};
+  }
+  if (name == "all") {
+    if (arg.size())
+      throw std::invalid_argument{"all takes no argument"};
+    return {query_type::all, 0u, {}};
+  }
+  throw std::invalid_argument{"unknown query \"" + std::string{name} + "\""};
+}
+
+std::vector<const rss_item*> run_query(
+  const rss_item_vector& items, const query& q)
+{
+  std::vector<const rss_item*> selected;
+  switch (q.type) {
+    case query_type::latest:
+      if (items.size())
+        selected.push_back(&items.front());
+      break;
+    case query_type::back:
+      if (q.value < items.size())
+        selected.push_back(&items[q.value]);
+      break;
+    case query_type::number:
+      for (const auto& item : items) {
+        if (comic_number(item) == q.value) {
+          selected.push_back(&item);
+          break;
+        }
+      }
+      break;
+    case query_type::search:
+      for (const auto& item : items) {
+        if (icontains(item.title(), q.text) || icontains(item.img_alt(), q.text))
+          selected.push_back(&item);
+      }
+      break;
+    case query_type::all:
+      for (const auto& item : items)
+        selected.push_back(&item);
+      break;
+  }
+  return selected;
+}
+
+}  // namespace pdxka
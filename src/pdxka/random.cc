@@ -0,0 +1,53 @@
+/**
+ * @file random.cc
+ * @author Derek Huang
+ * @brief C++ source for seedable random comic selection
+ * @copyright MIT License
+ */
+
+#include "pdxka/random.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace pdxka {
+
+std::vector<std::size_t> sample_indices(
+  xoshiro256ss& rng, std::size_t population, std::size_t count)
+{
+  if (count > population)
+    throw std::invalid_argument{
+      "cannot sample " + std::to_string(count) + " of " +
+      std::to_string(population) + " items without replacement"
+    };
+  if (population > std::numeric_limits<std::uint32_t>::max())
+    throw std::invalid_argument{"population too large to sample"};
+  // Floyd's algorithm: for each j in [population - count, population), draw
+  // t from [0, j] and take t unless already taken, in which case take j
+  std::vector<std::size_t> indices;
+  indices.reserve(count);
+  std::unordered_set<std::size_t> taken;
+  taken.reserve(count);
+  for (auto j = population - count; j < population; j++) {
+    std::size_t t = uniform_below(rng, static_cast<std::uint32_t>(j + 1));
+    if (!taken.insert(t).second) {
+      taken.insert(j);
+      t = j;
+    }
+    indices.push_back(t);
+  }
+  // Floyd's algorithm gives a uniform set but not a uniform order
+  for (auto i = indices.size(); i > 1; i--)
+    std::swap(
+      indices[i - 1], indices[uniform_below(rng, static_cast<std::uint32_t>(i))]
+    );
+  return indices;
+}
+
+}  // namespace pdxka
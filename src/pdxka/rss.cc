@@ -12,10 +12,12 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 #include <boost/property_tree/ptree.hpp>
 
 #include "pdxka/common.h"
+#include "pdxka/trace.hh"
 
 namespace pdxka {
 
@@ -50,15 +52,37 @@ rss_item* rss_item::from_tree(
  */
 rss_item_vector to_item_vector(const boost::property_tree::ptree& rss_tree)
 {
+  PDXKA_TRACE_SPAN("to_item_vector");
   // RSS <item> groups subtree under rss.channel (can throw)
   const auto& rss_items_tree = rss_tree.get_child("rss.channel");
   // RSS item vector + populate with only the <item> items
   rss_item_vector rss_items;
   for (const auto& item : rss_items_tree) {
-    if (item.first == "item")
+    if (item.first == "item") {
+      PDXKA_TRACE_SPAN_ARG("decode_item", rss_items.size());
       rss_items.emplace_back(item.second);
+    }
   }
   return rss_items;
 }
 
+unsigned int comic_number(const rss_item& item) noexcept
+{
+  std::string_view link{item.link()};
+  // drop trailing slash(es), e.g. https://xkcd.com/2941/
+  while (link.size() && link.back() == '/')
+    link.remove_suffix(1);
+  // accumulate trailing digits from the back
+  unsigned int number = 0;
+  unsigned int scale = 1;
+  for (; link.size() && link.back() >= '0' && link.back() <= '9'; scale *= 10) {
+    number += scale * static_cast<unsigned int>(link.back() - '0');
+    link.remove_suffix(1);
+  }
+  // digits must be an entire path component
+  if (!link.size() || link.back() != '/')
+    return 0;
+  return number;
+}
+
 }  // namespace pdxka
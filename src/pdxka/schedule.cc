@@ -0,0 +1,336 @@
+/**
+ * @file schedule.cc
+ * @author Derek Huang
+ * @brief C++ source for schedule-aware polling of the XKCD RSS feed
+ * @copyright MIT License
+ */
+
+#include "pdxka/schedule.hh"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Return the number of days since 1970-01-01 for a proleptic Gregorian date.
+ *
+ * This is Howard Hinnant's `days_from_civil` and avoids `timegm`, which is
+ * not available on all platforms.
+ *
+ * @param y Year
+ * @param m Month in [1, 12]
+ * @param d Day of month in [1, 31]
+ */
+constexpr std::time_t days_from_civil(long y, unsigned m, unsigned d) noexcept
+{
+  y -= m <= 2;
+  const long era = (y >= 0 ? y : y - 399) / 400;
+  const auto yoe = static_cast<unsigned>(y - era * 400);
+  const auto doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+  const auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+/**
+ * Minimal cursor over RFC 822 date text.
+ */
+class date_reader {
+public:
+  explicit date_reader(std::string_view text) noexcept : text_{text} {}
+
+  /**
+   * Skip any spaces.
+   */
+  void skip_spaces() noexcept
+  {
+    while (pos_ < text_.size() && text_[pos_] == ' ')
+      pos_++;
+  }
+
+  /**
+   * Read an unsigned decimal of `min_digits` to `max_digits` digits.
+   */
+  unsigned number(unsigned min_digits, unsigned max_digits)
+  {
+    unsigned value = 0;
+    unsigned n_digits = 0;
+    for (; pos_ < text_.size() && n_digits < max_digits; pos_++, n_digits++) {
+      if (!std::isdigit(static_cast<unsigned char>(text_[pos_])))
+        break;
+      value = 10 * value + static_cast<unsigned>(text_[pos_] - '0');
+    }
+    if (n_digits < min_digits)
+      fail("expected number");
+    return value;
+  }
+
+  /**
+   * Read a run of letters.
+   */
+  std::string_view word()
+  {
+    auto start = pos_;
+    while (pos_ < text_.size() && std::isalpha(static_cast<unsigned char>(text_[pos_])))
+      pos_++;
+    if (pos_ == start)
+      fail("expected word");
+    return text_.substr(start, pos_ - start);
+  }
+
+  /**
+   * Consume `c` if it is next, returning `true` if consumed.
+   */
+  bool accept(char c) noexcept
+  {
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Require `c` to be next.
+   */
+  void expect(char c)
+  {
+    if (!accept(c))
+      fail(std::string{"expected '"} + c + "'");
+  }
+
+  /**
+   * Return `true` if all text has been read.
+   */
+  bool done() const noexcept { return pos_ == text_.size(); }
+
+  /**
+   * Return `true` if the next character is a digit.
+   */
+  bool at_digit() const noexcept
+  {
+    return pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]));
+  }
+
+  [[noreturn]] void fail(const std::string& what) const
+  {
+    throw std::invalid_argument{
+      "invalid RFC 822 date \"" + std::string{text_} + "\": " + what
+    };
+  }
+
+private:
+  std::string_view text_;
+  std::size_t pos_ = 0;
+};
+
+/**
+ * Month abbreviations in RFC 822 order.
+ */
+constexpr std::array<std::string_view, 12> month_names{
+  "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+  "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+/**
+ * Seconds from 1970-01-01, a Thursday, back to the preceding Monday.
+ */
+constexpr std::time_t epoch_weekday_offset = 3 * 86400;
+
+/**
+ * Return the time of the week of a UNIX time as seconds since Monday 00:00.
+ *
+ * @param time UNIX time
+ */
+constexpr std::time_t time_of_week(std::time_t time) noexcept
+{
+  auto offset = (time + epoch_weekday_offset) % publish_schedule::week;
+  return (offset < 0) ? offset + publish_schedule::week : offset;
+}
+
+}  // namespace
+
+std::time_t parse_rfc822_date(std::string_view date)
+{
+  date_reader reader{date};
+  reader.skip_spaces();
+  // optional day of week
+  if (!reader.at_digit()) {
+    reader.word();
+    reader.expect(',');
+    reader.skip_spaces();
+  }
+  auto day = reader.number(1, 2);
+  reader.skip_spaces();
+  auto month_name = reader.word();
+  auto month = std::find(month_names.begin(), month_names.end(), month_name);
+  if (month == month_names.end())
+    reader.fail("unknown month");
+  reader.skip_spaces();
+  auto year = reader.number(2, 4);
+  // RFC 822 two-digit years, interpreted as in RFC 2822 section 4.3
+  if (year < 50)
+    year += 2000;
+  else if (year < 1000)
+    year += 1900;
+  reader.skip_spaces();
+  auto hour = reader.number(2, 2);
+  reader.expect(':');
+  auto minute = reader.number(2, 2);
+  unsigned second = 0;
+  if (reader.accept(':'))
+    second = reader.number(2, 2);
+  reader.skip_spaces();
+  // zone, where a numeric offset is the local time minus UTC
+  long zone_offset = 0;
+  auto negative = reader.accept('-');
+  if (negative || reader.accept('+')) {
+    auto hhmm = reader.number(4, 4);
+    zone_offset = static_cast<long>((hhmm / 100) * 3600 + (hhmm % 100) * 60);
+    if (negative)
+      zone_offset = -zone_offset;
+  }
+  else {
+    auto zone = reader.word();
+    if (zone != "GMT" && zone != "UT" && zone != "UTC" && zone != "Z")
+      reader.fail("unsupported zone");
+  }
+  reader.skip_spaces();
+  if (!reader.done())
+    reader.fail("trailing text");
+  if (!day || day > 31 || hour > 23 || minute > 59 || second > 60)
+    reader.fail("field out of range");
+  auto days = days_from_civil(
+    static_cast<long>(year),
+    static_cast<unsigned>(month - month_names.begin() + 1),
+    day
+  );
+  return days * 86400 + hour * 3600 + minute * 60 + second - zone_offset;
+}
+
+publish_schedule::publish_schedule(std::vector<std::time_t> slots)
+  : slots_{std::move(slots)}
+{
+  if (slots_.empty())
+    throw std::invalid_argument{"publish schedule must have at least one slot"};
+  for (auto& slot : slots_) {
+    slot %= week;
+    if (slot < 0)
+      slot += week;
+  }
+  std::sort(slots_.begin(), slots_.end());
+  slots_.erase(std::unique(slots_.begin(), slots_.end()), slots_.end());
+}
+
+publish_schedule publish_schedule::xkcd_default()
+{
+  // Monday, Wednesday, Friday at 04:00 UTC
+  return publish_schedule{{4 * 3600, 2 * 86400 + 4 * 3600, 4 * 86400 + 4 * 3600}};
+}
+
+publish_schedule publish_schedule::learn(const rss_item_vector& items)
+{
+  std::vector<std::time_t> times;
+  for (const auto& item : items) {
+    try {
+      times.push_back(time_of_week(parse_rfc822_date(item.pub_date())));
+    }
+    // items with missing or malformed dates just don't contribute
+    catch (const std::invalid_argument&) {}
+  }
+  if (times.empty())
+    return xkcd_default();
+  // cluster publication times within an hour, keeping the earliest of each
+  // cluster so polling is dense from the earliest time a comic has appeared
+  std::sort(times.begin(), times.end());
+  std::vector<std::time_t> slots;
+  for (auto time : times)
+    if (slots.empty() || time - slots.back() > 3600)
+      slots.push_back(time);
+  // clusters can also wrap around from Sunday night to Monday morning
+  if (slots.size() > 1 && slots.front() + week - slots.back() <= 3600)
+    slots.pop_back();
+  return publish_schedule{std::move(slots)};
+}
+
+std::time_t publish_schedule::next_slot(std::time_t time) const noexcept
+{
+  auto week_start = time - time_of_week(time);
+  auto offset = time - week_start;
+  auto it = std::lower_bound(slots_.begin(), slots_.end(), offset);
+  if (it != slots_.end())
+    return week_start + *it;
+  return week_start + week + slots_.front();
+}
+
+poll_planner::poll_planner(publish_schedule schedule, poll_policy policy)
+  : schedule_{std::move(schedule)},
+    policy_{policy},
+    backoff_{policy_.min_backoff},
+    satisfied_until_{}
+{}
+
+std::time_t poll_planner::current_slot(std::time_t now) const noexcept
+{
+  // first slot whose window end is strictly after now
+  return schedule_.next_slot(now - policy_.window_after.count() + 1);
+}
+
+bool poll_planner::in_open_window(std::time_t now) const noexcept
+{
+  auto slot = current_slot(now);
+  return now >= slot - policy_.window_before.count() &&
+    satisfied_until_ < slot + policy_.window_after.count();
+}
+
+std::chrono::seconds poll_planner::next_delay(std::time_t now) const
+{
+  if (in_open_window(now))
+    return policy_.dense_interval;
+  // next window to open, skipping the current one if already satisfied
+  auto slot = current_slot(now);
+  if (now >= slot - policy_.window_before.count())
+    slot = schedule_.next_slot(slot + policy_.window_after.count());
+  std::chrono::seconds until_window{slot - policy_.window_before.count() - now};
+  return std::max(std::chrono::seconds{1}, std::min(backoff_, until_window));
+}
+
+void poll_planner::record(std::time_t now, bool changed)
+{
+  if (in_open_window(now)) {
+    // new comic for this slot so stop polling densely until the next one
+    if (changed)
+      satisfied_until_ = current_slot(now) + policy_.window_after.count();
+    backoff_ = policy_.min_backoff;
+  }
+  else if (changed)
+    backoff_ = policy_.min_backoff;
+  else
+    backoff_ = std::min(2 * backoff_, policy_.max_backoff);
+}
+
+void poll_planner::seen(std::time_t published) noexcept
+{
+  auto slot = current_slot(published);
+  if (published >= slot - policy_.window_before.count())
+    satisfied_until_ = std::max(satisfied_until_, slot + policy_.window_after.count());
+}
+
+void poll_planner::reschedule(publish_schedule schedule)
+{
+  schedule_ = std::move(schedule);
+}
+
+}  // namespace pdxka
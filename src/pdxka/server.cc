@@ -0,0 +1,482 @@
+/**
+ * @file server.cc
+ * @author Derek Huang
+ * @brief C++ source for the xkcd-alt UNIX domain socket daemon
+ * @copyright MIT License
+ */
+
+#include "pdxka/server.hh"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "pdxka/curl.hh"
+#include "pdxka/protocol.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/trace.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Maximum number of buffered request bytes without a newline per client.
+ *
+ * A client exceeding this is sending garbage and is disconnected.
+ */
+constexpr std::size_t max_request_size = 4096u;
+
+/**
+ * Time to stop accepting clients for after running out of descriptors.
+ */
+constexpr std::chrono::milliseconds accept_backoff{100};
+
+/**
+ * `send` flags. Broken pipes should be reported as `EPIPE`, not `SIGPIPE`.
+ */
+#ifdef MSG_NOSIGNAL
+constexpr int send_flags = MSG_NOSIGNAL;
+#else
+constexpr int send_flags = 0;
+#endif  // !MSG_NOSIGNAL
+
+/**
+ * Return a `std::runtime_error` describing the last `errno` value.
+ *
+ * @param what Description of the operation that failed
+ */
+auto errno_error(const std::string& what)
+{
+  return std::runtime_error{what + ": " + std::strerror(errno)};
+}
+
+/**
+ * Set a file descriptor to non-blocking, close-on-exec mode.
+ *
+ * @param fd File descriptor
+ * @returns `true` on success, `false` on error with `errno` set
+ */
+bool set_nonblocking(int fd) noexcept
+{
+  auto flags = fcntl(fd, F_GETFL);
+  if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    return false;
+  return fcntl(fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+/**
+ * Return a UNIX domain socket address for a path.
+ *
+ * @param path Socket path
+ *
+ * @throws std::runtime_error If the path is too long
+ */
+sockaddr_un make_address(const std::string& path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof addr.sun_path)
+    throw std::runtime_error{"socket path too long: " + path};
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  return addr;
+}
+
+/**
+ * Remove a stale socket file left behind by a daemon that did not clean up.
+ *
+ * @param addr Socket address
+ *
+ * @throws std::runtime_error If the path is in use by a live daemon or is
+ *  something other than a socket
+ */
+void remove_stale_socket(const sockaddr_un& addr)
+{
+  struct stat info;
+  if (lstat(addr.sun_path, &info) < 0)
+    return;
+  if (!S_ISSOCK(info.st_mode))
+    throw std::runtime_error{
+      std::string{addr.sun_path} + " exists and is not a socket"
+    };
+  // if we can connect then there is a live daemon already
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    throw errno_error("socket");
+  auto live = !connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr);
+  close(fd);
+  if (live)
+    throw std::runtime_error{
+      std::string{addr.sun_path} + " is in use by another daemon"
+    };
+  unlink(addr.sun_path);
+}
+
+/**
+ * Return a non-blocking listening UNIX domain socket bound to a path.
+ *
+ * @param path Socket path
+ *
+ * @throws std::runtime_error On error
+ */
+int make_listener(const std::string& path)
+{
+  auto addr = make_address(path);
+  remove_stale_socket(addr);
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    throw errno_error("socket");
+  if (
+    !set_nonblocking(fd) ||
+    bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) < 0 ||
+    listen(fd, SOMAXCONN) < 0
+  ) {
+    auto ex = errno_error("cannot listen on " + path);
+    close(fd);
+    throw ex;
+  }
+  return fd;
+}
+
+/**
+ * Connected client state.
+ *
+ * @param fd Client socket
+ * @param in Received bytes not yet forming a complete request line
+ * @param out Response bytes not yet sent
+ * @param closing `true` if the client finished sending requests
+ */
+struct client_state {
+  int fd;
+  std::string in;
+  std::string out;
+  bool closing = false;
+};
+
+/**
+ * Read available request bytes and append responses for complete lines.
+ *
+ * @param client Client to read from
+ * @param snapshot Feed snapshot to answer from
+ * @returns `false` if the client should be disconnected
+ */
+bool read_requests(client_state& client, const feed_snapshot& snapshot)
+{
+  char buf[4096];
+  while (true) {
+    auto n_read = recv(client.fd, buf, sizeof buf, 0);
+    if (n_read > 0) {
+      client.in.append(buf, static_cast<std::size_t>(n_read));
+      continue;
+    }
+    // orderly shutdown, finish sending responses
+    if (!n_read) {
+      client.closing = true;
+      break;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      break;
+    if (errno != EINTR)
+      return false;
+  }
+  // answer each complete line
+  std::size_t begin = 0;
+  for (
+    auto end = client.in.find('\n');
+    end != std::string::npos;
+    begin = end + 1, end = client.in.find('\n', begin)
+  ) {
+    PDXKA_TRACE_SPAN("unix_request");
+    client.out += respond(
+      snapshot, std::string_view{client.in}.substr(begin, end - begin)
+    );
+  }
+  client.in.erase(0, begin);
+  // a final line without newline is a request if the client is done sending
+  if (client.closing && client.in.size()) {
+    PDXKA_TRACE_SPAN("unix_request");
+    client.out += respond(snapshot, client.in);
+    client.in.clear();
+  }
+  return client.in.size() <= max_request_size;
+}
+
+/**
+ * Send as much of the pending response bytes as possible.
+ *
+ * @param client Client to write to
+ * @returns `false` if the client should be disconnected
+ */
+bool write_responses(client_state& client)
+{
+  std::size_t n_sent = 0;
+  while (n_sent < client.out.size()) {
+    auto n = send(
+      client.fd,
+      client.out.data() + n_sent,
+      client.out.size() - n_sent,
+      send_flags
+    );
+    if (n >= 0) {
+      n_sent += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      break;
+    if (errno != EINTR)
+      return false;
+  }
+  client.out.erase(0, n_sent);
+  // done if client finished sending and got all its responses
+  return !(client.closing && client.out.empty());
+}
+
+/**
+ * Server stopped by the signal handler.
+ */
+std::atomic<unix_server*> signal_server{nullptr};
+
+/**
+ * Signal handler that stops the `signal_server`.
+ */
+extern "C" void stop_signal_server(int /*signum*/)
+{
+  if (auto server = signal_server.load())
+    server->stop();
+}
+
+}  // namespace
+
+bool refresh_feed(
+  const feed_fetcher& fetcher, std::time_t& modified, rss_item_vector& items)
+{
+  auto res = fetcher(modified);
+  PDXKA_CURL_NOT_OK(res.status)
+    throw std::runtime_error{
+      "cURL error " + std::to_string(res.status) + ": " + res.reason
+    };
+  if (res.not_modified())
+    return false;
+  // parse before replacing so a bad feed leaves the current items intact
+  auto new_items = to_item_vector(parse_rss(res.payload));
+  if (new_items.empty())
+    throw std::runtime_error{"no items in RSS feed"};
+  items = std::move(new_items);
+  // prefer server's document time, falling back to fetch time
+  modified = (res.file_time >= 0) ?
+    static_cast<std::time_t>(res.file_time) : std::time(nullptr);
+  return true;
+}
+
+unix_server::unix_server(server_options options, feed_fetcher fetcher)
+  : options_{std::move(options)}, fetcher_{std::move(fetcher)}, modified_{}
+{
+  if (pipe(wakeup_fds_) < 0)
+    throw errno_error("pipe");
+  set_nonblocking(wakeup_fds_[0]);
+  set_nonblocking(wakeup_fds_[1]);
+}
+
+unix_server::~unix_server()
+{
+  close(wakeup_fds_[0]);
+  close(wakeup_fds_[1]);
+}
+
+void unix_server::stop() noexcept
+{
+  char byte = 0;
+  // if the pipe is full a wakeup is already pending anyways
+  [[maybe_unused]] auto n = write(wakeup_fds_[1], &byte, 1);
+}
+
+bool unix_server::refresh()
+{
+  rss_item_vector items;
+  if (!refresh_feed(fetcher_, modified_, items))
+    return false;
+  snapshot_.publish(std::make_shared<const feed_snapshot>(std::move(items), modified_));
+  return true;
+}
+
+void unix_server::refresh_loop()
+{
+  pollfd wakeup{wakeup_fds_[0], POLLIN, 0};
+  auto timeout = static_cast<int>(
+    std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::min(options_.refresh_interval, std::chrono::seconds{86400})
+    ).count()
+  );
+  while (true) {
+    auto n_ready = poll(&wakeup, 1, timeout);
+    if (n_ready < 0 && errno == EINTR)
+      continue;
+    if (n_ready)
+      break;
+    try {
+      refresh();
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Error: refresh failed: " << ex.what() << std::endl;
+    }
+  }
+}
+
+void unix_server::run()
+{
+  using clock_type = std::chrono::steady_clock;
+  // initial fetch must succeed, otherwise there is nothing to serve
+  try {
+    refresh();
+  }
+  catch (const std::exception& ex) {
+    throw std::runtime_error{std::string{"initial refresh failed: "} + ex.what()};
+  }
+  auto listen_fd = make_listener(options_.socket_path);
+  // refresh off this thread so a slow fetch or parse never stalls clients
+  std::thread refresher{&unix_server::refresh_loop, this};
+  // poll set is wakeup pipe, listener, then one entry per client
+  std::vector<client_state> clients;
+  std::vector<pollfd> poll_fds;
+  // listener is not polled until then after running out of descriptors
+  clock_type::time_point accept_resume;
+  // drop client at index i, swapping with the back
+  auto drop_client = [&clients](std::size_t i)
+  {
+    close(clients[i].fd);
+    clients[i] = std::move(clients.back());
+    clients.pop_back();
+  };
+  while (true) {
+    // rebuild poll set; only ask for writability when responses are pending
+    poll_fds.clear();
+    poll_fds.push_back({wakeup_fds_[0], POLLIN, 0});
+    auto accept_paused = clock_type::now() < accept_resume;
+    poll_fds.push_back({accept_paused ? -1 : listen_fd, POLLIN, 0});
+    for (const auto& client : clients)
+      poll_fds.push_back(
+        {client.fd, static_cast<short>(client.out.empty() ? POLLIN : POLLOUT), 0}
+      );
+    // wait until accepting resumes at the latest
+    auto timeout = -1;
+    if (accept_paused)
+      timeout = std::max(
+        1 + static_cast<int>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+            accept_resume - clock_type::now()
+          ).count()
+        ),
+        0
+      );
+    auto n_ready = poll(poll_fds.data(), static_cast<nfds_t>(poll_fds.size()), timeout);
+    if (n_ready < 0 && errno != EINTR) {
+      auto ex = errno_error("poll");
+      // stop refresher, which also polls the wakeup pipe
+      stop();
+      refresher.join();
+      for (const auto& client : clients)
+        close(client.fd);
+      close(listen_fd);
+      unlink(options_.socket_path.c_str());
+      throw ex;
+    }
+    // stop requested
+    if (poll_fds[0].revents)
+      break;
+    if (n_ready <= 0)
+      continue;
+    // all clients in this round are answered from the same snapshot
+    auto snapshot = snapshot_.load();
+    // service existing clients from the back so drop_client is safe. poll_fds
+    // index i + 2 corresponds to clients index i
+    for (auto i = clients.size(); i-- > 0; ) {
+      auto revents = poll_fds[i + 2].revents;
+      if (!revents)
+        continue;
+      auto& client = clients[i];
+      auto keep = true;
+      if (revents & (POLLERR | POLLNVAL))
+        keep = false;
+      else if (revents & (POLLIN | POLLHUP) && client.out.empty())
+        keep = read_requests(client, *snapshot);
+      if (keep && client.out.size())
+        keep = write_responses(client);
+      else if (keep && client.closing)
+        keep = false;
+      if (!keep)
+        drop_client(i);
+    }
+    // accept new clients
+    if (poll_fds[1].revents & POLLIN) {
+      while (true) {
+        auto fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) {
+          if (errno == EINTR || errno == ECONNABORTED)
+            continue;
+          // listener stays readable so back off instead of spinning
+          if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM)
+            accept_resume = clock_type::now() + accept_backoff;
+          break;
+        }
+        if (!set_nonblocking(fd)) {
+          close(fd);
+          continue;
+        }
+        clients.push_back({fd, {}, {}});
+      }
+    }
+  }
+  // clean up refresher, clients, listener, and socket file
+  refresher.join();
+  for (const auto& client : clients)
+    close(client.fd);
+  close(listen_fd);
+  unlink(options_.socket_path.c_str());
+}
+
+int serve(const server_options& options, const feed_fetcher& fetcher)
+{
+  try {
+    unix_server server{options, fetcher};
+    // stop gracefully on SIGINT and SIGTERM so the socket file is removed
+    struct sigaction action{};
+    action.sa_handler = stop_signal_server;
+    sigemptyset(&action.sa_mask);
+    signal_server = &server;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    // a client closing early must not kill the daemon
+    signal(SIGPIPE, SIG_IGN);
+    server.run();
+    signal_server = nullptr;
+  }
+  catch (const std::exception& ex) {
+    signal_server = nullptr;
+    std::cerr << "Error: " << ex.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
+}  // namespace pdxka
@@ -0,0 +1,61 @@
+/**
+ * @file snapshot.cc
+ * @author Derek Huang
+ * @brief C++ source for immutable snapshots of the parsed XKCD RSS feed
+ * @copyright MIT License
+ */
+
+#include "pdxka/snapshot.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <ctime>
+#include <utility>
+#include <vector>
+
+#include "pdxka/query.hh"
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+feed_snapshot::feed_snapshot(rss_item_vector items, std::time_t modified)
+  : items_{std::move(items)}, modified_{modified}
+{
+  number_index_.reserve(items_.size());
+  for (std::size_t i = 0; i < items_.size(); i++) {
+    // items without a comic number are not indexed
+    if (auto number = comic_number(items_[i]))
+      number_index_.emplace_back(number, i);
+  }
+  // stable sort so the newest item wins if a number is repeated
+  std::stable_sort(
+    number_index_.begin(),
+    number_index_.end(),
+    [](const auto& a, const auto& b) { return a.first < b.first; }
+  );
+}
+
+const rss_item* feed_snapshot::find(unsigned int number) const noexcept
+{
+  auto iter = std::lower_bound(
+    number_index_.begin(),
+    number_index_.end(),
+    number,
+    [](const auto& entry, unsigned int value) { return entry.first < value; }
+  );
+  if (iter == number_index_.end() || iter->first != number)
+    return nullptr;
+  return &items_[iter->second];
+}
+
+std::vector<const rss_item*> run_query(const feed_snapshot& snapshot, const query& q)
+{
+  if (q.type != query_type::number)
+    return run_query(snapshot.items(), q);
+  std::vector<const rss_item*> selected;
+  if (auto item = snapshot.find(q.value))
+    selected.push_back(item);
+  return selected;
+}
+
+}  // namespace pdxka
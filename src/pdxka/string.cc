@@ -8,79 +8,217 @@
 #include "pdxka/string.hh"
 
 #include <algorithm>
-#include <cctype>
 #include <cstdint>
-#include <sstream>
+#include <cstring>
 #include <string>
+#include <string_view>
+
+#include "pdxka/trace.hh"
+#include "pdxka/utf8.hh"
+#include "pdxka/whitespace.hh"
 
 namespace pdxka {
 
-std::string line_wrap(
-  const std::string& orig, std::size_t line_length, bool hard_wrap)
+namespace {
+
+/**
+ * Line wrap sink that only counts the characters it is given.
+ */
+class size_sink {
+public:
+  void put(char /*c*/) noexcept { size_++; }
+  void append(const char* /*data*/, std::size_t n) noexcept { size_ += n; }
+  auto size() const noexcept { return size_; }
+
+private:
+  std::size_t size_ = 0;
+};
+
+/**
+ * Line wrap sink writing to a buffer known to be large enough.
+ */
+class buffer_sink {
+public:
+  explicit buffer_sink(char* out) noexcept : out_{out} {}
+
+  void put(char c) noexcept { *out_++ = c; }
+
+  void append(const char* data, std::size_t n) noexcept
+  {
+    std::memcpy(out_, data, n);
+    out_ += n;
+  }
+
+  auto end() const noexcept { return out_; }
+
+private:
+  char* out_;
+};
+
+/**
+ * Line wrap measure for pure ASCII text, where columns are bytes.
+ */
+struct ascii_measure {
+  static std::size_t width(const char* /*data*/, std::size_t size) noexcept
+  {
+    return size;
+  }
+
+  static std::size_t first_size(const char* /*data*/, std::size_t /*size*/) noexcept
+  {
+    return 1;
+  }
+
+  static std::size_t prefix(
+    const char* /*data*/, std::size_t size, std::size_t columns, std::size_t& width) noexcept
+  {
+    width = std::max(std::size_t{1}, std::min(columns, size));
+    return width;
+  }
+};
+
+/**
+ * Line wrap measure for UTF-8 text, where columns are display columns.
+ */
+struct utf8_measure {
+  static std::size_t width(const char* data, std::size_t size) noexcept
+  {
+    return display_width({data, size});
+  }
+
+  static std::size_t first_size(const char* data, std::size_t size) noexcept
+  {
+    char32_t cp;
+    return utf8_decode(data, size, cp);
+  }
+
+  static std::size_t prefix(
+    const char* data, std::size_t size, std::size_t columns, std::size_t& width) noexcept
+  {
+    return display_prefix({data, size}, columns, width);
+  }
+};
+
+/**
+ * Wrap a string at `line_length`, writing each run of output to a sink.
+ *
+ * Input is split into segments each starting at a whitespace character, save
+ * for the first, and running up to the next whitespace character. A segment
+ * is copied whole if it fits on the current line. Otherwise its leading
+ * character is replaced with a newline and, when hard wrapping a segment
+ * longer than a line, the rest is split into chunks of at most `line_length`
+ * columns that are each followed by a newline.
+ *
+ * @tparam Measure `ascii_measure` or `utf8_measure`
+ * @tparam Sink `size_sink` or `buffer_sink`
+ *
+ * @param sink Sink to write to
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ */
+template <typename Measure, typename Sink>
+void wrap_measured(
+  Sink& sink, std::string_view orig, std::size_t line_length, bool hard_wrap)
 {
-  // output stream + number of characters used in line
-  std::stringstream stream;
+  // number of columns used in line, number of input bytes consumed
   std::size_t n_used = 0;
-  // size of string, number of characters written to stream
-  std::size_t n_chars = orig.size();
   std::size_t n_written = 0;
-  // loop through the string + 1
-  for (std::size_t i = 0; i <= n_chars; i++) {
-    // if past end or we see whitespace (undefined behavior without cast)
-    if (i == n_chars || std::isspace(static_cast<unsigned char>(orig[i]))) {
-      // number of characters that could be written
-      auto n_writable = i - n_written;
-      // if there is space in the line, write chars from n_written up to i
-// GCC warns about n_used possibly being used uninitialized for release builds
-// with -03. this seems like a false positive, so we silence the warning
-#if defined(__GNUG__) && defined(__OPTIMIZE__)
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
-#endif  // !defined(__GNUG__) || !defined(__OPTIMIZE__)
-      if (n_used + n_writable <= line_length) {
-#if defined(__GNUG__) && defined(__OPTIMIZE__)
-#pragma GCC diagnostic pop
-#endif  // !defined(__GNUG__) || !defined(__OPTIMIZE__)
-        for (auto j = n_written; j < i; j++) stream.put(orig[j]);
-        n_used += n_writable;
-      }
-      // otherwise, no space, so new line. but if word exceeds line_length and
-      // we choose to enforce hard wrap (break the word across lines).
-      else if (hard_wrap && n_writable > line_length) {
-        // increment n_written to "fake" writing the whitespace character
-        n_written++;
-        stream.put('\n');
-        // chunk size; we write in chunks until everything is written
-        std::size_t chunk_size;
-        // write until end of length, insert newline, continue, and repeat this
-        // until all the characters are written. then set n_used
-        while (n_written < i) {
-          // number of chars to write is either line_length or i - n_written
-          chunk_size = std::min(line_length, i - n_written);
-          for (auto j = n_written; j < n_written + chunk_size; j++)
-            stream.put(orig[j]);
-          stream.put('\n');
-          n_written += chunk_size;
-        }
-        // final chunk size is number of characters written in new line
-        n_used = chunk_size;
-      }
-      // no space but either soft wrap or word doesn't exceed line length
-      else {
-        // increment n_written to "fake" writing the whitespace character
-        n_written++;
-        stream.put('\n');
-        for (auto j = n_written; j < i; j++) stream.put(orig[j]);
-        // n_used is just the number of characters written
-        n_used = n_writable;
+  const auto n_chars = orig.size();
+  const auto data = orig.data();
+  // visit each whitespace position then the end of the string
+  whitespace_finder finder{orig};
+  for (auto i = finder.next(); ; i = finder.next()) {
+    auto n_writable = i - n_written;
+    auto width = Measure::width(data + n_written, n_writable);
+    // segment fits in the line so copy it with its leading whitespace
+    if (n_used + width <= line_length) {
+      sink.append(data + n_written, n_writable);
+      n_used += width;
+    }
+    // word exceeds line_length and we break it across lines
+    else if (hard_wrap && width > line_length) {
+      // skip the leading whitespace, replacing it with the newline
+      n_written += Measure::first_size(data + n_written, n_writable);
+      sink.put('\n');
+      std::size_t chunk_width = 0;
+      while (n_written < i) {
+        auto chunk_size = Measure::prefix(
+          data + n_written, i - n_written, line_length, chunk_width
+        );
+        sink.append(data + n_written, chunk_size);
+        sink.put('\n');
+        n_written += chunk_size;
       }
-      // update n_written to i
-      n_written = i;
+      // final chunk width is number of columns used in new line
+      n_used = chunk_width;
+    }
+    // no space but either soft wrap or word doesn't exceed line length
+    else {
+      n_written += Measure::first_size(data + n_written, n_writable);
+      sink.put('\n');
+      sink.append(data + n_written, i - n_written);
+      n_used = width;
     }
-    // otherwise, keep scanning the string
+    n_written = i;
+    if (i == n_chars)
+      break;
   }
-  // done with for loop, so return
-  return stream.str();
+}
+
+/**
+ * Wrap a string, using byte counts as widths if it is pure ASCII.
+ *
+ * @tparam Sink `size_sink` or `buffer_sink`
+ *
+ * @param sink Sink to write to
+ * @param orig Original string
+ * @param line_length Line length in columns to wrap at
+ * @param hard_wrap `true` to split a word whose width is greater than
+ *  `line_length` across lines, otherwise allow overflow
+ */
+template <typename Sink>
+void wrap_into(
+  Sink& sink, std::string_view orig, std::size_t line_length, bool hard_wrap)
+{
+  if (is_ascii(orig))
+    wrap_measured<ascii_measure>(sink, orig, line_length, hard_wrap);
+  else
+    wrap_measured<utf8_measure>(sink, orig, line_length, hard_wrap);
+}
+
+}  // namespace
+
+std::size_t line_wrap_size(
+  std::string_view orig, std::size_t line_length, bool hard_wrap) noexcept
+{
+  size_sink sink;
+  wrap_into(sink, orig, line_length, hard_wrap);
+  return sink.size();
+}
+
+char* line_wrap(
+  char* out,
+  std::string_view orig,
+  std::size_t line_length,
+  bool hard_wrap) noexcept
+{
+  buffer_sink sink{out};
+  wrap_into(sink, orig, line_length, hard_wrap);
+  return sink.end();
+}
+
+void line_wrap(
+  std::string& out,
+  std::string_view orig,
+  std::size_t line_length,
+  bool hard_wrap)
+{
+  PDXKA_TRACE_SPAN_ARG("line_wrap", orig.size());
+  auto offset = out.size();
+  out.resize(offset + line_wrap_size(orig, line_length, hard_wrap));
+  line_wrap(out.data() + offset, orig, line_length, hard_wrap);
 }
 
 }  // namespace pdxka
@@ -0,0 +1,157 @@
+/**
+ * @file template.cc
+ * @author Derek Huang
+ * @brief C++ source for user-defined output templates of XKCD RSS items
+ * @copyright MIT License
+ */
+
+#include "pdxka/template.hh"
+
+#include <charconv>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "pdxka/rss.hh"
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Throw an exception for an invalid template.
+ *
+ * @param spec Template text
+ * @param what Description of the problem
+ *
+ * @throws std::invalid_argument Always
+ */
+[[noreturn]] void template_error(std::string_view spec, const std::string& what)
+{
+  throw std::invalid_argument{
+    "invalid template \"" + std::string{spec} + "\": " + what
+  };
+}
+
+}  // namespace
+
+compiled_template::compiled_template(std::string_view spec)
+{
+  if (spec.size() > std::numeric_limits<std::uint32_t>::max())
+    template_error(spec, "template too long");
+  for (std::size_t i = 0; i < spec.size(); ) {
+    // literal run up to the next directive or escape
+    auto end = spec.find_first_of("%\\", i);
+    if (end == std::string_view::npos)
+      end = spec.size();
+    if (end > i) {
+      add_literal(spec.substr(i, end - i));
+      i = end;
+      continue;
+    }
+    if (i + 1 >= spec.size())
+      template_error(
+        spec, std::string{"incomplete "} + ((spec[i] == '%') ? "directive" : "escape")
+      );
+    auto c = spec[i + 1];
+    i += 2;
+    // backslash escapes
+    if (spec[i - 2] == '\\') {
+      if (c == 'n')
+        add_literal("\n");
+      else if (c == 't')
+        add_literal("\t");
+      else if (c == '\\')
+        add_literal("\\");
+      else
+        template_error(spec, std::string{"unknown escape \\"} + c);
+      continue;
+    }
+    // field directives
+    field what;
+    switch (c) {
+      case '%':
+        add_literal("%");
+        continue;
+      case 'n':
+        what = field::number;
+        break;
+      case 't':
+        what = field::title;
+        break;
+      case 'a':
+        what = field::alt;
+        break;
+      case 'l':
+        what = field::link;
+        break;
+      case 'i':
+        what = field::img;
+        break;
+      case 'd':
+        what = field::date;
+        break;
+      case 'g':
+        what = field::guid;
+        break;
+      default:
+        template_error(spec, std::string{"unknown directive %"} + c);
+    }
+    instructions_.push_back({what, 0, 0});
+  }
+}
+
+void compiled_template::add_literal(std::string_view text)
+{
+  // merge with the previous literal since literals are appended in order
+  if (instructions_.size() && instructions_.back().what == field::literal)
+    instructions_.back().size += static_cast<std::uint32_t>(text.size());
+  else
+    instructions_.push_back(
+      {
+        field::literal,
+        static_cast<std::uint32_t>(literals_.size()),
+        static_cast<std::uint32_t>(text.size())
+      }
+    );
+  literals_.append(text);
+}
+
+void compiled_template::render(std::string& out, const rss_item& item) const
+{
+  for (const auto& op : instructions_) {
+    switch (op.what) {
+      case field::literal:
+        out.append(literals_, op.offset, op.size);
+        break;
+      case field::number: {
+        char digits[std::numeric_limits<unsigned int>::digits10 + 1];
+        auto end = std::to_chars(digits, digits + sizeof digits, comic_number(item)).ptr;
+        out.append(digits, end);
+        break;
+      }
+      case field::title:
+        out.append(item.title());
+        break;
+      case field::alt:
+        out.append(item.img_title());
+        break;
+      case field::link:
+        out.append(item.link());
+        break;
+      case field::img:
+        out.append(item.img_src());
+        break;
+      case field::date:
+        out.append(item.pub_date());
+        break;
+      case field::guid:
+        out.append(item.guid());
+        break;
+    }
+  }
+}
+
+}  // namespace pdxka
@@ -0,0 +1,87 @@
+/**
+ * @file timing.cc
+ * @author Derek Huang
+ * @brief C++ source for per-phase latency breakdowns
+ * @copyright MIT License
+ */
+
+#include "pdxka/timing.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ios>
+#include <ostream>
+#include <string_view>
+#include <utility>
+
+namespace pdxka {
+
+namespace {
+
+/**
+ * Write a phase line with the duration in milliseconds.
+ *
+ * @param out Stream to write to
+ * @param name Phase name
+ * @param elapsed Phase duration
+ */
+void write_phase(std::ostream& out, std::string_view name, phase_timer::duration elapsed)
+{
+  out << "  " << std::left << std::setw(18) << name << std::right <<
+    std::setw(12) << std::chrono::duration<double, std::milli>(elapsed).count() <<
+    " ms\n";
+}
+
+}  // namespace
+
+void phase_timer::report(std::ostream& out) const
+{
+  if (!enabled_)
+    return;
+  auto flags = out.flags();
+  auto precision = out.precision(3);
+  out << std::fixed << "Timing:\n";
+  for (const auto& [name, elapsed] : phases_)
+    write_phase(out, name, elapsed);
+  write_phase(out, "total", clock::now() - start_);
+  out << std::flush;
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void add_curl_phases(phase_timer& timer, const curl_times& times)
+{
+  if (!timer.enabled() || times.total < 0)
+    return;
+  auto us = [](curl_off_t value)
+  {
+    return std::chrono::duration_cast<phase_timer::duration>(
+      std::chrono::microseconds{std::max<curl_off_t>(value, 0)}
+    );
+  };
+  // times are cumulative from the start of the transfer, with 0 for stages
+  // that were not reached because the transfer failed
+  const std::pair<std::string_view, curl_off_t> stages[] = {
+    {"dns", times.namelookup},
+    {"connect", times.connect},
+    {"tls", times.appconnect},
+    {"first_byte", times.starttransfer},
+    {"transfer", times.total}
+  };
+  curl_off_t done = 0;
+  for (auto [name, end] : stages) {
+    // plain HTTP has no TLS handshake
+    if (name == "tls" && !end && times.pretransfer > 0)
+      continue;
+    // failed stage took the rest of the time
+    if (end <= 0 && times.total > done) {
+      timer.add(name, us(times.total - done));
+      return;
+    }
+    timer.add(name, us(end - done));
+    done = std::max(done, end);
+  }
+}
+
+}  // namespace pdxka
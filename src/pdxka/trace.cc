@@ -0,0 +1,272 @@
+/**
+ * @file trace.cc
+ * @author Derek Huang
+ * @brief C++ source for scoped trace spans exported as Chrome trace JSON
+ * @copyright MIT License
+ */
+
+#include "pdxka/trace.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <ios>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pdxka/features.h"
+#include "pdxka/json.hh"
+#include "pdxka/version.h"
+
+namespace pdxka {
+
+#if PDXKA_TRACING
+std::atomic<bool> trace_active{false};
+
+namespace {
+
+/**
+ * Trace clock epoch.
+ */
+const auto trace_epoch = std::chrono::steady_clock::now();
+
+/**
+ * Recorded span.
+ *
+ * Fields are relaxed atomics so that a reader racing with the writer
+ * overwriting the slot is not a data race. Torn reads are detected with the
+ * buffer's `head` and dropped.
+ */
+struct trace_event {
+  std::atomic<const char*> name;
+  std::atomic<std::uint64_t> start;
+  std::atomic<std::uint64_t> end;
+  std::atomic<std::uint64_t> arg;
+};
+
+/**
+ * Number of slots in each thread's ring buffer.
+ */
+constexpr std::size_t trace_slots = trace_buffer_size + 1u;
+
+/**
+ * Per-thread single-producer ring buffer of recorded spans.
+ *
+ * Buffers are pushed onto a lock-free list when first used and are never
+ * freed, so spans from threads that have exited can still be written.
+ *
+ * There is one more slot than `trace_buffer_size` so that the most recent
+ * `trace_buffer_size` events can still be read while the next event is being
+ * written over the oldest slot.
+ *
+ * @param head Number of events ever recorded, where event `i` is in slot
+ *  `i % trace_slots` until it is overwritten
+ * @param base Number of events cleared by `clear_trace()`
+ * @param tid Thread index, starting from 1
+ * @param next Next buffer in the list
+ * @param events Ring buffer slots
+ */
+struct trace_buffer {
+  std::atomic<std::uint64_t> head{0u};
+  std::atomic<std::uint64_t> base{0u};
+  std::uint32_t tid;
+  trace_buffer* next;
+  trace_event events[trace_slots];
+};
+
+/**
+ * Head of the list of all thread buffers.
+ */
+std::atomic<trace_buffer*> trace_buffers{nullptr};
+
+/**
+ * Number of thread buffers, used to assign thread indices.
+ */
+std::atomic<std::uint32_t> trace_thread_count{0u};
+
+/**
+ * Calling thread's buffer, `nullptr` until it first records a span.
+ */
+thread_local trace_buffer* local_buffer = nullptr;
+
+/**
+ * Return the calling thread's buffer, allocating it if necessary.
+ *
+ * @returns Buffer, `nullptr` if allocation failed
+ */
+trace_buffer* thread_buffer() noexcept
+{
+  if (local_buffer)
+    return local_buffer;
+  auto buffer = new(std::nothrow) trace_buffer;
+  if (!buffer)
+    return nullptr;
+  buffer->tid = ++trace_thread_count;
+  buffer->next = trace_buffers.load(std::memory_order_relaxed);
+  while (
+    !trace_buffers.compare_exchange_weak(
+      buffer->next, buffer, std::memory_order_release, std::memory_order_relaxed
+    )
+  );
+  return local_buffer = buffer;
+}
+
+/**
+ * Append microseconds with nanosecond precision.
+ *
+ * @param out String to append to
+ * @param ns Nanoseconds
+ */
+void append_micros(std::string& out, std::uint64_t ns)
+{
+  char buf[32];
+  std::snprintf(
+    buf,
+    sizeof buf,
+    "%llu.%03u",
+    static_cast<unsigned long long>(ns / 1000u),
+    static_cast<unsigned int>(ns % 1000u)
+  );
+  out += buf;
+}
+
+}  // namespace
+
+std::uint64_t trace_now() noexcept
+{
+  return static_cast<std::uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - trace_epoch
+    ).count()
+  );
+}
+
+void trace_record(
+  const char* name, std::uint64_t start, std::uint64_t end, std::uint64_t arg) noexcept
+{
+  auto buffer = thread_buffer();
+  if (!buffer)
+    return;
+  auto head = buffer->head.load(std::memory_order_relaxed);
+  auto& event = buffer->events[head % trace_slots];
+  event.name.store(name, std::memory_order_relaxed);
+  event.start.store(start, std::memory_order_relaxed);
+  event.end.store(end, std::memory_order_relaxed);
+  event.arg.store(arg, std::memory_order_relaxed);
+  buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void start_tracing()
+{
+  trace_active.store(true, std::memory_order_relaxed);
+}
+
+void stop_tracing() noexcept
+{
+  trace_active.store(false, std::memory_order_relaxed);
+}
+
+void clear_trace() noexcept
+{
+  for (
+    auto buffer = trace_buffers.load(std::memory_order_acquire);
+    buffer;
+    buffer = buffer->next
+  )
+    buffer->base.store(buffer->head.load(std::memory_order_acquire));
+}
+
+std::string trace_json()
+{
+  std::string out{
+    "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+    "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+    "\"args\":{\"name\":\"" PDXKA_PROGNAME "\"}}"
+  };
+  for (
+    auto buffer = trace_buffers.load(std::memory_order_acquire);
+    buffer;
+    buffer = buffer->next
+  ) {
+    // copy the live window of the ring then drop slots that the writer may
+    // have started overwriting while they were being copied
+    auto head = buffer->head.load(std::memory_order_acquire);
+    auto first = std::max(
+      buffer->base.load(std::memory_order_relaxed),
+      head > trace_buffer_size ? head - trace_buffer_size : 0u
+    );
+    struct event_copy {
+      const char* name;
+      std::uint64_t start;
+      std::uint64_t end;
+      std::uint64_t arg;
+    };
+    std::vector<event_copy> events;
+    events.reserve(head - first);
+    for (auto i = first; i < head; i++) {
+      const auto& event = buffer->events[i % trace_slots];
+      events.push_back({
+        event.name.load(std::memory_order_relaxed),
+        event.start.load(std::memory_order_relaxed),
+        event.end.load(std::memory_order_relaxed),
+        event.arg.load(std::memory_order_relaxed)
+      });
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    auto new_head = buffer->head.load(std::memory_order_relaxed);
+    // slot of event i is rewritten once event i + trace_slots is being
+    // recorded, i.e. once head passes i + trace_buffer_size
+    auto valid = new_head >= trace_buffer_size ? new_head - trace_buffer_size : 0u;
+    for (auto i = first; i < head; i++) {
+      if (i < valid)
+        continue;
+      const auto& event = events[i - first];
+      out += ",\n{\"name\":";
+      append_json_string(out, event.name);
+      out += ",\"cat\":\"pdxka\",\"ph\":\"X\",\"ts\":";
+      append_micros(out, event.start);
+      out += ",\"dur\":";
+      append_micros(out, event.end - event.start);
+      out += ",\"pid\":1,\"tid\":";
+      append_json_number(out, buffer->tid);
+      if (event.arg != trace_no_arg) {
+        out += ",\"args\":{\"arg\":" + std::to_string(event.arg);
+        out += '}';
+      }
+      out += '}';
+    }
+  }
+  out += "\n]}\n";
+  return out;
+}
+#else
+void start_tracing()
+{
+  throw std::runtime_error{"libpdxka was built without tracing"};
+}
+
+void stop_tracing() noexcept {}
+
+void clear_trace() noexcept {}
+
+std::string trace_json()
+{
+  return "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n";
+}
+#endif  // !PDXKA_TRACING
+
+void write_trace(const std::string& path)
+{
+  auto json = trace_json();
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  if (!out.write(json.data(), static_cast<std::streamsize>(json.size())).flush())
+    throw std::runtime_error{"error writing " + path};
+}
+
+}  // namespace pdxka
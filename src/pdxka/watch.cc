@@ -0,0 +1,87 @@
+/**
+ * @file watch.cc
+ * @author Derek Huang
+ * @brief C++ source for watching the XKCD RSS feed for new comics
+ * @copyright MIT License
+ */
+
+#include "pdxka/watch.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "pdxka/rss.hh"
+#include "pdxka/schedule.hh"
+#include "pdxka/server.hh"
+
+namespace pdxka {
+
+std::size_t watch_feed(
+  const feed_fetcher& fetcher,
+  const std::function<void(const rss_item&)>& on_new,
+  const poll_policy& policy,
+  watch_hooks hooks)
+{
+  if (!hooks.now)
+    hooks.now = [] { return std::time(nullptr); };
+  if (!hooks.sleep)
+    hooks.sleep = [](std::chrono::seconds delay)
+    {
+      std::this_thread::sleep_for(delay);
+      return true;
+    };
+  // initial fetch must succeed so there is a baseline to compare against
+  std::time_t modified = 0;
+  rss_item_vector items;
+  try {
+    refresh_feed(fetcher, modified, items);
+  }
+  catch (const std::exception& ex) {
+    throw std::runtime_error{std::string{"initial fetch failed: "} + ex.what()};
+  }
+  std::unordered_set<std::string> seen;
+  for (const auto& item : items)
+    seen.insert(item.guid());
+  poll_planner planner{publish_schedule::learn(items), policy};
+  // don't poll densely for a comic that is already out
+  try {
+    planner.seen(parse_rfc822_date(items.front().pub_date()));
+  }
+  catch (const std::invalid_argument&) {}
+  std::size_t n_polls = 0;
+  while (hooks.sleep(planner.next_delay(hooks.now()))) {
+    n_polls++;
+    std::vector<const rss_item*> fresh;
+    try {
+      // a 304 leaves items untouched and needs no further work
+      if (refresh_feed(fetcher, modified, items)) {
+        // items are newest first so report in reverse for oldest first
+        for (auto it = items.rbegin(); it != items.rend(); it++)
+          if (seen.insert(it->guid()).second)
+            fresh.push_back(&*it);
+        if (fresh.size())
+          planner.reschedule(publish_schedule::learn(items));
+      }
+    }
+    catch (const std::exception& ex) {
+      std::cerr << "Error: " << ex.what() << std::endl;
+    }
+    // handler errors, e.g. failing to write, are not fetch errors and propagate
+    for (auto item : fresh)
+      on_new(*item);
+    planner.record(hooks.now(), !fresh.empty());
+  }
+  return n_polls;
+}
+
+}  // namespace pdxka
@@ -0,0 +1,176 @@
+/**
+ * @file alloc_budget_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests enforcing heap allocation budgets on hot paths
+ * @copyright MIT License
+ *
+ * Budgets are exact or tight upper bounds, so an allocation creeping back
+ * into a hot path fails the test instead of going unnoticed.
+ */
+
+#include <cstddef>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/format.hh"
+#include "pdxka/json.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/string.hh"
+#include "pdxka/template.hh"
+#include "pdxka/testing/rss.hh"
+
+// replacement operator new and operator delete for the whole test runner
+#define PDXKA_TESTING_ALLOC_COUNTER_MAIN
+#include "pdxka/testing/alloc_counter.hh"
+
+namespace pt = pdxka::testing;
+
+namespace {
+
+/**
+ * Alt text mixing ASCII and multibyte UTF-8 words longer than a line.
+ */
+const std::string utf8_text{
+  "Ünïcödé wörds like naïve and café wrap by display width, and so do "
+  "日本語のテキスト and an extremely_long_word_that_cannot_fit_on_one_line_at_all"
+};
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that the counter sees allocations made through the library.
+ */
+BOOST_AUTO_TEST_CASE(alloc_counter_test)
+{
+  const std::string orig(200u, 'x');
+  pt::alloc_counter counter;
+  auto text = pdxka::line_wrap(orig, 80, true);
+  auto allocations = counter.allocations();
+  auto bytes = counter.bytes();
+  auto peak = counter.peak_bytes();
+  BOOST_TEST(allocations == 1u);
+  BOOST_TEST(bytes > text.size());
+  BOOST_TEST(peak >= bytes);
+  counter.reset();
+  text = {};
+  text.shrink_to_fit();
+  auto deallocations = counter.deallocations();
+  auto retained = counter.retained_bytes();
+  BOOST_TEST(deallocations == 1u);
+  BOOST_TEST(retained < 0);
+}
+
+/**
+ * Test that wrapping into a reserved buffer does not allocate.
+ */
+BOOST_AUTO_TEST_CASE(line_wrap_reserved_alloc_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  std::string out;
+  out.reserve(4096u);
+  pt::alloc_counter counter;
+  for (const auto& item : items) {
+    out.clear();
+    pdxka::line_wrap(out, item.img_alt(), 80);
+    pdxka::line_wrap(out, item.img_alt(), 20, true);
+  }
+  out.clear();
+  pdxka::line_wrap(out, utf8_text, 40);
+  pdxka::line_wrap(out, utf8_text, 10, true);
+  auto allocations = counter.allocations();
+  BOOST_TEST(allocations == 0u);
+}
+
+/**
+ * Test that wrapping into a new string allocates exactly once.
+ */
+BOOST_AUTO_TEST_CASE(line_wrap_new_alloc_test)
+{
+  pt::alloc_counter counter;
+  auto wrapped = pdxka::line_wrap(utf8_text, 20, true);
+  auto allocations = counter.allocations();
+  BOOST_TEST(allocations == 1u);
+  BOOST_TEST(wrapped.size() == pdxka::line_wrap_size(utf8_text, 20, true));
+}
+
+/**
+ * Test that formatting items into a reserved buffer does not allocate.
+ */
+BOOST_AUTO_TEST_CASE(format_reserved_alloc_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  const pdxka::compiled_template tmpl{"%n\\t%t\\t%a\\n"};
+  std::string out;
+  out.reserve(16384u);
+  pt::alloc_counter counter;
+  for (const auto& item : items) {
+    pdxka::append_text(out, item, false);
+    pdxka::append_text(out, item, true);
+    pdxka::append_json(out, item);
+    pdxka::append_csv_field(out, item.img_alt());
+    pdxka::append_tsv_field(out, item.img_alt());
+    tmpl.render(out, item);
+  }
+  auto allocations = counter.allocations();
+  BOOST_TEST(allocations == 0u);
+}
+
+/**
+ * Test that extracting comic numbers does not allocate.
+ */
+BOOST_AUTO_TEST_CASE(comic_number_alloc_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  unsigned int sum = 0;
+  pt::alloc_counter counter;
+  for (const auto& item : items)
+    sum += pdxka::comic_number(item);
+  auto allocations = counter.allocations();
+  BOOST_TEST(allocations == 0u);
+  BOOST_TEST(sum == 2941u + 2940u + 2939u + 2938u);
+}
+
+/**
+ * Test the allocation budget for converting the parsed fixture to items.
+ *
+ * Most allocations are the property tree nodes of each item's `<description>`
+ * parsed as XML, so the budget is per item and includes the vector growth.
+ * This is 339 allocations for the 4 fixture items with Boost 1.74.
+ */
+BOOST_AUTO_TEST_CASE(to_item_vector_alloc_test)
+{
+  const auto tree = pdxka::parse_rss(pt::rss_fixture());
+  pt::alloc_counter counter;
+  auto items = pdxka::to_item_vector(tree);
+  auto allocations = counter.allocations();
+  auto n_items = items.size();
+  BOOST_TEST_REQUIRE(n_items == 4u);
+  BOOST_TEST_MESSAGE("to_item_vector: " << allocations << " allocations");
+  BOOST_TEST(allocations <= 88u * n_items);
+}
+
+/**
+ * Test the allocation and peak heap budgets for parsing the fixture XML.
+ *
+ * With Boost 1.74 this is 361 allocations and a peak of 18412 bytes, about
+ * 6.4 times the size of the XML.
+ */
+BOOST_AUTO_TEST_CASE(parse_rss_alloc_test)
+{
+  const auto& xml = pt::rss_fixture();
+  pt::alloc_counter counter;
+  auto tree = pdxka::parse_rss(xml);
+  auto allocations = counter.allocations();
+  auto peak = counter.peak_bytes();
+  BOOST_TEST_MESSAGE(
+    "parse_rss: " << allocations << " allocations, " << peak << " peak bytes"
+  );
+  BOOST_TEST(allocations <= 380u);
+  BOOST_TEST(peak <= 7u * xml.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,156 @@
+/**
+ * @file batch_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for batch.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/batch.hh"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/program_main.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/testing/program_main.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/testing/stream_diverter.hh"
+
+namespace pt = pdxka::testing;
+
+namespace {
+
+/**
+ * Batch queries used by the tests, one per line.
+ */
+constexpr auto batch_input =
+  "latest\n"
+  "back 2\n"
+  "number 2938\r\n"
+  "search complexity\n"
+  "search no such text\n"
+  "number 1\n"
+  "bogus";
+
+/**
+ * Return the expected answers to `batch_input`.
+ */
+std::string batch_expected()
+{
+  const auto& items = pt::rss_fixture_items();
+  auto one_line = [](const pdxka::rss_item& item)
+  {
+    return item.img_title() + " -- " + item.guid() + "\n";
+  };
+  return one_line(items[0]) + one_line(items[2]) + one_line(items[3]) +
+    items[2].guid() + "\n" +
+    "\n" +
+    "error: no such comic\n";
+}
+
+/**
+ * Output stream buffer counting the number of times it is synced.
+ */
+class sync_counting_buf : public std::stringbuf {
+public:
+  int n_syncs = 0;
+
+protected:
+  int sync() override
+  {
+    n_syncs++;
+    return std::stringbuf::sync();
+  }
+};
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that each query line gets exactly one answer line.
+ */
+BOOST_AUTO_TEST_CASE(run_batch_test)
+{
+  pdxka::feed_snapshot snapshot{pt::rss_fixture_items()};
+  std::istringstream in{batch_input};
+  std::ostringstream out;
+  BOOST_TEST(pdxka::run_batch(snapshot, in, out) == 7u);
+  auto received = out.str();
+  auto expected = batch_expected();
+  BOOST_TEST_REQUIRE(received.substr(0, expected.size()) == expected);
+  BOOST_TEST(received.substr(expected.size(), 7) == "error: ");
+  BOOST_TEST(received.back() == '\n');
+}
+
+/**
+ * Test that output is flushed every N answers or when the buffer fills.
+ */
+BOOST_AUTO_TEST_CASE(run_batch_flush_test)
+{
+  pdxka::feed_snapshot snapshot{pt::rss_fixture_items()};
+  // every 3 answers, then once more at the end of input
+  std::istringstream in{batch_input};
+  sync_counting_buf buf;
+  std::ostream out{&buf};
+  pdxka::run_batch(snapshot, in, out, 3u);
+  BOOST_TEST(buf.n_syncs == 3);
+  // default buffer holds everything so only flushed at the end
+  in = std::istringstream{batch_input};
+  buf.n_syncs = 0;
+  pdxka::run_batch(snapshot, in, out);
+  BOOST_TEST(buf.n_syncs == 1);
+  // tiny buffer is flushed after every answer
+  in = std::istringstream{batch_input};
+  buf.n_syncs = 0;
+  pdxka::run_batch(snapshot, in, out, 0u, 1u);
+  BOOST_TEST(buf.n_syncs == 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
+
+// XKCD alt text program tests
+BOOST_AUTO_TEST_SUITE(xkcd_alt)
+
+/**
+ * Test that `--batch` fetches once and answers queries from standard input.
+ */
+BOOST_AUTO_TEST_CASE(batch_program_main_test)
+{
+  unsigned int n_fetches = 0;
+  auto provider = [&n_fetches](const pdxka::cliopts&)
+  {
+    n_fetches++;
+    return pdxka::curl_result{
+      CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture()
+    };
+  };
+  std::istringstream in{batch_input};
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    auto orig_in = std::cin.rdbuf(in.rdbuf());
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--batch", "--flush-every", "2"),
+      provider
+    );
+    std::cin.rdbuf(orig_in);
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(n_fetches == 1u);
+  auto expected = batch_expected();
+  BOOST_TEST(out.str().substr(0, expected.size()) == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // xkcd_alt
@@ -0,0 +1,138 @@
+/**
+ * @file client_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for client.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/client.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <sstream>
+
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/program_main.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/program_main.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/testing/server.hh"
+
+namespace pt = pdxka::testing;
+
+namespace {
+
+/**
+ * Mock fetcher returning the fixture XML.
+ */
+pdxka::curl_result fixture_fetcher(std::time_t /*modified_since*/)
+{
+  return {CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200};
+}
+
+/**
+ * Mock RSS provider that fails, ensuring the network path is not taken.
+ */
+pdxka::curl_result failing_rss_get(const pdxka::cliopts& /*opts*/)
+{
+  return {CURLE_COULDNT_CONNECT, "mock failure", pdxka::request_type::get, ""};
+}
+
+/**
+ * Mock RSS provider returning the fixture XML.
+ */
+pdxka::curl_result fixture_rss_get(const pdxka::cliopts& /*opts*/)
+{
+  return fixture_fetcher(0);
+}
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that the daemon client receives the expected items.
+ */
+BOOST_AUTO_TEST_CASE(query_daemon_test)
+{
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  const auto& expected = pt::rss_fixture_items();
+  pdxka::rss_item_vector items;
+  BOOST_TEST_REQUIRE(pdxka::query_daemon(server.socket_path(), "back 2", items));
+  BOOST_TEST_REQUIRE(items.size() == 1u);
+  BOOST_TEST(items[0].guid() == expected[2].guid());
+  // error responses are failures
+  BOOST_TEST(!pdxka::query_daemon(server.socket_path(), "bogus", items));
+  server.join();
+}
+
+/**
+ * Test that the daemon client fails if there is no daemon.
+ */
+BOOST_AUTO_TEST_CASE(query_daemon_missing_test)
+{
+  pdxka::rss_item_vector items;
+  BOOST_TEST(!pdxka::query_daemon(pt::temp_socket_path(), "latest", items));
+  BOOST_TEST(!pdxka::query_daemon("", "latest", items));
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
+
+// XKCD alt text program tests
+BOOST_AUTO_TEST_SUITE(xkcd_alt)
+
+/**
+ * Test that the program main answers from the daemon without the network.
+ */
+BOOST_AUTO_TEST_CASE(daemon_fast_path_test)
+{
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  // compare with output of the network path
+  std::stringstream daemon_out;
+  std::stringstream network_out;
+  std::stringstream err_out;
+  BOOST_TEST_REQUIRE(
+    pt::program_main(
+      {"-o", "-b1", "--socket", server.socket_path()},
+      failing_rss_get,
+      daemon_out,
+      err_out
+    ) == EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST_REQUIRE(
+    pt::program_main({"-o", "-b1"}, fixture_rss_get, network_out, err_out) ==
+    EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST(daemon_out.str() == network_out.str());
+  server.join();
+}
+
+/**
+ * Test that the program main falls back to the network without a daemon.
+ */
+BOOST_AUTO_TEST_CASE(daemon_fallback_test)
+{
+  std::stringstream out;
+  std::stringstream err_out;
+  BOOST_TEST(
+    pt::program_main(
+      {"--socket", pt::temp_socket_path()}, fixture_rss_get, out, err_out
+    ) == EXIT_SUCCESS
+  );
+  BOOST_TEST(out.str().size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // xkcd_alt
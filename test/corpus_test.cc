@@ -0,0 +1,177 @@
+/**
+ * @file corpus_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for testing/corpus.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/testing/corpus.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+#include "pdxka/schedule.hh"
+#include "pdxka/utf8.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that equal seeds give equal corpora and different seeds do not.
+ */
+BOOST_AUTO_TEST_CASE(corpus_seed_test)
+{
+  auto a = pt::corpus_rss(pt::corpus_generator{1u}.items(50u));
+  BOOST_TEST(a == pt::corpus_rss(pt::corpus_generator{1u}.items(50u)));
+  BOOST_TEST(a != pt::corpus_rss(pt::corpus_generator{2u}.items(50u)));
+}
+
+/**
+ * Test that generated RSS parses back into the generated items.
+ */
+BOOST_AUTO_TEST_CASE(corpus_rss_round_trip_test)
+{
+  constexpr std::size_t n_items = 300u;
+  const auto items = pt::corpus_generator{}.items(n_items);
+  const auto parsed = pdxka::to_item_vector(pdxka::parse_rss(pt::corpus_rss(items)));
+  BOOST_TEST_REQUIRE(parsed.size() == n_items);
+  for (std::size_t i = 0; i < n_items; i++) {
+    BOOST_TEST_REQUIRE(pdxka::comic_number(parsed[i]) == n_items - i);
+    BOOST_TEST(parsed[i].title() == items[i].title());
+    BOOST_TEST(parsed[i].img_src() == items[i].img_src());
+    BOOST_TEST(parsed[i].img_title() == items[i].img_title());
+    BOOST_TEST(parsed[i].img_alt() == items[i].img_alt());
+    BOOST_TEST(parsed[i].guid() == items[i].guid());
+  }
+}
+
+/**
+ * Test that dates follow the Monday, Wednesday, Friday schedule.
+ */
+BOOST_AUTO_TEST_CASE(corpus_date_test)
+{
+  const auto items = pt::corpus_generator{}.items(7u);
+  BOOST_TEST(items.back().pub_date() == "Mon, 02 Jan 2006 04:00:00 -0000");
+  BOOST_TEST(items[5].pub_date() == "Wed, 04 Jan 2006 04:00:00 -0000");
+  BOOST_TEST(items[4].pub_date() == "Fri, 06 Jan 2006 04:00:00 -0000");
+  BOOST_TEST(items.front().pub_date() == "Mon, 16 Jan 2006 04:00:00 -0000");
+  BOOST_TEST(pt::corpus_iso_date(items.front().pub_date()) == "2006-01-16T04:00:00Z");
+  // leap day and far future dates still round trip
+  BOOST_TEST(pt::civil_from_days(11016).day == 29u);
+  BOOST_TEST(pt::civil_from_days(11016).month == 2u);
+  BOOST_TEST(pt::civil_from_days(0).weekday == 4u);
+  const auto last = pt::corpus_generator{}.item(1000000u);
+  BOOST_TEST(
+    pdxka::parse_rfc822_date(last.pub_date()) % (7 * 86400) ==
+    pdxka::parse_rfc822_date(items.back().pub_date()) % (7 * 86400)
+  );
+}
+
+/**
+ * Test that field distributions include long, escaped, and non-ASCII text.
+ */
+BOOST_AUTO_TEST_CASE(corpus_distribution_test)
+{
+  const auto items = pt::corpus_generator{}.items(2000u);
+  std::vector<std::size_t> sizes;
+  std::size_t n_long = 0;
+  std::size_t n_utf8 = 0;
+  std::size_t n_special = 0;
+  for (const auto& item : items) {
+    const auto& alt = item.img_alt();
+    sizes.push_back(alt.size());
+    n_long += (alt.size() > 500u);
+    n_utf8 += !pdxka::is_ascii(alt);
+    n_special += (alt.find_first_of("&<>\"") != std::string::npos);
+  }
+  std::sort(sizes.begin(), sizes.end());
+  auto median = sizes[sizes.size() / 2];
+  BOOST_TEST((median > 80u && median < 300u), "median " << median);
+  BOOST_TEST(sizes.back() > 1500u);
+  BOOST_TEST((n_long > 60u && n_long < 400u), "long " << n_long);
+  BOOST_TEST(n_utf8 > 500u);
+  BOOST_TEST(n_special > 500u);
+}
+
+/**
+ * Test that generated Atom has an entry per item.
+ */
+BOOST_AUTO_TEST_CASE(corpus_atom_test)
+{
+  const auto items = pt::corpus_generator{}.items(20u);
+  const auto tree = pdxka::parse_rss(pt::corpus_atom(items));
+  const auto& feed = tree.get_child("feed");
+  BOOST_TEST(feed.count("entry") == items.size());
+  auto entry = feed.find("entry");
+  BOOST_TEST_REQUIRE((entry != feed.not_found()));
+  BOOST_TEST(entry->second.get<std::string>("title") == items.front().title());
+  BOOST_TEST(entry->second.get<std::string>("link.<xmlattr>.href") == items.front().link());
+  // summary holds the escaped <img> element like the RSS description
+  const auto img = pdxka::parse_rss(entry->second.get<std::string>("summary"));
+  BOOST_TEST(img.get<std::string>("img.<xmlattr>.alt") == items.front().img_alt());
+}
+
+/**
+ * Test that each generated info.0.json line parses with matching fields.
+ */
+BOOST_AUTO_TEST_CASE(corpus_info_json_test)
+{
+  const auto items = pt::corpus_generator{}.items(100u);
+  std::istringstream stream{pt::corpus_info_json(items)};
+  std::string line;
+  std::size_t i = 0;
+  for (; std::getline(stream, line); i++) {
+    BOOST_TEST_REQUIRE(i < items.size());
+    boost::property_tree::ptree tree;
+    std::istringstream line_stream{line};
+    boost::property_tree::read_json(line_stream, tree);
+    BOOST_TEST(tree.get<std::size_t>("num") == items.size() - i);
+    BOOST_TEST(tree.get<std::string>("safe_title") == items[i].title());
+    BOOST_TEST(tree.get<std::string>("alt") == items[i].img_alt());
+    BOOST_TEST(tree.get<std::string>("year") == "2006");
+  }
+  BOOST_TEST(i == items.size());
+}
+
+/**
+ * Test that RSS parse time grows at most roughly linearly with item count.
+ *
+ * Going from 250 to 2000 items should take about 8 times as long. The best of
+ * 3 runs is compared against a generous bound so that scheduling noise does
+ * not cause failures while quadratic behavior, 64 times as long, still does.
+ *
+ * Being wall-clock timed, this is disabled by default and only registered with
+ * CTest as a perf-labeled test when configured with `PDXKA_PERF_TESTS=ON`.
+ */
+BOOST_AUTO_TEST_CASE(corpus_rss_scaling_test, *boost::unit_test::disabled())
+{
+  auto best_time = [](std::size_t n_items)
+  {
+    const auto xml = pt::corpus_rss(pt::corpus_generator{}.items(n_items));
+    auto best = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; i++) {
+      auto start = std::chrono::steady_clock::now();
+      auto items = pdxka::to_item_vector(pdxka::parse_rss(xml));
+      auto stop = std::chrono::steady_clock::now();
+      BOOST_TEST_REQUIRE(items.size() == n_items);
+      best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return best;
+  };
+  auto ratio = best_time(2000u) / best_time(250u);
+  BOOST_TEST(ratio < 24., "time ratio " << ratio);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
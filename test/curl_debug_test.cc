@@ -0,0 +1,101 @@
+/**
+ * @file curl_debug_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for curl_debug.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/curl_debug.hh"
+
+#include <string>
+#include <tuple>
+
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/testing/path.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that header blocks are split into lines and data keeps only sizes.
+ */
+BOOST_AUTO_TEST_CASE(curl_debug_log_record_test)
+{
+  pdxka::curl_debug_log log;
+  std::string header_out{"GET /rss.xml HTTP/2\r\nHost: xkcd.com\r\n\r\n"};
+  std::string header_in{"content-encoding: gzip\r\n"};
+  std::string data(1000, 'x');
+  // records are made through the callback the same way libcurl would
+  auto record = [&log](curl_infotype type, std::string& data)
+  {
+    return pdxka::curl_debug_log::callback(nullptr, type, data.data(), data.size(), &log);
+  };
+  BOOST_TEST(record(CURLINFO_HEADER_OUT, header_out) == 0);
+  BOOST_TEST(record(CURLINFO_HEADER_IN, header_in) == 0);
+  BOOST_TEST(record(CURLINFO_DATA_IN, data) == 0);
+  BOOST_TEST(record(CURLINFO_SSL_DATA_IN, data) == 0);
+  const auto& events = log.events();
+  BOOST_TEST_REQUIRE(events.size() == 5u);
+  BOOST_TEST(events[0].type == CURLINFO_HEADER_OUT);
+  BOOST_TEST(events[0].text == "GET /rss.xml HTTP/2");
+  BOOST_TEST(events[1].text == "Host: xkcd.com");
+  BOOST_TEST(events[2].text == "content-encoding: gzip");
+  BOOST_TEST(events[3].text.empty());
+  BOOST_TEST(events[3].size == data.size());
+  BOOST_TEST(log.bytes(CURLINFO_DATA_IN) == data.size());
+  BOOST_TEST(log.bytes(CURLINFO_SSL_DATA_IN) == data.size());
+  BOOST_TEST(log.bytes(CURLINFO_HEADER_IN) == header_in.size());
+  BOOST_TEST(log.bytes(CURLINFO_DATA_OUT) == 0u);
+  log.clear();
+  BOOST_TEST(log.events().empty());
+}
+
+/**
+ * Test that the JSON dump has events and byte totals.
+ */
+BOOST_AUTO_TEST_CASE(curl_debug_log_json_test)
+{
+  pdxka::curl_debug_log log;
+  log.record(CURLINFO_TEXT, "Re-using existing connection with host xkcd.com\n");
+  log.record(CURLINFO_HEADER_IN, "location: \"https://xkcd.com/\"\r\n");
+  log.record(CURLINFO_DATA_IN, std::string(42, 'x'));
+  auto json = log.json();
+  BOOST_TEST(json.find("{\"start\":") == 0u);
+  BOOST_TEST(
+    json.find(
+      ",\"type\":\"text\",\"text\":\"Re-using existing connection with host xkcd.com\"}"
+    ) != std::string::npos
+  );
+  BOOST_TEST(
+    json.find(",\"type\":\"header_in\",\"text\":\"location: \\\"https://xkcd.com/\\\"\"}") !=
+    std::string::npos
+  );
+  BOOST_TEST(json.find(",\"type\":\"data_in\",\"bytes\":42}") != std::string::npos);
+  BOOST_TEST(json.find("\"bytes\":{\"text\":48,\"header_in\":31,") != std::string::npos);
+  BOOST_TEST(json.find(",\"ssl_data_out\":0}}") != std::string::npos);
+}
+
+/**
+ * Test that an actual transfer is recorded.
+ *
+ * A `file://` URL is used so that no network access is needed.
+ */
+BOOST_AUTO_TEST_CASE(curl_debug_log_transfer_test)
+{
+  pdxka::curl_debug_log log;
+  auto url = "file://" + (pt::data_dir() / "xkcd-rss-20240604.xml").string();
+  auto res = std::apply(
+    [&url](const auto&... options) { return pdxka::curl_get(url, options...); },
+    log.options()
+  );
+  BOOST_TEST_REQUIRE(res.status == CURLE_OK, res.reason);
+  BOOST_TEST(res.payload.size());
+  BOOST_TEST(log.events().size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
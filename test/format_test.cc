@@ -0,0 +1,231 @@
+/**
+ * @file format_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for format.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/format.hh"
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/json.hh"
+#include "pdxka/output.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Input strings for the CSV and TSV field encoding tests.
+ */
+const std::string field_inputs[] = {
+  "",
+  "plain text",
+  "a, b",
+  "say \"hi\"",
+  "two\nlines\r",
+  "tab\tand back\\slash",
+  // longer than a vector block with the special character near the end
+  "0123456789abcdef0123456789abcdef0123456789, end"
+};
+
+/**
+ * Expected CSV encodings of `field_inputs`.
+ */
+const std::string csv_outputs[] = {
+  "",
+  "plain text",
+  "\"a, b\"",
+  "\"say \"\"hi\"\"\"",
+  "\"two\nlines\r\"",
+  "tab\tand back\\slash",
+  "\"0123456789abcdef0123456789abcdef0123456789, end\""
+};
+
+/**
+ * Expected TSV encodings of `field_inputs`.
+ */
+const std::string tsv_outputs[] = {
+  "",
+  "plain text",
+  "a, b",
+  "say \"hi\"",
+  "two\\nlines\\r",
+  "tab\\tand back\\\\slash",
+  "0123456789abcdef0123456789abcdef0123456789, end"
+};
+
+/**
+ * Return the output of writing the first `n` fixture items in a format.
+ *
+ * @param format Output format
+ * @param n Number of fixture items to write
+ */
+std::string write_fixture(pdxka::output_format format, std::size_t n)
+{
+  std::stringstream ss;
+  {
+    pdxka::output_buffer out{ss};
+    pdxka::record_writer writer{out, format};
+    for (std::size_t i = 0; i < n; i++)
+      writer.write(pt::rss_fixture_items()[i]);
+    writer.finish();
+    BOOST_TEST(writer.count() == n);
+  }
+  return ss.str();
+}
+
+/**
+ * Return an RSS item as a JSON object.
+ *
+ * @param i Fixture item index
+ */
+std::string fixture_json(std::size_t i)
+{
+  std::string out;
+  pdxka::append_json(out, pt::rss_fixture_items()[i]);
+  return out;
+}
+
+}  // namespace
+
+/**
+ * Test that output format names are parsed and unknown names rejected.
+ */
+BOOST_AUTO_TEST_CASE(parse_output_format_test)
+{
+  BOOST_TEST((pdxka::parse_output_format("text") == pdxka::output_format::text));
+  BOOST_TEST((pdxka::parse_output_format("json") == pdxka::output_format::json));
+  BOOST_TEST((pdxka::parse_output_format("ndjson") == pdxka::output_format::ndjson));
+  BOOST_TEST((pdxka::parse_output_format("csv") == pdxka::output_format::csv));
+  BOOST_TEST((pdxka::parse_output_format("tsv") == pdxka::output_format::tsv));
+  BOOST_CHECK_THROW(pdxka::parse_output_format("xml"), std::invalid_argument);
+  BOOST_CHECK_THROW(pdxka::parse_output_format(""), std::invalid_argument);
+}
+
+/**
+ * Test that CSV fields are quoted only when necessary.
+ */
+BOOST_DATA_TEST_CASE(
+  append_csv_field_test,
+  bdata::make(field_inputs) ^ bdata::make(csv_outputs),
+  input,
+  expected)
+{
+  std::string out;
+  pdxka::append_csv_field(out, input);
+  BOOST_TEST(out == expected);
+}
+
+/**
+ * Test that TSV fields are escaped to stay on one line.
+ */
+BOOST_DATA_TEST_CASE(
+  append_tsv_field_test,
+  bdata::make(field_inputs) ^ bdata::make(tsv_outputs),
+  input,
+  expected)
+{
+  std::string out;
+  pdxka::append_tsv_field(out, input);
+  BOOST_TEST(out == expected);
+}
+
+/**
+ * Test that JSON output is an array of one object per line.
+ */
+BOOST_AUTO_TEST_CASE(record_writer_json_test)
+{
+  BOOST_TEST(
+    write_fixture(pdxka::output_format::json, 2u) ==
+    "[\n" + fixture_json(0) + ",\n" + fixture_json(1) + "\n]\n"
+  );
+  BOOST_TEST(write_fixture(pdxka::output_format::json, 0u) == "[]\n");
+}
+
+/**
+ * Test that NDJSON output is one object per line with no array.
+ */
+BOOST_AUTO_TEST_CASE(record_writer_ndjson_test)
+{
+  BOOST_TEST(
+    write_fixture(pdxka::output_format::ndjson, 2u) ==
+    fixture_json(0) + "\n" + fixture_json(1) + "\n"
+  );
+  BOOST_TEST(write_fixture(pdxka::output_format::ndjson, 0u).empty());
+}
+
+/**
+ * Test that delimited output has a header row and one row per item.
+ */
+BOOST_AUTO_TEST_CASE(record_writer_delimited_test)
+{
+  const auto& item = pt::rss_fixture_items()[1];
+  std::string csv_row{"2940,"};
+  pdxka::append_csv_field(csv_row, item.title());
+  for (const auto& field : {
+    item.link(), item.img_src(), item.img_title(), item.img_alt(),
+    item.pub_date(), item.guid()
+  }) {
+    csv_row += ',';
+    pdxka::append_csv_field(csv_row, field);
+  }
+  auto csv = write_fixture(pdxka::output_format::csv, 2u);
+  BOOST_TEST(
+    csv.substr(0, csv.find('\n') + 1) ==
+    "number,title,link,img_src,img_title,img_alt,pub_date,guid\n"
+  );
+  BOOST_TEST(csv.substr(csv.size() - csv_row.size() - 1) == csv_row + "\n");
+  // header only when there are no items
+  BOOST_TEST(
+    write_fixture(pdxka::output_format::tsv, 0u) ==
+    "number\ttitle\tlink\timg_src\timg_title\timg_alt\tpub_date\tguid\n"
+  );
+  // every TSV record is exactly one line of 8 fields
+  auto tsv = write_fixture(pdxka::output_format::tsv, 4u);
+  std::istringstream lines{tsv};
+  std::size_t n_lines = 0;
+  for (std::string line; std::getline(lines, line); n_lines++) {
+    std::size_t n_tabs = 0;
+    for (auto c : line)
+      n_tabs += (c == '\t');
+    BOOST_TEST(n_tabs == 7u);
+  }
+  BOOST_TEST(n_lines == 5u);
+}
+
+/**
+ * Test that text output matches the fortune-style and one-line formats.
+ */
+BOOST_AUTO_TEST_CASE(append_text_test)
+{
+  pdxka::rss_item item{
+    "Title",
+    "https://xkcd.com/1234/",
+    "https://imgs.xkcd.com/comics/a.png",
+    "short alt text",
+    "Title",
+    "Mon, 03 Jun 2024 04:00:00 -0000",
+    "https://xkcd.com/1234/"
+  };
+  std::string out;
+  pdxka::append_text(out, item, true);
+  BOOST_TEST(out == "short alt text -- https://xkcd.com/1234/\n");
+  out.clear();
+  pdxka::append_text(out, item, false);
+  BOOST_TEST(out == "short alt text\n\t\t-- https://xkcd.com/1234/\n");
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,164 @@
+/**
+ * @file fortune_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for fortune.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/fortune.hh"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Cookie file with two cookies and an empty cookie between them.
+ */
+const std::string cookie_file{"A\n%\n%\nBC\n%\n"};
+
+/**
+ * `strfile` index of `cookie_file`, as written by fortune-mod's `strfile`.
+ */
+const std::string cookie_dat{
+  // version, count, longest, shortest, flags
+  "\0\0\0\x02" "\0\0\0\x02" "\0\0\0\x03" "\0\0\0\x02" "\0\0\0\0"
+  // delimiter + padding
+  "%\0\0\0"
+  // offsets, where strfile does not record the empty cookie
+  "\0\0\0\0" "\0\0\0\x04" "\0\0\0\x0b",
+  36u
+};
+
+/**
+ * Return a file's contents.
+ *
+ * @param path File path
+ */
+std::string slurp(const std::filesystem::path& path)
+{
+  std::ifstream in{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+/**
+ * Temporary directory removed on destruction.
+ */
+class temp_dir {
+public:
+  temp_dir()
+    : path_{
+        (
+          boost::filesystem::temp_directory_path() /
+          boost::filesystem::unique_path("pdxka-%%%%%%%%")
+        ).string()
+      }
+  {}
+
+  ~temp_dir()
+  {
+    std::error_code ec;
+    std::filesystem::remove_all(path_, ec);
+  }
+
+  const auto& path() const noexcept { return path_; }
+
+private:
+  std::filesystem::path path_;
+};
+
+}  // namespace
+
+/**
+ * Test that scanning a cookie file gives the index strfile writes.
+ */
+BOOST_AUTO_TEST_CASE(strfile_index_scan_test)
+{
+  auto index = pdxka::strfile_index::scan(cookie_file);
+  BOOST_TEST(index.count() == 2u);
+  BOOST_TEST(index.longest() == 3u);
+  BOOST_TEST(index.shortest() == 2u);
+  BOOST_TEST(index.serialize() == cookie_dat);
+}
+
+/**
+ * Test that serialized indexes are parsed back and bad indexes rejected.
+ */
+BOOST_AUTO_TEST_CASE(strfile_index_parse_test)
+{
+  auto index = pdxka::strfile_index::parse(cookie_dat);
+  BOOST_TEST(index.offsets() == pdxka::strfile_index::scan(cookie_file).offsets());
+  BOOST_TEST(index.serialize() == cookie_dat);
+  // empty index
+  pdxka::strfile_index empty;
+  BOOST_TEST(empty.shortest() == 0u);
+  BOOST_TEST(pdxka::strfile_index::parse(empty.serialize()).count() == 0u);
+  // truncated, wrong version, and randomized
+  BOOST_CHECK_THROW(
+    pdxka::strfile_index::parse(cookie_dat.substr(0, 30)), std::runtime_error
+  );
+  auto bad = cookie_dat;
+  bad[3] = '\x01';
+  BOOST_CHECK_THROW(pdxka::strfile_index::parse(bad), std::runtime_error);
+  bad = cookie_dat;
+  bad[19] = '\x01';
+  BOOST_CHECK_THROW(pdxka::strfile_index::parse(bad), std::runtime_error);
+}
+
+/**
+ * Test that exports append only new comics and keep the index in sync.
+ */
+BOOST_AUTO_TEST_CASE(export_fortune_test)
+{
+  temp_dir dir;
+  const auto& items = pt::rss_fixture_items();
+  // oldest two comics first, as if exported before the others were published
+  pdxka::rss_item_vector older{items.begin() + 2, items.end()};
+  auto result = pdxka::export_fortune(dir.path(), older);
+  BOOST_TEST(result.added == 2u);
+  BOOST_TEST(result.total == 2u);
+  auto first_export = slurp(dir.path() / "xkcd");
+  // then the full feed, where only the two newer comics are new
+  result = pdxka::export_fortune(dir.path(), items);
+  BOOST_TEST(result.added == 2u);
+  BOOST_TEST(result.total == 4u);
+  auto cookies = slurp(dir.path() / "xkcd");
+  auto dat = slurp(dir.path() / "xkcd.dat");
+  BOOST_TEST(cookies.substr(0, first_export.size()) == first_export);
+  BOOST_TEST(dat == pdxka::strfile_index::scan(cookies).serialize());
+  // cookies are oldest first, each ending with its attestation
+  auto index = pdxka::strfile_index::parse(dat);
+  for (std::size_t i = 0; i < index.count(); i++) {
+    auto cookie = cookies.substr(
+      index.offsets()[i], index.offsets()[i + 1] - index.offsets()[i]
+    );
+    auto attestation = "\t\t-- " + items[items.size() - 1 - i].guid() + "\n%\n";
+    BOOST_TEST(
+      cookie.substr(cookie.size() - attestation.size()) == attestation
+    );
+  }
+  // nothing new, and a missing index is rebuilt from the cookie file
+  std::filesystem::remove(dir.path() / "xkcd.dat");
+  result = pdxka::export_fortune(dir.path(), items);
+  BOOST_TEST(result.added == 0u);
+  BOOST_TEST(result.total == 4u);
+  BOOST_TEST(slurp(dir.path() / "xkcd") == cookies);
+  BOOST_TEST(slurp(dir.path() / "xkcd.dat") == dat);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,259 @@
+/**
+ * @file http_server_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for http_server.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/http_server.hh"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/json.hh"
+#include "pdxka/testing/http_server.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Mock fetcher that always returns the fixture XML.
+ */
+pdxka::curl_result fixture_fetcher(std::time_t /*modified_since*/)
+{
+  return {CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200};
+}
+
+/**
+ * Return the JSON object for the fixture item at the given index.
+ *
+ * @param i Item index
+ */
+std::string fixture_json(std::size_t i)
+{
+  std::string out;
+  pdxka::append_json(out, pt::rss_fixture_items()[i]);
+  return out;
+}
+
+}  // namespace
+
+/**
+ * Test that valid endpoints are parsed.
+ */
+BOOST_AUTO_TEST_CASE(parse_endpoint_test)
+{
+  pdxka::http_server_options options;
+  pdxka::parse_endpoint("0.0.0.0:80", options);
+  BOOST_TEST(options.address == "0.0.0.0");
+  BOOST_TEST(options.port == 80u);
+  pdxka::parse_endpoint("[::1]:8080", options);
+  BOOST_TEST(options.address == "::1");
+  BOOST_TEST(options.port == 8080u);
+}
+
+/**
+ * Test that malformed endpoints are rejected.
+ */
+BOOST_DATA_TEST_CASE(
+  parse_endpoint_invalid_test,
+  bdata::make({"127.0.0.1", ":8080", "127.0.0.1:", "127.0.0.1:http", "h:70000"}),
+  endpoint)
+{
+  pdxka::http_server_options options;
+  BOOST_CHECK_THROW(pdxka::parse_endpoint(endpoint, options), std::invalid_argument);
+}
+
+/**
+ * Test that routes are answered with the right status and JSON body.
+ */
+BOOST_AUTO_TEST_CASE(handle_http_request_test)
+{
+  pdxka::feed_snapshot snapshot{pt::rss_fixture_items()};
+  auto response = pdxka::handle_http_request(snapshot, "GET", "/latest");
+  BOOST_TEST(response.status == 200);
+  BOOST_TEST(response.body == fixture_json(0));
+  response = pdxka::handle_http_request(snapshot, "GET", "/back/2");
+  BOOST_TEST(response.status == 200);
+  BOOST_TEST(response.body == fixture_json(2));
+  response = pdxka::handle_http_request(snapshot, "HEAD", "/comic/2938");
+  BOOST_TEST(response.status == 200);
+  BOOST_TEST(response.body == fixture_json(3));
+  response = pdxka::handle_http_request(snapshot, "GET", "/search?x=1&q=Golgi");
+  BOOST_TEST(response.status == 200);
+  BOOST_TEST(response.body == "[" + fixture_json(0) + "]");
+  response = pdxka::handle_http_request(snapshot, "GET", "/search?q=no+such%20text");
+  BOOST_TEST(response.status == 200);
+  BOOST_TEST(response.body == "[]");
+  // errors
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "GET", "/back/9").status == 404);
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "GET", "/back/x").status == 400);
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "GET", "/comic/1").status == 404);
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "GET", "/search").status == 400);
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "GET", "/").status == 404);
+  BOOST_TEST(pdxka::handle_http_request(snapshot, "POST", "/latest").status == 405);
+}
+
+/**
+ * Test that pipelined requests on a persistent connection are answered.
+ */
+BOOST_DATA_TEST_CASE(http_server_test, bdata::make({1u, 3u}), workers)
+{
+  pt::scoped_http_server server{
+    {"127.0.0.1", 0u, workers, std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  // pipelined keep-alive requests, a request with a body, then close
+  auto received = pt::http_exchange(
+    server.port(),
+    "GET /latest HTTP/1.1\r\nHost: x\r\n\r\n"
+    "POST /latest HTTP/1.1\r\nContent-Length: 3\r\n\r\nabc"
+    "GET /back/1 HTTP/1.1\r\nConnection: close\r\n\r\n"
+    "GET /latest HTTP/1.1\r\n\r\n"
+  );
+  server.join();
+  auto body = fixture_json(0);
+  std::string expected{
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+    std::to_string(body.size()) + "\r\n\r\n" + body
+  };
+  BOOST_TEST_REQUIRE(received.substr(0, expected.size()) == expected);
+  received.erase(0, expected.size());
+  BOOST_TEST_REQUIRE(received.substr(0, 28) == "HTTP/1.1 405 Method Not Allo");
+  // request after Connection: close is not answered
+  body = fixture_json(1);
+  expected =
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+    std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+  auto pos = received.find("HTTP/1.1 200");
+  BOOST_TEST_REQUIRE(pos != std::string::npos);
+  BOOST_TEST(received.substr(pos) == expected);
+}
+
+/**
+ * Test that HTTP/1.0 requests are answered and the connection closed.
+ */
+BOOST_AUTO_TEST_CASE(http_server_http10_test)
+{
+  pt::scoped_http_server server{
+    {"127.0.0.1", 0u, 1u, std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  auto received = pt::http_exchange(server.port(), "HEAD /comic/2940 HTTP/1.0\r\n\r\n");
+  server.join();
+  std::string expected{
+    "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+    std::to_string(fixture_json(1).size()) + "\r\nConnection: close\r\n\r\n"
+  };
+  BOOST_TEST(received == expected);
+}
+
+/**
+ * Test that oversized or malformed requests are rejected and the connection
+ * closed.
+ */
+BOOST_DATA_TEST_CASE(
+  http_server_limits_test,
+  bdata::make(
+    std::vector<std::string>{
+      "GET /latest HTTP/1.1\r\nContent-Length: 99999999999999999999999\r\n\r\n",
+      "GET /latest HTTP/1.1\r\nContent-Length: 3x\r\n\r\nabc",
+      "GET /latest HTTP/1.1\r\nContent-Length: 1048576\r\n\r\n",
+      "GET /latest HTTP/1.1\r\nX-Padding: " + std::string(10000u, 'x') + "\r\n\r\n"
+    }
+  ) ^
+  bdata::make({400, 400, 413, 431}),
+  request,
+  status)
+{
+  pt::scoped_http_server server{
+    {"127.0.0.1", 0u, 1u, std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  auto received = pt::http_exchange(server.port(), request + "GET /latest HTTP/1.1\r\n\r\n");
+  server.join();
+  BOOST_TEST(received.substr(0, 12) == "HTTP/1.1 " + std::to_string(status), received);
+  // no further requests are answered
+  BOOST_TEST(received.find("HTTP/1.1", 1) == std::string::npos);
+}
+
+/**
+ * Test that a client pipelining many requests before reading gets every
+ * response.
+ */
+BOOST_AUTO_TEST_CASE(http_server_backlog_test)
+{
+  pt::scoped_http_server server{
+    {"127.0.0.1", 0u, 1u, std::chrono::seconds{900}}, fixture_fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  auto fd = pt::tcp_connect(server.port());
+  BOOST_TEST_REQUIRE(fd >= 0);
+  // responses are several times the backlog limit, so the server has to stop
+  // and resume reading while the requests are being sent
+  constexpr std::size_t n_requests = 5000u;
+  std::string requests;
+  for (std::size_t i = 0; i < n_requests; i++)
+    requests += "GET /latest HTTP/1.1\r\n\r\n";
+  std::thread sender{
+    [fd, &requests]
+    {
+      pt::send_all(fd, requests);
+      shutdown(fd, SHUT_WR);
+    }
+  };
+  std::string received;
+  char buf[65536];
+  for (ssize_t n; (n = recv(fd, buf, sizeof buf, 0)) > 0; )
+    received.append(buf, static_cast<std::size_t>(n));
+  sender.join();
+  close(fd);
+  server.join();
+  std::size_t n_responses = 0;
+  for (
+    auto pos = received.find("HTTP/1.1 200 OK");
+    pos != std::string::npos;
+    pos = received.find("HTTP/1.1 200 OK", pos + 1)
+  )
+    n_responses++;
+  BOOST_TEST(n_responses == n_requests);
+}
+
+/**
+ * Test that the server does not start if the initial fetch fails.
+ */
+BOOST_AUTO_TEST_CASE(http_server_fetch_error_test)
+{
+  pdxka::http_server server{
+    {"127.0.0.1", 0u, 1u, std::chrono::seconds{900}},
+    [](std::time_t)
+    {
+      return pdxka::curl_result{
+        CURLE_COULDNT_CONNECT, "mock failure", pdxka::request_type::get, ""
+      };
+    }
+  };
+  BOOST_CHECK_THROW(server.run(), std::runtime_error);
+  BOOST_TEST(server.port() == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,229 @@
+/**
+ * @file input_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for input.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/input.hh"
+
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/program_main.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/program_main.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/testing/stream_diverter.hh"
+#include "pdxka/version.h"
+
+namespace pt = pdxka::testing;
+
+namespace {
+
+/**
+ * Context manager for reading standard input from a string.
+ */
+class stdin_diverter {
+public:
+  /**
+   * Ctor.
+   *
+   * @param text Text to read from `std::cin`
+   */
+  explicit stdin_diverter(std::string text)
+    : in_{std::move(text)}, orig_buf_{std::cin.rdbuf(in_.rdbuf())}
+  {}
+
+  /**
+   * Dtor.
+   *
+   * Restores the original stream buffer.
+   */
+  ~stdin_diverter()
+  {
+    std::cin.rdbuf(orig_buf_);
+  }
+
+private:
+  std::istringstream in_;
+  std::streambuf* orig_buf_;
+};
+
+/**
+ * Provider that fails, to check that it is bypassed by `--input`.
+ *
+ * @param opts Ignored command-line options struct
+ */
+pdxka::curl_result failing_rss_get(const pdxka::cliopts& /*opts*/)
+{
+  return {
+    CURLE_COULDNT_CONNECT, "provider should not be used", pdxka::request_type::get, ""
+  };
+}
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that a feed file is memory-mapped and parses like the fixture.
+ */
+BOOST_AUTO_TEST_CASE(feed_input_file_test)
+{
+  pdxka::feed_input input{pt::rss_fixture_path()};
+  BOOST_TEST(input.mapped());
+  BOOST_TEST(input.view() == pt::rss_fixture());
+  BOOST_TEST(input.file_time() > 0);
+  // moving keeps the mapping
+  auto moved = std::move(input);
+  BOOST_TEST(moved.mapped());
+  BOOST_TEST(!input.mapped());
+  BOOST_TEST(input.view().empty());
+  const auto items = pdxka::to_item_vector(pdxka::parse_rss(moved.view()));
+  BOOST_TEST_REQUIRE(items.size() == pt::rss_fixture_items().size());
+  BOOST_TEST(items.front().img_alt() == pt::rss_fixture_items().front().img_alt());
+}
+
+/**
+ * Test that standard input is read into an owned buffer.
+ */
+BOOST_AUTO_TEST_CASE(feed_input_stdin_test)
+{
+  stdin_diverter diverter{pt::rss_fixture()};
+  pdxka::feed_input input{"-"};
+  BOOST_TEST(!input.mapped());
+  BOOST_TEST(input.view() == pt::rss_fixture());
+  BOOST_TEST(input.file_time() == -1);
+  // buffer is small enough to be stored inline in a moved-to string
+  stdin_diverter short_diverter{"<rss/>"};
+  auto moved = pdxka::feed_input{"-"};
+  BOOST_TEST(moved.view() == "<rss/>");
+}
+
+/**
+ * Test that a missing file throws.
+ */
+BOOST_AUTO_TEST_CASE(feed_input_missing_test)
+{
+  BOOST_CHECK_THROW(
+    pdxka::feed_input{pt::rss_fixture_path() + ".missing"}, std::runtime_error
+  );
+}
+
+/**
+ * Test that reading a file as a `curl_result` honors `modified_since`.
+ */
+BOOST_AUTO_TEST_CASE(read_input_test)
+{
+  auto res = pdxka::read_input(pt::rss_fixture_path());
+  BOOST_TEST_REQUIRE(res.status == CURLE_OK, res.reason);
+  BOOST_TEST(res.response_code == 200);
+  BOOST_TEST(res.payload == pt::rss_fixture());
+  BOOST_TEST(res.file_time > 0);
+  // unchanged since the previous read
+  auto unchanged = pdxka::read_input(
+    pt::rss_fixture_path(), static_cast<std::time_t>(res.file_time)
+  );
+  BOOST_TEST(unchanged.not_modified());
+  BOOST_TEST(unchanged.payload.empty());
+  // modified since the given time
+  auto modified = pdxka::read_input(
+    pt::rss_fixture_path(), static_cast<std::time_t>(res.file_time - 1)
+  );
+  BOOST_TEST(modified.response_code == 200);
+  // errors are reported like libcurl errors
+  auto missing = pdxka::read_input(pt::rss_fixture_path() + ".missing");
+  BOOST_TEST(missing.status == CURLE_READ_ERROR);
+  BOOST_TEST(missing.reason.find("open") == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
+
+// XKCD alt text program tests
+BOOST_AUTO_TEST_SUITE(xkcd_alt)
+
+/**
+ * Test that --input reads the feed from a file or stdin, not the provider.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_input)
+{
+  // path is not a literal so argv is built directly
+  std::string args[] = {
+    PDXKA_PROGNAME, "--input", pt::rss_fixture_path(), "-b1", "--template", "%n\\n"
+  };
+  char* argv[] = {
+    args[0].data(), args[1].data(), args[2].data(), args[3].data(),
+    args[4].data(), args[5].data(), nullptr
+  };
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pdxka::program_main(6, argv, failing_rss_get);
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(out.str() == "2940\n");
+  // standard input
+  out.str("");
+  {
+    stdin_diverter in_diverter{pt::rss_fixture()};
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--input", "-", "--all", "--template", "%n "),
+      failing_rss_get
+    );
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(out.str() == "2941 2940 2939 2938 ");
+}
+
+/**
+ * Test that --input errors are reported.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_input_error)
+{
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--input", "/nonexistent/rss.xml"),
+      failing_rss_get
+    );
+  }
+  BOOST_TEST(ret == EXIT_FAILURE);
+  BOOST_TEST(err_out.str().find("Error: --input: open") == 0u, err_out.str());
+  // batch queries are read from stdin so it can't also be the feed
+  err_out.str("");
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--input", "-", "--batch"),
+      failing_rss_get
+    );
+  }
+  BOOST_TEST(ret == EXIT_FAILURE);
+  BOOST_TEST(err_out.str().find("Error: --input - cannot") == 0u, err_out.str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // xkcd_alt
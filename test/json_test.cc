@@ -0,0 +1,149 @@
+/**
+ * @file json_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for json.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/json.hh"
+
+#include <string>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Input strings for the JSON string encoding test.
+ */
+const std::string json_string_inputs[] = {
+  "",
+  "plain text",
+  "say \"hi\"",
+  "back\\slash",
+  "a\tb\nc\rd",
+  std::string{"\x01\x1f", 2},
+  "caf\xc3\xa9"
+};
+
+/**
+ * Expected JSON string encodings of `json_string_inputs`.
+ */
+const std::string json_string_outputs[] = {
+  "\"\"",
+  "\"plain text\"",
+  "\"say \\\"hi\\\"\"",
+  "\"back\\\\slash\"",
+  "\"a\\tb\\nc\\rd\"",
+  "\"\\u0001\\u001f\"",
+  "\"caf\xc3\xa9\""
+};
+
+/**
+ * Reference per-character JSON string encoding.
+ *
+ * @param value String value to encode
+ */
+std::string reference_json_string(const std::string& value)
+{
+  static constexpr char hex_digits[] = "0123456789abcdef";
+  std::string out{"\""};
+  for (auto c : value) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+      out += c;
+    }
+    else if (c == '\b')
+      out += "\\b";
+    else if (c == '\f')
+      out += "\\f";
+    else if (c == '\n')
+      out += "\\n";
+    else if (c == '\r')
+      out += "\\r";
+    else if (c == '\t')
+      out += "\\t";
+    else if (static_cast<unsigned char>(c) < 0x20) {
+      out += "\\u00";
+      out += hex_digits[static_cast<unsigned char>(c) >> 4];
+      out += hex_digits[static_cast<unsigned char>(c) & 0xf];
+    }
+    else
+      out += c;
+  }
+  return out + '"';
+}
+
+}  // namespace
+
+/**
+ * Test that strings are correctly escaped as JSON strings.
+ */
+BOOST_DATA_TEST_CASE(
+  append_json_string_test,
+  bdata::make(json_string_inputs) ^ bdata::make(json_string_outputs),
+  input,
+  expected)
+{
+  std::string out;
+  pdxka::append_json_string(out, input);
+  BOOST_TEST(out == expected);
+}
+
+/**
+ * Test that escaping matches a per-character encoder across block boundaries.
+ *
+ * Each special character, plus a non-ASCII byte that must not be escaped, is
+ * placed at every position of strings spanning several vector blocks.
+ */
+BOOST_AUTO_TEST_CASE(append_json_string_blocks_test)
+{
+  for (auto special : {'"', '\\', '\n', '\x01', '\x1f', '\x7f', '\xc3'}) {
+    for (std::size_t size = 1; size <= 80; size += 13) {
+      for (std::size_t pos = 0; pos < size; pos++) {
+        std::string input(size, 'x');
+        input[pos] = special;
+        std::string out;
+        pdxka::append_json_string(out, input);
+        BOOST_TEST_REQUIRE(out == reference_json_string(input));
+      }
+    }
+  }
+}
+
+/**
+ * Test that RSS items are encoded as JSON objects with the comic number.
+ */
+BOOST_AUTO_TEST_CASE(append_json_test)
+{
+  pdxka::rss_item item{
+    "Title \"1\"",
+    "https://xkcd.com/1234/",
+    "https://imgs.xkcd.com/comics/a.png",
+    "alt\ntext",
+    "Title",
+    "Mon, 03 Jun 2024 04:00:00 -0000",
+    "https://xkcd.com/1234/"
+  };
+  std::string out{"["};
+  pdxka::append_json(out, item);
+  BOOST_TEST(
+    out ==
+    "[{\"number\":1234,\"title\":\"Title \\\"1\\\"\","
+    "\"link\":\"https://xkcd.com/1234/\","
+    "\"img_src\":\"https://imgs.xkcd.com/comics/a.png\","
+    "\"img_title\":\"alt\\ntext\",\"img_alt\":\"Title\","
+    "\"pub_date\":\"Mon, 03 Jun 2024 04:00:00 -0000\","
+    "\"guid\":\"https://xkcd.com/1234/\"}"
+  );
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,119 @@
+/**
+ * @file output_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for output.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/output.hh"
+
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/features.h"
+#include "pdxka/testing/stream_diverter.hh"
+
+#if !PDXKA_WIN32
+#include <unistd.h>
+#endif  // !PDXKA_WIN32
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Output stream buffer counting the number of times it is written to.
+ */
+class write_counting_buf : public std::stringbuf {
+public:
+  int n_writes = 0;
+
+protected:
+  std::streamsize xsputn(const char* s, std::streamsize n) override
+  {
+    n_writes++;
+    return std::stringbuf::xsputn(s, n);
+  }
+};
+
+}  // namespace
+
+/**
+ * Test that records are only written once the buffer fills or on flush.
+ */
+BOOST_AUTO_TEST_CASE(output_buffer_stream_test)
+{
+  write_counting_buf buf;
+  std::ostream out{&buf};
+  {
+    pdxka::output_buffer buffer{out, 8u};
+    buffer.append("abc");
+    buffer.put('\n');
+    BOOST_TEST(!buffer.end_record());
+    BOOST_TEST(buf.n_writes == 0);
+    // record that is larger than the capacity is not split
+    buffer.append("0123456789\n");
+    BOOST_TEST(buffer.end_record());
+    BOOST_TEST(buf.n_writes == 1);
+    BOOST_TEST(buf.str() == "abc\n0123456789\n");
+    buffer.buffer() += "tail\n";
+    // moved-to buffer owns the pending output, written by the dtor
+    pdxka::output_buffer moved{std::move(buffer)};
+  }
+  BOOST_TEST(buf.n_writes == 2);
+  BOOST_TEST(buf.str() == "abc\n0123456789\ntail\n");
+}
+
+/**
+ * Test that standard output falls back to `std::cout` when it is redirected.
+ */
+BOOST_AUTO_TEST_CASE(stdout_buffer_diverted_test)
+{
+  std::stringstream out;
+  {
+    pt::stream_diverter diverter{std::cout, out};
+    std::cout << "before ";
+    auto buffer = pdxka::stdout_buffer();
+    buffer.append("after\n");
+    buffer.flush();
+  }
+  BOOST_TEST(out.str() == "before after\n");
+}
+
+#if !PDXKA_WIN32
+/**
+ * Test that a file descriptor gets all output in a single write.
+ */
+BOOST_AUTO_TEST_CASE(output_buffer_fd_test)
+{
+  int fds[2];
+  BOOST_TEST_REQUIRE(!pipe(fds));
+  std::string expected;
+  {
+    pdxka::output_buffer buffer{fds[1]};
+    for (auto i = 0; i < 100; i++) {
+      auto line = "line " + std::to_string(i) + "\n";
+      buffer.append(line);
+      BOOST_TEST(!buffer.end_record());
+      expected += line;
+    }
+  }
+  close(fds[1]);
+  std::string received;
+  char chunk[4096];
+  for (ssize_t n; (n = read(fds[0], chunk, sizeof chunk)) > 0; )
+    received.append(chunk, static_cast<std::size_t>(n));
+  close(fds[0]);
+  BOOST_TEST(received == expected);
+}
+#endif  // !PDXKA_WIN32
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
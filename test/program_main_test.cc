@@ -11,21 +11,29 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 #include <string>
 #include <tuple>
 #include <utility>
 
+#include <boost/filesystem.hpp>
 #include <boost/test/data/test_case.hpp>
 #include <boost/test/unit_test.hpp>
 #include <curl/curl.h>
 
 #include "pdxka/curl.hh"
+#include "pdxka/features.h"
 #include "pdxka/testing/path.hh"
 #include "pdxka/testing/program_main.hh"
 #include "pdxka/testing/stream_diverter.hh"
 #include "pdxka/version.h"
 
+#if PDXKA_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // PDXKA_LINUX
+
 namespace pt = pdxka::testing;
 
 namespace {
@@ -178,4 +186,261 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(mock_program_main, T, argv_type_tuple)
   );
 }
 
+/**
+ * Test that the selected comic is printed in machine-readable formats.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_format)
+{
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--format", "ndjson", "-b1"),
+      mock_rss_get
+    );
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  auto output = out.str();
+  BOOST_TEST(output.substr(0, 15) == "{\"number\":2940,");
+  BOOST_TEST(output.find('\n') == output.size() - 1);
+  // header row is followed by the record
+  out.str("");
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--format=csv"), mock_rss_get
+    );
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  output = out.str();
+  BOOST_TEST(
+    output.substr(0, output.find('\n') + 1) ==
+    "number,title,link,img_src,img_title,img_alt,pub_date,guid\n"
+  );
+  BOOST_TEST(output.substr(output.find('\n') + 1, 5) == "2941,");
+  // template directives and escapes
+  out.str("");
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "-b3", "--template", "%n\\t%%\\n"),
+      mock_rss_get
+    );
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(out.str() == "2938\t%\n");
+}
+
+/**
+ * Test that ranges and all items are printed from a single fetch.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_range)
+{
+  // count fetches to check that the feed is only fetched once
+  unsigned int n_fetches = 0;
+  auto counting_get = [&n_fetches](const pdxka::cliopts& opts)
+  {
+    n_fetches++;
+    return mock_rss_get(opts);
+  };
+  auto run = [&counting_get](auto args)
+  {
+    std::stringstream out;
+    std::stringstream err_out;
+    int ret;
+    {
+      pt::stream_diverter out_diverter{std::cout, out};
+      pt::stream_diverter err_diverter{std::cerr, err_out};
+      ret = pt::program_main(std::move(args), counting_get);
+    }
+    BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+    return out.str();
+  };
+  BOOST_TEST(
+    run(pt::make_argument_vector(PDXKA_PROGNAME, "-b", "1..2", "--template", "%n\\n")) ==
+    "2940\n2939\n"
+  );
+  BOOST_TEST(
+    run(pt::make_argument_vector(PDXKA_PROGNAME, "--back=0..0", "--template", "%n\\n")) ==
+    "2941\n"
+  );
+  BOOST_TEST(
+    run(pt::make_argument_vector(PDXKA_PROGNAME, "--all", "--template", "%n ")) ==
+    "2941 2940 2939 2938 "
+  );
+  BOOST_TEST(n_fetches == 3u);
+  // alt text records follow each other
+  auto text = run(pt::make_argument_vector(PDXKA_PROGNAME, "-o", "-b0..3"));
+  std::size_t n_lines = 0;
+  for (auto c : text)
+    n_lines += (c == '\n');
+  BOOST_TEST(n_lines == 4u);
+}
+
+/**
+ * Test that random selection is distinct and reproducible with a seed.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_random)
+{
+  auto run = [](auto args)
+  {
+    std::stringstream out;
+    std::stringstream err_out;
+    int ret;
+    {
+      pt::stream_diverter out_diverter{std::cout, out};
+      pt::stream_diverter err_diverter{std::cerr, err_out};
+      ret = pt::program_main(std::move(args), mock_rss_get);
+    }
+    BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+    return out.str();
+  };
+  auto all = run(
+    pt::make_argument_vector(
+      PDXKA_PROGNAME, "--random", "4", "--seed", "7", "--template", "%n\\n"
+    )
+  );
+  BOOST_TEST(all.size() == 20u);
+  for (auto number : {"2941\n", "2940\n", "2939\n", "2938\n"})
+    BOOST_TEST(all.find(number) != std::string::npos);
+  BOOST_TEST(
+    run(
+      pt::make_argument_vector(
+        PDXKA_PROGNAME, "--random=4", "--seed=7", "--template", "%n\\n"
+      )
+    ) == all
+  );
+  // count defaults to 1
+  BOOST_TEST(
+    run(pt::make_argument_vector(PDXKA_PROGNAME, "--random", "--template", "%n\\n")).size() ==
+    5u
+  );
+}
+
+/**
+ * Test that the export command writes a fortune database.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_export)
+{
+  auto dir = std::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("pdxka-%%%%%%%%").string();
+  // directory is not a literal so argv is built directly
+  std::string args[] = {PDXKA_PROGNAME, "export", "--fortune", dir.string()};
+  char* argv[] = {args[0].data(), args[1].data(), args[2].data(), args[3].data(), nullptr};
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pdxka::program_main(4, argv, mock_rss_get);
+  }
+  BOOST_TEST(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(std::filesystem::is_regular_file(dir / "xkcd"));
+  BOOST_TEST(std::filesystem::is_regular_file(dir / "xkcd.dat"));
+  BOOST_TEST(out.str().find("Exported 4 new comics") == 0u);
+  std::filesystem::remove_all(dir);
+}
+
+/**
+ * Test that --timing prints the phase breakdown to stderr after the output.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_timing)
+{
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--timing", "-o"), mock_rss_get
+    );
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  BOOST_TEST(out.str().size());
+  auto timing = err_out.str();
+  BOOST_TEST(timing.find("Timing:\n") == 0u);
+  std::string::size_type pos = 0;
+  // phases are in order, where mocked results have no libcurl phases
+  for (
+    auto phase : {
+      "parse_options", "curl_global_init", "fetch_other", "parse_rss",
+      "to_item_vector", "format", "output", "total"
+    }
+  ) {
+    auto next = timing.find("  " + std::string{phase} + " ", pos);
+    BOOST_TEST_REQUIRE(next != std::string::npos, phase << " missing: " << timing);
+    pos = next;
+  }
+  BOOST_TEST(timing.find("dns") == std::string::npos);
+}
+
+#if PDXKA_TRACING
+/**
+ * Test that --trace writes parse and decode spans to a Chrome trace file.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_trace)
+{
+  auto path = std::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("pdxka-%%%%%%%%.json").string();
+  // path is not a literal so argv is built directly
+  std::string args[] = {PDXKA_PROGNAME, "--trace", path.string(), "-o"};
+  char* argv[] = {args[0].data(), args[1].data(), args[2].data(), args[3].data(), nullptr};
+  std::stringstream out;
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter out_diverter{std::cout, out};
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pdxka::program_main(4, argv, mock_rss_get);
+  }
+  BOOST_TEST_REQUIRE(ret == EXIT_SUCCESS, "error: " << err_out.str());
+  std::ifstream fs{path};
+  std::string trace{std::istreambuf_iterator<char>{fs}, {}};
+  fs.close();
+  std::filesystem::remove(path);
+  BOOST_TEST(trace.find("\"traceEvents\"") != std::string::npos);
+  for (auto name : {"parse_xml", "to_item_vector", "decode_item", "format_item"})
+    BOOST_TEST(
+      trace.find("\"name\":\"" + std::string{name} + "\"") != std::string::npos,
+      name << " missing"
+    );
+}
+#endif  // PDXKA_TRACING
+
+#if PDXKA_LINUX
+/**
+ * Test that failing to write standard output is an error, not an abort.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_write_error)
+{
+  // standard output is undiverted so it is written to with its descriptor
+  std::cout.flush();
+  auto stdout_fd = dup(STDOUT_FILENO);
+  BOOST_TEST_REQUIRE(stdout_fd >= 0);
+  auto full_fd = open("/dev/full", O_WRONLY);
+  BOOST_TEST_REQUIRE(full_fd >= 0);
+  dup2(full_fd, STDOUT_FILENO);
+  close(full_fd);
+  std::stringstream err_out;
+  int ret;
+  {
+    pt::stream_diverter err_diverter{std::cerr, err_out};
+    ret = pt::program_main(
+      pt::make_argument_vector(PDXKA_PROGNAME, "--all"), mock_rss_get
+    );
+  }
+  dup2(stdout_fd, STDOUT_FILENO);
+  close(stdout_fd);
+  BOOST_TEST(ret == EXIT_FAILURE);
+  BOOST_TEST(err_out.str().find("Error: write: ") == 0u, err_out.str());
+}
+#endif  // PDXKA_LINUX
+
 BOOST_AUTO_TEST_SUITE_END()  // xkcd_alt
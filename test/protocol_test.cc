@@ -0,0 +1,107 @@
+/**
+ * @file protocol_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for protocol.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/protocol.hh"
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Check that two RSS items have identical fields.
+ *
+ * @param actual Actual RSS item
+ * @param expected Expected RSS item
+ */
+void check_item_equal(const pdxka::rss_item& actual, const pdxka::rss_item& expected)
+{
+  BOOST_TEST(actual.title() == expected.title());
+  BOOST_TEST(actual.link() == expected.link());
+  BOOST_TEST(actual.img_src() == expected.img_src());
+  BOOST_TEST(actual.img_title() == expected.img_title());
+  BOOST_TEST(actual.img_alt() == expected.img_alt());
+  BOOST_TEST(actual.pub_date() == expected.pub_date());
+  BOOST_TEST(actual.guid() == expected.guid());
+}
+
+}  // namespace
+
+/**
+ * Test that the fixture items survive an encode/decode round trip.
+ */
+BOOST_AUTO_TEST_CASE(item_round_trip_test)
+{
+  for (const auto& item : pt::rss_fixture_items()) {
+    std::string line;
+    pdxka::encode_item(line, item);
+    BOOST_TEST_REQUIRE(line.back() == '\n');
+    check_item_equal(pdxka::decode_item(line), item);
+  }
+}
+
+/**
+ * Test that field values with special characters are escaped.
+ */
+BOOST_AUTO_TEST_CASE(item_escape_test)
+{
+  pdxka::rss_item item{"a\tb", "c\nd", "e\\f", "g\rh", "\\t", "", "\n\n"};
+  std::string line;
+  pdxka::encode_item(line, item);
+  BOOST_TEST(line == "a\\tb\tc\\nd\te\\\\f\tg\\rh\t\\\\t\t\t\\n\\n\n");
+  check_item_equal(pdxka::decode_item(line), item);
+}
+
+/**
+ * Test that malformed item encodings are rejected.
+ */
+BOOST_DATA_TEST_CASE(
+  item_decode_invalid_test,
+  bdata::make({"", "a\tb\tc\td\te\tf", "a\tb\tc\td\te\tf\tg\th", "a\\\tb\tc\td\te\tf\tg",
+    "a\tb\tc\td\te\tf\tg\\x"}),
+  line)
+{
+  BOOST_CHECK_THROW(pdxka::decode_item(line), std::invalid_argument);
+}
+
+/**
+ * Test that responses have the expected framing.
+ */
+BOOST_AUTO_TEST_CASE(respond_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  pdxka::feed_snapshot snapshot{items};
+  // one match
+  auto response = pdxka::respond(snapshot, "back 1\n");
+  std::string expected{"ok 1\n"};
+  pdxka::encode_item(expected, items[1]);
+  BOOST_TEST(response == expected);
+  // one match from the comic number index
+  expected = "ok 1\n";
+  pdxka::encode_item(expected, items[2]);
+  BOOST_TEST(pdxka::respond(snapshot, "number 2939") == expected);
+  // no match
+  BOOST_TEST(pdxka::respond(snapshot, "number 1") == "ok 0\n");
+  // bad request
+  response = pdxka::respond(snapshot, "back x");
+  BOOST_TEST(response.substr(0, 6) == "error ");
+  BOOST_TEST(response.back() == '\n');
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
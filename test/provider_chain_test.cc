@@ -0,0 +1,367 @@
+/**
+ * @file provider_chain_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for provider_chain.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/provider_chain.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/features.h"
+#include "pdxka/program_main.hh"
+#include "pdxka/snapshot.hh"
+#include "pdxka/testing/program_main.hh"
+#include "pdxka/testing/rss.hh"
+
+#if !PDXKA_WIN32
+#include "pdxka/testing/server.hh"
+#endif  // !PDXKA_WIN32
+
+namespace pt = pdxka::testing;
+
+namespace {
+
+/**
+ * Return a feed holding the fixture items.
+ */
+pdxka::feed_ptr fixture_feed()
+{
+  return std::make_shared<const pdxka::feed_snapshot>(pt::rss_fixture_items());
+}
+
+/**
+ * Mock RSS provider returning the fixture XML.
+ */
+pdxka::curl_result fixture_rss_get(const pdxka::cliopts& /*opts*/)
+{
+  return {CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200};
+}
+
+/**
+ * Mock RSS provider that fails, ensuring the network tier is not used.
+ */
+pdxka::curl_result failing_rss_get(const pdxka::cliopts& /*opts*/)
+{
+  return {CURLE_COULDNT_CONNECT, "mock failure", pdxka::request_type::get, ""};
+}
+
+/**
+ * Return a unique cache file path in a new temporary directory.
+ */
+auto temp_cache_path()
+{
+  return std::filesystem::temp_directory_path() /
+    boost::filesystem::unique_path("pdxka-%%%%%%%%").string() / "rss.cache";
+}
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that the first answering tier is used and promoted to cheaper tiers.
+ */
+BOOST_AUTO_TEST_CASE(provider_chain_promotion_test)
+{
+  unsigned int n_fetches = 0;
+  pdxka::provider_chain chain;
+  chain
+    .add(std::make_unique<pdxka::memory_tier>(std::chrono::seconds{60}))
+    .add(
+      std::make_unique<pdxka::function_tier>(
+        "network",
+        [&n_fetches]
+        {
+          n_fetches++;
+          return fixture_feed();
+        }
+      )
+    );
+  BOOST_TEST_REQUIRE(chain.size() == 2u);
+  BOOST_TEST(chain.tier(0).name() == "memory");
+  BOOST_TEST(chain.tier(1).name() == "network");
+  // first request misses memory and is promoted there
+  auto feed = chain.get();
+  BOOST_TEST_REQUIRE(feed);
+  BOOST_TEST(feed->size() == pt::rss_fixture_items().size());
+  BOOST_TEST(chain.stats(0).misses == 1u);
+  BOOST_TEST(chain.stats(0).promotions == 1u);
+  BOOST_TEST(chain.stats(1).hits == 1u);
+  // second request is answered from memory
+  BOOST_TEST(chain.get() == feed);
+  BOOST_TEST(chain.stats(0).hits == 1u);
+  BOOST_TEST(n_fetches == 1u);
+}
+
+/**
+ * Test that tier errors are counted and delegated.
+ */
+BOOST_AUTO_TEST_CASE(provider_chain_error_test)
+{
+  pdxka::provider_chain chain;
+  chain.add(
+    std::make_unique<pdxka::function_tier>(
+      "broken", []() -> pdxka::feed_ptr { throw std::runtime_error{"broken tier"}; }
+    )
+  );
+  // no tier answers
+  BOOST_TEST(!chain.get());
+  BOOST_TEST(chain.stats(0).errors == 1u);
+  BOOST_TEST(chain.stats(0).last_error == "broken tier");
+  // a later tier answers instead
+  chain.add(std::make_unique<pdxka::function_tier>("network", fixture_feed));
+  BOOST_TEST(chain.get());
+  BOOST_TEST(chain.stats(0).errors == 2u);
+  BOOST_TEST(chain.stats(1).hits == 1u);
+  std::stringstream report;
+  chain.report(report);
+  BOOST_TEST(
+    report.str() ==
+    "Tiers:\n"
+    "  broken               0 hits   0 misses   2 errors   0 promotions\n"
+    "  network              1 hits   0 misses   0 errors   0 promotions\n"
+  );
+}
+
+/**
+ * Test that the memory tier stops answering once its feed is too old.
+ */
+BOOST_AUTO_TEST_CASE(memory_tier_test)
+{
+  pdxka::memory_tier fresh{std::chrono::seconds{60}};
+  BOOST_TEST(!fresh.get());
+  auto feed = fixture_feed();
+  fresh.put(feed);
+  BOOST_TEST(fresh.get() == feed);
+  pdxka::memory_tier stale{std::chrono::seconds{-1}};
+  stale.put(feed);
+  BOOST_TEST(!stale.get());
+}
+
+/**
+ * Test that the cache tier writes and reads back the feed.
+ */
+BOOST_AUTO_TEST_CASE(cache_tier_test)
+{
+  auto path = temp_cache_path();
+  pdxka::cache_tier tier{path.string(), std::chrono::seconds{60}};
+  BOOST_TEST(tier.name() == "cache");
+  // missing file is a miss
+  BOOST_TEST(!tier.get());
+  tier.put(fixture_feed());
+  auto feed = tier.get();
+  BOOST_TEST_REQUIRE(feed);
+  const auto& expected = pt::rss_fixture_items();
+  BOOST_TEST_REQUIRE(feed->size() == expected.size());
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    BOOST_TEST(feed->items()[i].guid() == expected[i].guid());
+    BOOST_TEST(feed->items()[i].img_alt() == expected[i].img_alt());
+  }
+  // old file is a miss
+  std::filesystem::last_write_time(
+    path, std::filesystem::file_time_type::clock::now() - std::chrono::hours{1}
+  );
+  BOOST_TEST(!tier.get());
+  // empty feed is a miss
+  std::ofstream{path} << "ok 0\n";
+  BOOST_TEST(!tier.get());
+  // corrupt file is an error
+  std::ofstream{path} << "ok 1\n";
+  std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now());
+  BOOST_CHECK_THROW(tier.get(), std::invalid_argument);
+  std::filesystem::remove_all(path.parent_path());
+}
+
+/**
+ * Test that the fetch tier parses fetched XML and throws on fetch errors.
+ */
+BOOST_AUTO_TEST_CASE(fetch_tier_test)
+{
+  pdxka::fetch_tier tier{"network", [] { return fixture_rss_get({}); }};
+  auto feed = tier.get();
+  BOOST_TEST_REQUIRE(feed);
+  BOOST_TEST(feed->size() == pt::rss_fixture_items().size());
+  pdxka::fetch_tier failing{"network", [] { return failing_rss_get({}); }};
+  BOOST_CHECK_THROW(failing.get(), std::runtime_error);
+}
+
+#if !PDXKA_WIN32
+/**
+ * Test that the daemon tier gets the whole feed from a daemon.
+ */
+BOOST_AUTO_TEST_CASE(daemon_tier_test)
+{
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{900}},
+    [](std::time_t) { return fixture_rss_get({}); }
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  pdxka::daemon_tier tier{server.socket_path()};
+  auto feed = tier.get();
+  BOOST_TEST_REQUIRE(feed);
+  BOOST_TEST(feed->size() == pt::rss_fixture_items().size());
+  server.join();
+  // no daemon is a miss
+  BOOST_TEST(!pdxka::daemon_tier{pt::temp_socket_path()}.get());
+}
+#endif  // !PDXKA_WIN32
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
+
+// XKCD alt text program tests
+BOOST_AUTO_TEST_SUITE(xkcd_alt)
+
+/**
+ * Test that --cache shares the feed between runs without the network.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_cache)
+{
+  auto path = temp_cache_path();
+  std::stringstream out;
+  std::stringstream err_out;
+  // first run fetches and writes the cache file
+  BOOST_TEST_REQUIRE(
+    pt::program_main(
+      {"--cache", path.string(), "--all", "--template", "%n "}, fixture_rss_get, out, err_out
+    ) == EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST(out.str() == "2941 2940 2939 2938 ");
+  BOOST_TEST(std::filesystem::is_regular_file(path));
+  // second run is answered from the cache file, printing tier counters
+  out.str("");
+  err_out.str("");
+  BOOST_TEST_REQUIRE(
+    pt::program_main(
+      {"--cache", path.string(), "--timing", "-b3", "--template", "%n"},
+      failing_rss_get,
+      out,
+      err_out
+    ) == EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST(out.str() == "2938");
+  auto timing = err_out.str();
+  BOOST_TEST(timing.find("Tiers:\n  cache                1 hits") == 0u, timing);
+  BOOST_TEST(timing.find("  network              0 hits   0 misses") != std::string::npos);
+  BOOST_TEST(timing.find("  tiers ") != std::string::npos);
+  // expired cache file falls through to the provider
+  std::filesystem::last_write_time(
+    path, std::filesystem::file_time_type::clock::now() - std::chrono::minutes{10}
+  );
+  BOOST_TEST(
+    pt::program_main(
+      {"--cache", path.string(), "--cache-ttl", "60", "-b3"}, failing_rss_get, out, err_out
+    ) == EXIT_FAILURE
+  );
+  std::filesystem::remove_all(path.parent_path());
+}
+
+/**
+ * Test that a corrupt cache file is only a warning if the provider answers.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_corrupt_cache)
+{
+  auto path = temp_cache_path();
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream{path} << "not a feed\n";
+  std::stringstream out;
+  std::stringstream err_out;
+  BOOST_TEST_REQUIRE(
+    pt::program_main(
+      {"--cache", path.string(), "-b3", "--template", "%n"},
+      fixture_rss_get,
+      out,
+      err_out
+    ) == EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST(out.str() == "2938");
+  BOOST_TEST(err_out.str().find("Warning: cache tier: ") == 0u, err_out.str());
+  // the provider's feed replaced the corrupt cache file
+  out.str("");
+  err_out.str("");
+  BOOST_TEST(
+    pt::program_main(
+      {"--cache", path.string(), "-b3", "--template", "%n"},
+      failing_rss_get,
+      out,
+      err_out
+    ) == EXIT_SUCCESS
+  );
+  BOOST_TEST(out.str() == "2938");
+  BOOST_TEST(err_out.str().empty());
+  std::filesystem::remove_all(path.parent_path());
+}
+
+/**
+ * Test that an empty cache file falls through to the provider.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_empty_cache)
+{
+  auto path = temp_cache_path();
+  std::filesystem::create_directories(path.parent_path());
+  std::ofstream{path} << "ok 0\n";
+  std::stringstream out;
+  std::stringstream err_out;
+  BOOST_TEST(
+    pt::program_main({"--cache", path.string(), "--all"}, failing_rss_get, out, err_out) ==
+    EXIT_FAILURE
+  );
+  BOOST_TEST(out.str().empty());
+  BOOST_TEST(
+    pt::program_main(
+      {"--cache", path.string(), "--all", "--template", "%n "},
+      fixture_rss_get,
+      out,
+      err_out
+    ) == EXIT_SUCCESS
+  );
+  BOOST_TEST(out.str() == "2941 2940 2939 2938 ");
+  std::filesystem::remove_all(path.parent_path());
+}
+
+#if !PDXKA_WIN32
+/**
+ * Test that whole-feed queries are answered by the daemon without the network.
+ */
+BOOST_AUTO_TEST_CASE(mock_program_main_daemon_tier)
+{
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{900}},
+    [](std::time_t) { return fixture_rss_get({}); }
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  std::stringstream out;
+  std::stringstream err_out;
+  BOOST_TEST_REQUIRE(
+    pt::program_main(
+      {"--socket", server.socket_path(), "--all", "--template", "%n "},
+      failing_rss_get,
+      out,
+      err_out
+    ) == EXIT_SUCCESS,
+    "error: " << err_out.str()
+  );
+  BOOST_TEST(out.str() == "2941 2940 2939 2938 ");
+  server.join();
+}
+#endif  // !PDXKA_WIN32
+
+BOOST_AUTO_TEST_SUITE_END()  // xkcd_alt
@@ -0,0 +1,112 @@
+/**
+ * @file query_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for query.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/query.hh"
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that comic numbers are correctly read from the fixture links.
+ */
+BOOST_AUTO_TEST_CASE(comic_number_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  BOOST_TEST_REQUIRE(items.size() == 4u);
+  for (unsigned int i = 0; i < items.size(); i++)
+    BOOST_TEST(pdxka::comic_number(items[i]) == 2941u - i);
+}
+
+/**
+ * Test that links without a trailing comic number give comic number 0.
+ */
+BOOST_DATA_TEST_CASE(
+  comic_number_invalid_test,
+  bdata::make({"https://xkcd.com/", "https://xkcd.com/about", "", "2941/"}),
+  link)
+{
+  pdxka::rss_item item{"", link, "", "", "", "", ""};
+  BOOST_TEST(pdxka::comic_number(item) == 0u);
+}
+
+/**
+ * Test that valid queries are parsed correctly.
+ */
+BOOST_AUTO_TEST_CASE(parse_query_test)
+{
+  auto q = pdxka::parse_query("latest");
+  BOOST_TEST((q.type == pdxka::query_type::latest));
+  q = pdxka::parse_query("  back 3\r");
+  BOOST_TEST((q.type == pdxka::query_type::back));
+  BOOST_TEST(q.value == 3u);
+  q = pdxka::parse_query("number 2940");
+  BOOST_TEST((q.type == pdxka::query_type::number));
+  BOOST_TEST(q.value == 2940u);
+  q = pdxka::parse_query("search hot  air ");
+  BOOST_TEST((q.type == pdxka::query_type::search));
+  BOOST_TEST(q.text == "hot  air");
+  q = pdxka::parse_query("all\n");
+  BOOST_TEST((q.type == pdxka::query_type::all));
+}
+
+/**
+ * Test that malformed queries are rejected.
+ */
+BOOST_DATA_TEST_CASE(
+  parse_query_invalid_test,
+  bdata::make({"", "latest 1", "back", "back -1", "back 1x", "number", "search",
+    "random", "all 1"}),
+  line)
+{
+  BOOST_CHECK_THROW(pdxka::parse_query(line), std::invalid_argument);
+}
+
+/**
+ * Test that queries select the expected fixture items.
+ */
+BOOST_AUTO_TEST_CASE(run_query_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  auto selected = pdxka::run_query(items, pdxka::parse_query("latest"));
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected[0] == &items[0]);
+  selected = pdxka::run_query(items, pdxka::parse_query("back 2"));
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected[0] == &items[2]);
+  selected = pdxka::run_query(items, pdxka::parse_query("back 4"));
+  BOOST_TEST(selected.empty());
+  selected = pdxka::run_query(items, pdxka::parse_query("number 2938"));
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected[0] == &items[3]);
+  selected = pdxka::run_query(items, pdxka::parse_query("number 1"));
+  BOOST_TEST(selected.empty());
+  // search is case-insensitive and matches both alt text and title
+  selected = pdxka::run_query(items, pdxka::parse_query("search GOLGI"));
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected[0] == &items[0]);
+  selected = pdxka::run_query(items, pdxka::parse_query("search complexity"));
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected[0] == &items[2]);
+  // all items in feed order
+  selected = pdxka::run_query(items, pdxka::parse_query("all"));
+  BOOST_TEST_REQUIRE(selected.size() == items.size());
+  BOOST_TEST(selected.back() == &items.back());
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,82 @@
+/**
+ * @file random_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for random.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/random.hh"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that generators with equal seeds give equal sequences.
+ */
+BOOST_AUTO_TEST_CASE(xoshiro256ss_seed_test)
+{
+  pdxka::xoshiro256ss a{42u};
+  pdxka::xoshiro256ss b{42u};
+  pdxka::xoshiro256ss c{43u};
+  auto differs = false;
+  for (int i = 0; i < 100; i++) {
+    auto value = a();
+    BOOST_TEST_REQUIRE(value == b());
+    differs |= (value != c());
+  }
+  BOOST_TEST(differs);
+}
+
+/**
+ * Test that bounded values are in range and roughly uniform.
+ */
+BOOST_AUTO_TEST_CASE(uniform_below_test)
+{
+  pdxka::xoshiro256ss rng{1u};
+  constexpr std::uint32_t bound = 7u;
+  constexpr unsigned int n_draws = 70000u;
+  unsigned int counts[bound] = {};
+  for (unsigned int i = 0; i < n_draws; i++) {
+    auto value = pdxka::uniform_below(rng, bound);
+    BOOST_TEST_REQUIRE(value < bound);
+    counts[value]++;
+  }
+  // expected count is 10000 with a standard deviation under 100
+  for (auto count : counts)
+    BOOST_TEST((count > 9500u && count < 10500u), "count " << count);
+  BOOST_TEST(pdxka::uniform_below(rng, 1u) == 0u);
+}
+
+/**
+ * Test that samples are distinct, in range, and cover all orderings.
+ */
+BOOST_AUTO_TEST_CASE(sample_indices_test)
+{
+  pdxka::xoshiro256ss rng{7u};
+  for (std::size_t count = 0; count <= 10u; count++) {
+    auto indices = pdxka::sample_indices(rng, 10u, count);
+    BOOST_TEST_REQUIRE(indices.size() == count);
+    std::sort(indices.begin(), indices.end());
+    BOOST_TEST((std::adjacent_find(indices.begin(), indices.end()) == indices.end()));
+    BOOST_TEST((count == 0u || indices.back() < 10u));
+  }
+  // every ordering of 2 of 3 items is produced with about equal frequency
+  std::map<std::vector<std::size_t>, unsigned int> counts;
+  for (int i = 0; i < 6000; i++)
+    counts[pdxka::sample_indices(rng, 3u, 2u)]++;
+  BOOST_TEST(counts.size() == 6u);
+  for (const auto& [indices, count] : counts)
+    BOOST_TEST((count > 800u && count < 1200u), "count " << count);
+  BOOST_CHECK_THROW(pdxka::sample_indices(rng, 3u, 4u), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,192 @@
+/**
+ * @file schedule_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for schedule.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/schedule.hh"
+
+#include <chrono>
+#include <ctime>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * UNIX time of Monday 2024/06/03 04:00 UTC, the fixture's newest `pubDate`.
+ */
+constexpr std::time_t monday_slot = 1717387200;
+
+/**
+ * Seconds in a day.
+ */
+constexpr std::time_t day = 86400;
+
+}  // namespace
+
+/**
+ * Test that valid RFC 822 dates are parsed to the right UNIX time.
+ */
+BOOST_DATA_TEST_CASE(
+  parse_rfc822_date_test,
+  bdata::make(
+    {
+      "Mon, 03 Jun 2024 04:00:00 -0000",
+      "Mon, 03 Jun 2024 04:00:00 GMT",
+      "3 Jun 2024 00:00 -0400",
+      "Mon,  3 Jun 24 05:30:00 +0130",
+      "Sat, 29 Feb 2020 12:00:00 +0100"
+    }
+  ) ^
+  bdata::make(
+    {monday_slot, monday_slot, monday_slot, monday_slot, std::time_t{1582974000}}
+  ),
+  date,
+  expected)
+{
+  BOOST_TEST(pdxka::parse_rfc822_date(date) == expected);
+}
+
+/**
+ * Test that malformed RFC 822 dates are rejected.
+ */
+BOOST_DATA_TEST_CASE(
+  parse_rfc822_date_invalid_test,
+  bdata::make(
+    {
+      "",
+      "Mon 03 Jun 2024 04:00:00 GMT",
+      "03 Foo 2024 04:00:00 GMT",
+      "03 Jun 2024 04:00:00",
+      "03 Jun 2024 25:00:00 GMT",
+      "03 Jun 2024 04:00:00 EST",
+      "03 Jun 2024 04:00:00 GMT x"
+    }
+  ),
+  date)
+{
+  BOOST_CHECK_THROW(pdxka::parse_rfc822_date(date), std::invalid_argument);
+}
+
+/**
+ * Test that the fixture's Monday, Wednesday, Friday cadence is learned.
+ */
+BOOST_AUTO_TEST_CASE(publish_schedule_learn_test)
+{
+  auto expected = pdxka::publish_schedule::xkcd_default().slots();
+  auto schedule = pdxka::publish_schedule::learn(pt::rss_fixture_items());
+  BOOST_TEST(schedule.slots() == expected);
+  // no usable dates falls back to the default
+  pdxka::rss_item_vector items{{"", "", "", "", "", "", ""}};
+  BOOST_TEST(pdxka::publish_schedule::learn(items).slots() == expected);
+  // publication times close together are one slot at the earliest time
+  items = {
+    {"", "", "", "", "", "Tue, 04 Jun 2024 12:30:00 GMT", ""},
+    {"", "", "", "", "", "Tue, 28 May 2024 12:00:00 GMT", ""},
+    {"", "", "", "", "", "Tue, 21 May 2024 12:45:00 GMT", ""}
+  };
+  schedule = pdxka::publish_schedule::learn(items);
+  BOOST_TEST(schedule.slots() == std::vector<std::time_t>{day + 12 * 3600});
+}
+
+/**
+ * Test that the next slot is found within and across weeks.
+ */
+BOOST_AUTO_TEST_CASE(publish_schedule_next_slot_test)
+{
+  auto schedule = pdxka::publish_schedule::xkcd_default();
+  BOOST_TEST(schedule.next_slot(monday_slot) == monday_slot);
+  BOOST_TEST(schedule.next_slot(monday_slot - 1) == monday_slot);
+  BOOST_TEST(schedule.next_slot(monday_slot + 1) == monday_slot + 2 * day);
+  BOOST_TEST(schedule.next_slot(monday_slot + 4 * day) == monday_slot + 4 * day);
+  BOOST_TEST(schedule.next_slot(monday_slot + 4 * day + 1) == monday_slot + 7 * day);
+}
+
+/**
+ * Test that polling is dense in a window and backs off exponentially outside.
+ */
+BOOST_AUTO_TEST_CASE(poll_planner_delay_test)
+{
+  pdxka::poll_policy policy;
+  pdxka::poll_planner planner{pdxka::publish_schedule::xkcd_default(), policy};
+  // Saturday noon: backoff doubles up to the maximum
+  auto now = monday_slot - 2 * day + 8 * 3600;
+  auto backoff = policy.min_backoff;
+  for (auto i = 0; i < 10; i++) {
+    BOOST_TEST(planner.next_delay(now).count() == backoff.count());
+    planner.record(now, false);
+    backoff = std::min(2 * backoff, policy.max_backoff);
+  }
+  // never sleeps past the opening of the next window
+  now = monday_slot - policy.window_before.count() - 10;
+  BOOST_TEST(planner.next_delay(now).count() == 10);
+  // dense inside the window until a new comic is seen
+  now = monday_slot - 60;
+  BOOST_TEST(planner.next_delay(now).count() == policy.dense_interval.count());
+  planner.record(now, false);
+  now = monday_slot + 60;
+  BOOST_TEST(planner.next_delay(now).count() == policy.dense_interval.count());
+  planner.record(now, true);
+  // back to backoff starting from the minimum
+  BOOST_TEST(planner.next_delay(now).count() == policy.min_backoff.count());
+  // comic already seen when starting in Wednesday's window
+  now = monday_slot + 2 * day + 600;
+  pdxka::poll_planner late_planner{pdxka::publish_schedule::xkcd_default(), policy};
+  BOOST_TEST(late_planner.next_delay(now).count() == policy.dense_interval.count());
+  late_planner.seen(monday_slot + 2 * day);
+  BOOST_TEST(late_planner.next_delay(now).count() == policy.min_backoff.count());
+}
+
+/**
+ * Test that schedule-aware polling is timely and much cheaper than cron.
+ *
+ * A week is simulated in which comics appear 3 minutes after each expected
+ * slot. Every comic must be noticed within one dense interval and the number
+ * of polls must be under 10% of polling every 5 minutes.
+ */
+BOOST_AUTO_TEST_CASE(poll_planner_simulation_test)
+{
+  pdxka::poll_policy policy;
+  pdxka::poll_planner planner{pdxka::publish_schedule::xkcd_default(), policy};
+  // comics of the week starting Sunday 2024/06/02 00:00 UTC
+  const auto start = monday_slot - day - 4 * 3600;
+  const std::vector<std::time_t> published{
+    monday_slot + 180, monday_slot + 2 * day + 180, monday_slot + 4 * day + 180
+  };
+  std::size_t n_seen = 0;
+  std::size_t n_polls = 0;
+  for (auto now = start; now < start + 7 * day; ) {
+    now += planner.next_delay(now).count();
+    n_polls++;
+    auto changed = false;
+    if (n_seen < published.size() && now >= published[n_seen]) {
+      BOOST_TEST(now - published[n_seen] <= policy.dense_interval.count());
+      n_seen++;
+      changed = true;
+    }
+    planner.record(now, changed);
+  }
+  constexpr auto n_cron_polls = 7u * 24u * 12u;
+  BOOST_TEST(n_seen == published.size());
+  BOOST_TEST(n_polls * 10u < n_cron_polls);
+  BOOST_TEST_MESSAGE(
+    "poll_planner: " << n_polls << " polls/week vs. " << n_cron_polls <<
+    " polling every 5 minutes"
+  );
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,179 @@
+/**
+ * @file server_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for server.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/server.hh"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/client.hh"
+#include "pdxka/curl.hh"
+#include "pdxka/protocol.hh"
+#include "pdxka/testing/rss.hh"
+#include "pdxka/testing/server.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Send requests to a UNIX domain socket and return everything received.
+ *
+ * Connection is retried for a short time since the server may not have bound
+ * its socket yet. The write side is shut down after sending the requests.
+ *
+ * @param path Socket path
+ * @param requests Request lines to send
+ */
+std::string send_requests(const std::string& path, const std::string& requests)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  std::strcpy(addr.sun_path, path.c_str());
+  auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  BOOST_TEST_REQUIRE(fd >= 0, "socket: " << std::strerror(errno));
+  auto connected = false;
+  for (int i = 0; i < 500 && !connected; i++) {
+    connected = !connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+    if (!connected)
+      std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  }
+  BOOST_TEST_REQUIRE(connected, "could not connect to " << path);
+  BOOST_TEST_REQUIRE(
+    write(fd, requests.data(), requests.size()) ==
+      static_cast<ssize_t>(requests.size())
+  );
+  shutdown(fd, SHUT_WR);
+  std::string received;
+  char buf[4096];
+  for (ssize_t n; (n = read(fd, buf, sizeof buf)) > 0; )
+    received.append(buf, static_cast<std::size_t>(n));
+  close(fd);
+  return received;
+}
+
+}  // namespace
+
+/**
+ * Test that the daemon answers pipelined queries and refreshes conditionally.
+ */
+BOOST_AUTO_TEST_CASE(unix_server_test)
+{
+  // mock fetcher that answers with 304 once it has been given a time
+  std::atomic<unsigned int> n_fetches{0};
+  std::atomic<std::time_t> last_since{-1};
+  auto fetcher = [&](std::time_t modified_since)
+  {
+    n_fetches++;
+    last_since = modified_since;
+    if (modified_since)
+      return pdxka::curl_result{CURLE_OK, "", pdxka::request_type::get, "", 304};
+    return pdxka::curl_result{
+      CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200, 1717387200
+    };
+  };
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{0}}, fetcher
+  };
+  auto received = send_requests(
+    server.socket_path(), "latest\nnumber 2939\nsearch zzz\nbogus\nback 3"
+  );
+  server.join();
+  // check responses
+  const auto& items = pt::rss_fixture_items();
+  std::string expected{"ok 1\n"};
+  pdxka::encode_item(expected, items[0]);
+  expected += "ok 1\n";
+  pdxka::encode_item(expected, items[2]);
+  expected += "ok 0\n";
+  BOOST_TEST_REQUIRE(received.substr(0, expected.size()) == expected);
+  auto tail = received.substr(expected.size());
+  BOOST_TEST_REQUIRE(tail.substr(0, 6) == "error ");
+  expected = "ok 1\n";
+  pdxka::encode_item(expected, items[3]);
+  BOOST_TEST(tail.substr(tail.find('\n') + 1) == expected);
+  // zero refresh interval so we refreshed at least once, conditionally, and
+  // the not modified responses did not clear the items
+  BOOST_TEST(n_fetches > 1u);
+  BOOST_TEST(last_since == 1717387200);
+  BOOST_TEST(server.server().snapshot()->size() == items.size());
+  // socket file was removed
+  BOOST_TEST(!boost::filesystem::exists(server.socket_path()));
+}
+
+/**
+ * Test that clients are answered while a refresh is in progress.
+ */
+BOOST_AUTO_TEST_CASE(unix_server_refresh_test)
+{
+  // refreshes after the initial fetch block until the client is answered
+  std::promise<void> answered;
+  auto answered_future = answered.get_future().share();
+  std::atomic<bool> refreshing{false};
+  auto fetcher = [&](std::time_t modified_since)
+  {
+    if (modified_since) {
+      refreshing = true;
+      answered_future.wait_for(std::chrono::seconds{5});
+      return pdxka::curl_result{CURLE_OK, "", pdxka::request_type::get, "", 304};
+    }
+    return pdxka::curl_result{
+      CURLE_OK, "", pdxka::request_type::get, pt::rss_fixture(), 200, 1717387200
+    };
+  };
+  pt::scoped_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{0}}, fetcher
+  };
+  BOOST_TEST_REQUIRE(server.wait_ready());
+  for (int i = 0; i < 500 && !refreshing; i++)
+    std::this_thread::sleep_for(std::chrono::milliseconds{10});
+  BOOST_TEST_REQUIRE(refreshing);
+  // thin clients give up on the daemon after their timeout
+  pdxka::rss_item_vector items;
+  auto ok = pdxka::query_daemon(server.socket_path(), "latest", items);
+  answered.set_value();
+  server.join();
+  BOOST_TEST_REQUIRE(ok);
+  BOOST_TEST_REQUIRE(items.size() == 1u);
+  BOOST_TEST(items[0].guid() == pt::rss_fixture_items()[0].guid());
+}
+
+/**
+ * Test that the daemon does not start if the initial fetch fails.
+ */
+BOOST_AUTO_TEST_CASE(unix_server_fetch_error_test)
+{
+  pdxka::unix_server server{
+    {pt::temp_socket_path(), std::chrono::seconds{900}},
+    [](std::time_t)
+    {
+      return pdxka::curl_result{
+        CURLE_COULDNT_CONNECT, "mock failure", pdxka::request_type::get, ""
+      };
+    }
+  };
+  BOOST_CHECK_THROW(server.run(), std::runtime_error);
+  BOOST_TEST(!boost::filesystem::exists(server.options().socket_path));
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,175 @@
+/**
+ * @file snapshot_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for snapshot.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/snapshot.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/query.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Number of items in each generated snapshot.
+ */
+constexpr unsigned int items_per_snapshot = 16u;
+
+/**
+ * Return a snapshot whose items all identify the generation they belong to.
+ *
+ * Item `i` of generation `g` has comic number `g * items_per_snapshot + i + 1`
+ * and title `g`, so readers can check that all the items they see, and what
+ * the index returns, come from the same snapshot.
+ *
+ * @param generation Snapshot generation
+ */
+auto make_generation(unsigned int generation)
+{
+  pdxka::rss_item_vector items;
+  auto title = std::to_string(generation);
+  for (auto i = items_per_snapshot; i-- > 0; ) {
+    auto link = "https://xkcd.com/" +
+      std::to_string(generation * items_per_snapshot + i + 1) + "/";
+    items.emplace_back(title, link, "", "", "", "", link);
+  }
+  return std::make_shared<const pdxka::feed_snapshot>(std::move(items), generation);
+}
+
+/**
+ * Check that a snapshot is internally consistent.
+ *
+ * @param snapshot Snapshot to check
+ * @returns `true` if consistent
+ */
+bool consistent(const pdxka::feed_snapshot& snapshot)
+{
+  if (snapshot.size() != items_per_snapshot)
+    return false;
+  auto generation = static_cast<unsigned int>(snapshot.modified());
+  auto title = std::to_string(generation);
+  for (const auto& item : snapshot.items()) {
+    if (item.title() != title || snapshot.find(pdxka::comic_number(item)) != &item)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+/**
+ * Test that the comic number index finds fixture items.
+ */
+BOOST_AUTO_TEST_CASE(feed_snapshot_find_test)
+{
+  const auto& items = pt::rss_fixture_items();
+  pdxka::feed_snapshot snapshot{items, 1717387200};
+  BOOST_TEST(snapshot.size() == items.size());
+  BOOST_TEST(snapshot.modified() == 1717387200);
+  for (std::size_t i = 0; i < snapshot.size(); i++)
+    BOOST_TEST(snapshot.find(2941u - i) == &snapshot.items()[i]);
+  BOOST_TEST(!snapshot.find(0u));
+  BOOST_TEST(!snapshot.find(2942u));
+  // indexed number query agrees with the linear scan
+  pdxka::query q{pdxka::query_type::number, 2939u, {}};
+  auto selected = pdxka::run_query(snapshot, q);
+  BOOST_TEST_REQUIRE(selected.size() == 1u);
+  BOOST_TEST(selected.front() == &snapshot.items()[2]);
+  BOOST_TEST(pdxka::run_query(items, q).front()->guid() == selected.front()->guid());
+  q.value = 1u;
+  BOOST_TEST(pdxka::run_query(snapshot, q).empty());
+}
+
+/**
+ * Test that replaced snapshots are freed once their last reader drops them.
+ */
+BOOST_AUTO_TEST_CASE(snapshot_cell_reclaim_test)
+{
+  pdxka::snapshot_cell cell;
+  BOOST_TEST(!cell.load());
+  cell.publish(make_generation(0u));
+  auto reader = cell.load();
+  std::weak_ptr<const pdxka::feed_snapshot> old{reader};
+  cell.publish(make_generation(1u));
+  // reader still holds the old generation
+  BOOST_TEST(!old.expired());
+  BOOST_TEST(reader->modified() == 0);
+  BOOST_TEST(cell.load()->modified() == 1);
+  reader.reset();
+  BOOST_TEST(old.expired());
+}
+
+/**
+ * Test that concurrent readers only ever see complete snapshots.
+ *
+ * Many reader threads repeatedly load and check the current snapshot while a
+ * writer publishes new generations as fast as it can. Generations seen by
+ * each reader must never go backwards. Reader throughput is reported.
+ */
+BOOST_AUTO_TEST_CASE(snapshot_cell_stress_test)
+{
+  constexpr unsigned int n_generations = 2000u;
+  const auto n_readers = std::max(4u, std::thread::hardware_concurrency());
+  pdxka::snapshot_cell cell;
+  cell.publish(make_generation(0u));
+  std::atomic<bool> done{false};
+  std::atomic<unsigned long> n_reads{0u};
+  std::atomic<unsigned long> n_errors{0u};
+  std::vector<std::thread> readers;
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < n_readers; i++)
+    readers.emplace_back(
+      [&]
+      {
+        unsigned long reads = 0;
+        std::time_t last = 0;
+        // load at least once after the writer is done
+        for (auto stop = false; !stop; ) {
+          stop = done;
+          auto snapshot = cell.load();
+          if (!consistent(*snapshot) || snapshot->modified() < last)
+            n_errors++;
+          last = snapshot->modified();
+          reads++;
+        }
+        n_reads += reads;
+      }
+    );
+  // writer builds each new generation off to the side then swaps it in
+  for (unsigned int g = 1; g <= n_generations; g++)
+    cell.publish(make_generation(g));
+  done = true;
+  for (auto& reader : readers)
+    reader.join();
+  auto elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start
+  ).count();
+  BOOST_TEST(n_errors == 0u);
+  BOOST_TEST(cell.load()->modified() == n_generations);
+  BOOST_TEST_MESSAGE(
+    "snapshot_cell: " << n_readers << " readers, " << n_reads << " reads, " <<
+    static_cast<double>(n_reads) / elapsed << " reads/s"
+  );
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,184 @@
+/**
+ * @file string_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for string.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/string.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/testing/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Original `std::stringstream` implementation of `line_wrap`.
+ *
+ * This is kept verbatim as the reference the new implementation must match
+ * exactly, including its handling of leading whitespace and hard wraps.
+ */
+std::string reference_line_wrap(
+  const std::string& orig, std::size_t line_length, bool hard_wrap)
+{
+  std::stringstream stream;
+  std::size_t n_used = 0;
+  std::size_t n_chars = orig.size();
+  std::size_t n_written = 0;
+  for (std::size_t i = 0; i <= n_chars; i++) {
+    if (i == n_chars || std::isspace(static_cast<unsigned char>(orig[i]))) {
+      auto n_writable = i - n_written;
+      if (n_used + n_writable <= line_length) {
+        for (auto j = n_written; j < i; j++) stream.put(orig[j]);
+        n_used += n_writable;
+      }
+      else if (hard_wrap && n_writable > line_length) {
+        n_written++;
+        stream.put('\n');
+        std::size_t chunk_size = 0;
+        while (n_written < i) {
+          chunk_size = std::min(line_length, i - n_written);
+          for (auto j = n_written; j < n_written + chunk_size; j++)
+            stream.put(orig[j]);
+          stream.put('\n');
+          n_written += chunk_size;
+        }
+        n_used = chunk_size;
+      }
+      else {
+        n_written++;
+        stream.put('\n');
+        for (auto j = n_written; j < i; j++) stream.put(orig[j]);
+        n_used = n_writable;
+      }
+      n_written = i;
+    }
+  }
+  return stream.str();
+}
+
+/**
+ * Return the inputs checked against the reference implementation.
+ *
+ * These are the fixture alt texts, hand-picked edge cases, and random strings
+ * of short and long words separated by runs of mixed whitespace.
+ */
+const auto& wrap_inputs()
+{
+  static const auto inputs = []
+  {
+    std::vector<std::string> inputs;
+    for (const auto& item : pt::rss_fixture_items())
+      inputs.push_back(item.img_title());
+    inputs.insert(
+      inputs.end(),
+      {
+        "",
+        " ",
+        "word",
+        "  leading and trailing  ",
+        "tabs\tand\nnewlines\r\nand\vother\fspace",
+        "supercalifragilisticexpialidocious is long",
+        "a supercalifragilisticexpialidocious word in the middle"
+      }
+    );
+    std::mt19937 rng{8888};
+    std::uniform_int_distribution<int> word_len{1, 30};
+    std::uniform_int_distribution<int> space_len{1, 3};
+    std::uniform_int_distribution<int> n_words{0, 60};
+    constexpr char spaces[] = " \t\n";
+    for (auto i = 0; i < 50; i++) {
+      std::string text;
+      for (auto j = n_words(rng); j > 0; j--) {
+        text.append(static_cast<std::size_t>(word_len(rng)), 'a' + j % 26);
+        for (auto k = space_len(rng); k > 0; k--)
+          text.push_back(spaces[(i + k) % 3]);
+      }
+      inputs.push_back(std::move(text));
+    }
+    return inputs;
+  }();
+  return inputs;
+}
+
+}  // namespace
+
+/**
+ * Test that all wrapping entry points match the original implementation.
+ */
+BOOST_DATA_TEST_CASE(
+  line_wrap_differential_test,
+  bdata::make({1u, 2u, 5u, 16u, 40u, 79u, 80u, 200u}) * bdata::make({false, true}),
+  line_length,
+  hard_wrap)
+{
+  std::string appended{"prefix"};
+  for (const auto& input : wrap_inputs()) {
+    auto expected = reference_line_wrap(input, line_length, hard_wrap);
+    auto size = pdxka::line_wrap_size(input, line_length, hard_wrap);
+    BOOST_TEST_REQUIRE(size == expected.size(), "input: \"" << input << "\"");
+    BOOST_TEST(pdxka::line_wrap(input, line_length, hard_wrap) == expected);
+    // caller-supplied buffer
+    std::vector<char> buffer(size);
+    auto end = pdxka::line_wrap(buffer.data(), input, line_length, hard_wrap);
+    BOOST_TEST(static_cast<std::size_t>(end - buffer.data()) == size);
+    BOOST_TEST(std::string(buffer.begin(), buffer.end()) == expected);
+    // appending to a reused string
+    auto prefix_size = appended.size();
+    pdxka::line_wrap(appended, input, line_length, hard_wrap);
+    BOOST_TEST(appended.substr(prefix_size) == expected);
+  }
+}
+
+/**
+ * Test that the 80-column overload matches the original implementation.
+ */
+BOOST_AUTO_TEST_CASE(line_wrap_default_test)
+{
+  for (const auto& input : wrap_inputs()) {
+    BOOST_TEST(pdxka::line_wrap(input) == reference_line_wrap(input, 80, false));
+    BOOST_TEST(pdxka::line_wrap(input, true) == reference_line_wrap(input, 80, true));
+  }
+}
+
+/**
+ * Test that UTF-8 text is wrapped by display width, not by byte count.
+ */
+BOOST_AUTO_TEST_CASE(line_wrap_utf8_test)
+{
+  // each word is 5 columns but 6, 6, 7, and 6 bytes
+  BOOST_TEST(
+    pdxka::line_wrap("caf\u00e9s na\u00efve \u4e2d\u6587x r\u00e9sum", std::size_t{12}) ==
+    "caf\u00e9s na\u00efve\n\u4e2d\u6587x r\u00e9sum"
+  );
+  // combining accent adds no width
+  BOOST_TEST(pdxka::line_wrap("e\u0301e\u0301 abc", std::size_t{6}) == "e\u0301e\u0301 abc");
+  // hard wrap never splits a character
+  BOOST_TEST(
+    pdxka::line_wrap("x \u4e2d\u6587\u4e2d\u6587\u4e2d", 4u, true) ==
+    "x\n\u4e2d\u6587\n\u4e2d\u6587\n\u4e2d\n"
+  );
+  auto text = "\u201cquoted\u201d \u2014 with \u00e9m dashes";
+  BOOST_TEST(
+    pdxka::line_wrap_size(text, std::size_t{10}) ==
+    pdxka::line_wrap(text, std::size_t{10}).size()
+  );
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
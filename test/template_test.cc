@@ -0,0 +1,114 @@
+/**
+ * @file template_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for template.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/template.hh"
+
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/rss.hh"
+
+namespace bdata = boost::unit_test::data;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * RSS item rendered in the template tests.
+ */
+const pdxka::rss_item template_item{
+  "Title",
+  "https://xkcd.com/1234/",
+  "https://imgs.xkcd.com/comics/a.png",
+  "alt text",
+  "Image alt",
+  "Mon, 03 Jun 2024 04:00:00 -0000",
+  "https://xkcd.com/1234/#guid"
+};
+
+/**
+ * Templates for the template rendering test.
+ */
+const std::string template_inputs[] = {
+  "",
+  "no directives",
+  "%n\\t%t\\t%a\\n",
+  "%l %i %d %g",
+  "100%% %n\\\\",
+  "%a%a"
+};
+
+/**
+ * Expected renderings of `template_item` with `template_inputs`.
+ */
+const std::string template_outputs[] = {
+  "",
+  "no directives",
+  "1234\tTitle\talt text\n",
+  "https://xkcd.com/1234/ https://imgs.xkcd.com/comics/a.png "
+    "Mon, 03 Jun 2024 04:00:00 -0000 https://xkcd.com/1234/#guid",
+  "100% 1234\\",
+  "alt textalt text"
+};
+
+/**
+ * Templates that are invalid.
+ */
+const std::string invalid_templates[] = {"%", "abc%", "%x", "\\", "\\q"};
+
+}  // namespace
+
+/**
+ * Test that templates render items as expected.
+ */
+BOOST_DATA_TEST_CASE(
+  compiled_template_render_test,
+  bdata::make(template_inputs) ^ bdata::make(template_outputs),
+  input,
+  expected)
+{
+  pdxka::compiled_template tmpl{input};
+  BOOST_TEST(tmpl.render(template_item) == expected);
+  // rendering appends
+  std::string out{">"};
+  tmpl.render(out, template_item);
+  BOOST_TEST(out == ">" + expected);
+}
+
+/**
+ * Test that adjacent literals and escapes compile to one instruction.
+ */
+BOOST_AUTO_TEST_CASE(compiled_template_instructions_test)
+{
+  using field = pdxka::compiled_template::field;
+  pdxka::compiled_template tmpl{"[%%\\t]%n: %a\\n"};
+  const auto& ops = tmpl.instructions();
+  BOOST_TEST_REQUIRE(ops.size() == 5u);
+  BOOST_TEST((ops[0].what == field::literal));
+  BOOST_TEST(ops[0].size == 4u);
+  BOOST_TEST((ops[1].what == field::number));
+  BOOST_TEST((ops[2].what == field::literal));
+  BOOST_TEST(ops[2].size == 2u);
+  BOOST_TEST((ops[3].what == field::alt));
+  BOOST_TEST((ops[4].what == field::literal));
+  BOOST_TEST(tmpl.render(template_item) == "[%\t]1234: alt text\n");
+}
+
+/**
+ * Test that invalid templates are rejected when compiled.
+ */
+BOOST_DATA_TEST_CASE(compiled_template_invalid_test, bdata::make(invalid_templates), input)
+{
+  BOOST_CHECK_THROW(pdxka::compiled_template{input}, std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
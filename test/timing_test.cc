@@ -0,0 +1,96 @@
+/**
+ * @file timing_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for timing.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/timing.hh"
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/curl.hh"
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that a disabled timer records and reports nothing.
+ */
+BOOST_AUTO_TEST_CASE(phase_timer_disabled_test)
+{
+  pdxka::phase_timer timer;
+  timer.mark("parse_options");
+  timer.add("dns", std::chrono::milliseconds{5});
+  pdxka::add_curl_phases(timer, pdxka::curl_times{0, 1, 2, 3, 4, 5});
+  BOOST_TEST(!timer.enabled());
+  BOOST_TEST(timer.phases().empty());
+  std::stringstream out;
+  timer.report(out);
+  BOOST_TEST(out.str().empty());
+}
+
+/**
+ * Test that added phases are subtracted from the next marked phase.
+ */
+BOOST_AUTO_TEST_CASE(phase_timer_add_test)
+{
+  using namespace std::chrono_literals;
+  // start far enough in the past that the added phases fit inside
+  pdxka::phase_timer timer{true, pdxka::phase_timer::clock::now() - 10s};
+  timer.add("dns", 3s);
+  timer.mark("fetch_other");
+  const auto& phases = timer.phases();
+  BOOST_TEST_REQUIRE(phases.size() == 2u);
+  BOOST_TEST(phases[0].name == "dns");
+  BOOST_TEST((phases[0].elapsed == 3s));
+  BOOST_TEST(phases[1].name == "fetch_other");
+  BOOST_TEST((phases[1].elapsed >= 7s && phases[1].elapsed < 8s));
+  std::stringstream out;
+  timer.report(out);
+  auto text = out.str();
+  BOOST_TEST(text.find("Timing:\n") == 0u);
+  BOOST_TEST(text.find("  dns                   3000.000 ms\n") != std::string::npos);
+  BOOST_TEST(text.find("  total") != std::string::npos);
+}
+
+/**
+ * Test that cumulative libcurl times are split into phases.
+ */
+BOOST_AUTO_TEST_CASE(add_curl_phases_test)
+{
+  using us = std::chrono::microseconds;
+  pdxka::phase_timer timer{true, pdxka::phase_timer::clock::now()};
+  // DNS, connect, TLS, pretransfer, first byte, total
+  pdxka::add_curl_phases(timer, pdxka::curl_times{100, 300, 700, 750, 1750, 4750});
+  const auto& phases = timer.phases();
+  BOOST_TEST_REQUIRE(phases.size() == 5u);
+  BOOST_TEST(phases[0].name == "dns");
+  BOOST_TEST((phases[0].elapsed == us{100}));
+  BOOST_TEST(phases[1].name == "connect");
+  BOOST_TEST((phases[1].elapsed == us{200}));
+  BOOST_TEST(phases[2].name == "tls");
+  BOOST_TEST((phases[2].elapsed == us{400}));
+  BOOST_TEST(phases[3].name == "first_byte");
+  BOOST_TEST((phases[3].elapsed == us{1050}));
+  BOOST_TEST(phases[4].name == "transfer");
+  BOOST_TEST((phases[4].elapsed == us{3000}));
+  // plain HTTP has no TLS phase and unknown times add nothing
+  pdxka::phase_timer plain{true, pdxka::phase_timer::clock::now()};
+  pdxka::add_curl_phases(plain, pdxka::curl_times{100, 300, 0, 300, 800, 900});
+  BOOST_TEST(plain.phases().size() == 4u);
+  pdxka::add_curl_phases(plain, pdxka::curl_times{});
+  BOOST_TEST(plain.phases().size() == 4u);
+  // failed DNS resolution is the only phase
+  pdxka::phase_timer failed{true, pdxka::phase_timer::clock::now()};
+  pdxka::add_curl_phases(failed, pdxka::curl_times{0, 0, 0, 0, 0, 140});
+  BOOST_TEST_REQUIRE(failed.phases().size() == 1u);
+  BOOST_TEST(failed.phases()[0].name == "dns");
+  BOOST_TEST((failed.phases()[0].elapsed == us{140}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
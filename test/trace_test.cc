@@ -0,0 +1,147 @@
+/**
+ * @file trace_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for trace.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/trace.hh"
+
+#include <cstddef>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+
+#include "pdxka/features.h"
+
+namespace {
+
+/**
+ * Return the number of non-overlapping occurrences of `what` in `text`.
+ *
+ * @param text Text to search
+ * @param what Text to search for
+ */
+std::size_t count(const std::string& text, const std::string& what)
+{
+  std::size_t n = 0;
+  for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+    n++;
+  return n;
+}
+
+}  // namespace
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+#if PDXKA_TRACING
+/**
+ * Fixture discarding recorded spans and stopping tracing before and after.
+ */
+struct trace_fixture {
+  trace_fixture() { reset(); }
+  ~trace_fixture() { reset(); }
+
+  void reset()
+  {
+    pdxka::stop_tracing();
+    pdxka::clear_trace();
+  }
+};
+
+/**
+ * Test that spans are only recorded while tracing is active.
+ */
+BOOST_FIXTURE_TEST_CASE(trace_active_test, trace_fixture)
+{
+  {
+    PDXKA_TRACE_SPAN("trace_inactive");
+  }
+  pdxka::start_tracing();
+  {
+    PDXKA_TRACE_SPAN_ARG("trace_active", 42);
+  }
+  pdxka::stop_tracing();
+  auto json = pdxka::trace_json();
+  BOOST_TEST(json.find("\"traceEvents\":[") != std::string::npos);
+  BOOST_TEST(json.find("\"trace_inactive\"") == std::string::npos);
+  BOOST_TEST(count(json, "\"name\":\"trace_active\"") == 1u);
+  BOOST_TEST(json.find("\"ph\":\"X\"") != std::string::npos);
+  BOOST_TEST(json.find("\"args\":{\"arg\":42}") != std::string::npos);
+}
+
+/**
+ * Test that clearing the trace discards recorded spans.
+ */
+BOOST_FIXTURE_TEST_CASE(clear_trace_test, trace_fixture)
+{
+  pdxka::start_tracing();
+  {
+    PDXKA_TRACE_SPAN("trace_cleared");
+  }
+  pdxka::clear_trace();
+  {
+    PDXKA_TRACE_SPAN("trace_kept");
+  }
+  auto json = pdxka::trace_json();
+  BOOST_TEST(json.find("\"trace_cleared\"") == std::string::npos);
+  BOOST_TEST(count(json, "\"trace_kept\"") == 1u);
+}
+
+/**
+ * Test that a full ring buffer keeps only the most recent spans.
+ */
+BOOST_FIXTURE_TEST_CASE(trace_overwrite_test, trace_fixture)
+{
+  pdxka::start_tracing();
+  // oldest spans have argument 0..99 and are overwritten
+  for (std::size_t i = 0; i < pdxka::trace_buffer_size + 100u; i++) {
+    PDXKA_TRACE_SPAN_ARG("trace_ring", i);
+  }
+  auto json = pdxka::trace_json();
+  BOOST_TEST(count(json, "\"trace_ring\"") == pdxka::trace_buffer_size);
+  BOOST_TEST(json.find("\"arg\":99}") == std::string::npos);
+  BOOST_TEST(json.find("\"arg\":100}") != std::string::npos);
+}
+
+/**
+ * Test that spans from different threads have different thread IDs.
+ */
+BOOST_FIXTURE_TEST_CASE(trace_threads_test, trace_fixture)
+{
+  pdxka::start_tracing();
+  auto work = [] { PDXKA_TRACE_SPAN("trace_thread"); };
+  std::thread first{work};
+  std::thread second{work};
+  first.join();
+  second.join();
+  auto json = pdxka::trace_json();
+  BOOST_TEST_REQUIRE(count(json, "\"trace_thread\"") == 2u);
+  // collect the tid of each trace_thread event
+  std::set<std::string> tids;
+  for (
+    auto pos = json.find("\"trace_thread\"");
+    pos != std::string::npos;
+    pos = json.find("\"trace_thread\"", pos + 1)
+  ) {
+    auto tid = json.find("\"tid\":", pos) + 6u;
+    tids.insert(json.substr(tid, json.find_first_of(",}", tid) - tid));
+  }
+  BOOST_TEST(tids.size() == 2u);
+}
+#else
+/**
+ * Test that tracing cannot be started when compiled out.
+ */
+BOOST_AUTO_TEST_CASE(trace_disabled_test)
+{
+  BOOST_CHECK_THROW(pdxka::start_tracing(), std::runtime_error);
+  BOOST_TEST(count(pdxka::trace_json(), "\"ph\"") == 0u);
+}
+#endif  // !PDXKA_TRACING
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
@@ -0,0 +1,129 @@
+/**
+ * @file utf8_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for utf8.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/utf8.hh"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace bdata = boost::unit_test::data;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+/**
+ * Test that well-formed sequences of each length are decoded.
+ */
+BOOST_DATA_TEST_CASE(
+  utf8_decode_test,
+  bdata::make({"a", "\xc3\xa9", "\xe2\x80\x94", "\xf0\x9f\x98\x80"}) ^
+  bdata::make({U'a', U'é', U'—', U'\U0001F600'}),
+  text,
+  expected)
+{
+  std::string_view view{text};
+  char32_t cp;
+  BOOST_TEST(pdxka::utf8_decode(view.data(), view.size(), cp) == view.size());
+  BOOST_TEST((cp == expected));
+}
+
+/**
+ * Test that malformed sequences decode to U+FFFD one byte at a time.
+ */
+BOOST_DATA_TEST_CASE(
+  utf8_decode_invalid_test,
+  bdata::make(
+    {
+      "\x80",              // lone continuation byte
+      "\xc3",              // truncated
+      "\xc3(",             // bad continuation byte
+      "\xc0\xaf",          // overlong '/'
+      "\xed\xa0\x80",      // surrogate U+D800
+      "\xf4\x90\x80\x80",  // U+110000
+      "\xff"
+    }
+  ),
+  text)
+{
+  std::string_view view{text};
+  char32_t cp;
+  BOOST_TEST(pdxka::utf8_decode(view.data(), view.size(), cp) == 1u);
+  BOOST_TEST((cp == U'�'));
+}
+
+/**
+ * Test the width of characters from each width class.
+ */
+BOOST_AUTO_TEST_CASE(char_width_test)
+{
+  BOOST_TEST(pdxka::char_width(U'a') == 1u);
+  BOOST_TEST(pdxka::char_width(U'\t') == 1u);
+  BOOST_TEST(pdxka::char_width(U'é') == 1u);
+  BOOST_TEST(pdxka::char_width(U'­') == 1u);  // soft hyphen
+  BOOST_TEST(pdxka::char_width(U'́') == 0u);  // combining acute accent
+  BOOST_TEST(pdxka::char_width(U'​') == 0u);  // zero width space
+  BOOST_TEST(pdxka::char_width(U'ᅠ') == 0u);  // Hangul Jungseong filler
+  BOOST_TEST(pdxka::char_width(U'—') == 1u);  // em dash
+  BOOST_TEST(pdxka::char_width(U'“') == 1u);  // left double quote
+  BOOST_TEST(pdxka::char_width(U'中') == 2u);
+  BOOST_TEST(pdxka::char_width(U'가') == 2u);  // Hangul syllable
+  BOOST_TEST(pdxka::char_width(U'Ａ') == 2u);  // fullwidth A
+  BOOST_TEST(pdxka::char_width(U'\U0001F600') == 2u);
+  BOOST_TEST(pdxka::char_width(U'\U0002FFFD') == 2u);  // unassigned, default W
+  BOOST_TEST(pdxka::char_width(U'\U00050000') == 1u);  // unassigned
+  BOOST_TEST(pdxka::char_width(0x110000) == 1u);
+}
+
+/**
+ * Test ASCII detection at every position relative to the vector width.
+ */
+BOOST_AUTO_TEST_CASE(is_ascii_test)
+{
+  BOOST_TEST(pdxka::is_ascii(""));
+  std::string text(70, 'x');
+  BOOST_TEST(pdxka::is_ascii(text));
+  for (std::size_t i = 0; i < text.size(); i++) {
+    text[i] = '\x80';
+    BOOST_TEST(!pdxka::is_ascii(text), "high byte at " << i);
+    text[i] = 'x';
+  }
+}
+
+/**
+ * Test display width of mixed text.
+ */
+BOOST_AUTO_TEST_CASE(display_width_test)
+{
+  BOOST_TEST(pdxka::display_width("plain ascii") == 11u);
+  // curly quotes, em dash, combining accent, CJK, invalid byte
+  BOOST_TEST(pdxka::display_width("“ok” — é 中文 \xff") == 15u);
+}
+
+/**
+ * Test that prefixes fit, never split characters, and always make progress.
+ */
+BOOST_AUTO_TEST_CASE(display_prefix_test)
+{
+  std::string_view text{"中文éx"};
+  std::size_t width;
+  // first wide character alone is wider than one column
+  BOOST_TEST(pdxka::display_prefix(text, 1, width) == 3u);
+  BOOST_TEST(width == 2u);
+  BOOST_TEST(pdxka::display_prefix(text, 3, width) == 3u);
+  BOOST_TEST(width == 2u);
+  // combining accent stays with its base character
+  BOOST_TEST(pdxka::display_prefix(text, 5, width) == 9u);
+  BOOST_TEST(width == 5u);
+  BOOST_TEST(pdxka::display_prefix(text, 80, width) == text.size());
+  BOOST_TEST(width == 6u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
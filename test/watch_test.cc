@@ -0,0 +1,158 @@
+/**
+ * @file watch_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for watch.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/watch.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <curl/curl.h>
+
+#include "pdxka/curl.hh"
+#include "pdxka/rss.hh"
+#include "pdxka/testing/rss.hh"
+
+namespace pt = pdxka::testing;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * UNIX time of Monday 2024/06/03 04:00 UTC, the fixture's newest `pubDate`.
+ */
+constexpr std::time_t monday_slot = 1717387200;
+
+/**
+ * Return the fixture XML with a new comic 2942 published on Wednesday.
+ */
+std::string next_fixture()
+{
+  auto xml = pt::rss_fixture();
+  xml.insert(
+    xml.find("<item>"),
+    "<item>"
+    "<title>Next</title>"
+    "<link>https://xkcd.com/2942/</link>"
+    "<description>&lt;img src=\"https://imgs.xkcd.com/comics/next.png\" "
+    "title=\"Next alt\" alt=\"Next alt\" /&gt;</description>"
+    "<pubDate>Wed, 05 Jun 2024 04:00:00 -0000</pubDate>"
+    "<guid>https://xkcd.com/2942/</guid>"
+    "</item>"
+  );
+  return xml;
+}
+
+}  // namespace
+
+/**
+ * Test that only new comics are reported and unchanged polls are conditional.
+ *
+ * The simulated clock starts Monday after the fixture's newest comic and a
+ * new comic appears 2 minutes after Wednesday's slot.
+ */
+BOOST_AUTO_TEST_CASE(watch_feed_test)
+{
+  const auto published = monday_slot + 2 * 86400 + 120;
+  const auto published_xml = next_fixture();
+  auto now = monday_slot + 3600;
+  std::size_t n_conditional = 0;
+  std::vector<std::string> reported;
+  auto n_polls = pdxka::watch_feed(
+    [&](std::time_t modified_since) -> pdxka::curl_result
+    {
+      // unchanged since the caller's copy
+      if (modified_since && (now < published || modified_since >= published)) {
+        n_conditional++;
+        return {CURLE_OK, "", pdxka::request_type::get, "", 304};
+      }
+      return {
+        CURLE_OK,
+        "",
+        pdxka::request_type::get,
+        (now < published) ? pt::rss_fixture() : published_xml,
+        200,
+        (now < published) ? monday_slot : published
+      };
+    },
+    [&](const pdxka::rss_item& item) { reported.push_back(item.guid()); },
+    {},
+    {
+      [&now] { return now; },
+      [&now](std::chrono::seconds delay)
+      {
+        now += delay.count();
+        // stop at the end of Thursday
+        return now < monday_slot + 4 * 86400 - 4 * 3600;
+      }
+    }
+  );
+  BOOST_TEST(reported == std::vector<std::string>{"https://xkcd.com/2942/"});
+  // every poll but the one that got the new comic was conditional
+  BOOST_TEST(n_polls > 0u);
+  BOOST_TEST(n_conditional == n_polls - 1u);
+  // far fewer than the 792 polls of 5-minute polling over these 66 hours
+  BOOST_TEST(n_polls < 60u);
+}
+
+/**
+ * Test that a failed initial fetch is an error.
+ */
+BOOST_AUTO_TEST_CASE(watch_feed_fetch_error_test)
+{
+  BOOST_CHECK_THROW(
+    pdxka::watch_feed(
+      [](std::time_t)
+      {
+        return pdxka::curl_result{
+          CURLE_COULDNT_CONNECT, "mock failure", pdxka::request_type::get, ""
+        };
+      },
+      [](const pdxka::rss_item&) {}
+    ),
+    std::runtime_error
+  );
+}
+
+/**
+ * Test that a handler error, e.g. failing to write, stops watching.
+ */
+BOOST_AUTO_TEST_CASE(watch_feed_handler_error_test)
+{
+  std::size_t n_polls = 0;
+  BOOST_CHECK_THROW(
+    pdxka::watch_feed(
+      [&n_polls](std::time_t) -> pdxka::curl_result
+      {
+        return {
+          CURLE_OK,
+          "",
+          pdxka::request_type::get,
+          n_polls++ ? next_fixture() : pt::rss_fixture(),
+          200
+        };
+      },
+      [](const pdxka::rss_item&) { throw std::runtime_error{"write failed"}; },
+      {},
+      {
+        [] { return monday_slot + 3600; },
+        [&n_polls](std::chrono::seconds) { return n_polls < 3u; }
+      }
+    ),
+    std::runtime_error
+  );
+  // the first poll got the new comic
+  BOOST_TEST(n_polls == 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka
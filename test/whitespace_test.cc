@@ -0,0 +1,99 @@
+/**
+ * @file whitespace_test.cc
+ * @author Derek Huang
+ * @brief C++ unit tests for whitespace.hh
+ * @copyright MIT License
+ */
+
+#include "pdxka/whitespace.hh"
+
+#include <cctype>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/data/test_case.hpp>
+#include <boost/test/unit_test.hpp>
+
+namespace bdata = boost::unit_test::data;
+
+// libpdxka library tests
+BOOST_AUTO_TEST_SUITE(libpdxka)
+
+namespace {
+
+/**
+ * Return whitespace positions found by calling `std::isspace` on each byte.
+ *
+ * @param text Text to scan
+ */
+std::vector<std::size_t> reference_positions(const std::string& text)
+{
+  std::vector<std::size_t> positions;
+  for (std::size_t i = 0; i < text.size(); i++)
+    if (std::isspace(static_cast<unsigned char>(text[i])))
+      positions.push_back(i);
+  return positions;
+}
+
+/**
+ * Return whitespace positions found by a `whitespace_finder`.
+ *
+ * @param text Text to scan
+ */
+std::vector<std::size_t> finder_positions(const std::string& text)
+{
+  std::vector<std::size_t> positions;
+  pdxka::whitespace_finder finder{text};
+  for (auto i = finder.next(); i != text.size(); i = finder.next())
+    positions.push_back(i);
+  // end is sticky
+  BOOST_TEST(finder.next() == text.size());
+  return positions;
+}
+
+}  // namespace
+
+/**
+ * Test that classification matches `std::isspace` for every byte value.
+ */
+BOOST_AUTO_TEST_CASE(is_ascii_space_test)
+{
+  std::string block(pdxka::whitespace_block_size, 'x');
+  for (auto c = 0; c < 256; c++) {
+    auto expected = !!std::isspace(c);
+    BOOST_TEST(pdxka::is_ascii_space(static_cast<char>(c)) == expected, "byte " << c);
+    // same byte at every lane of a block
+    for (std::size_t i = 0; i < block.size(); i++) {
+      block[i] = static_cast<char>(c);
+      BOOST_TEST((pdxka::whitespace_mask(block.data()) == (expected ? 1u << i : 0u)));
+      block[i] = 'x';
+    }
+  }
+  BOOST_TEST_MESSAGE("whitespace kernel: " PDXKA_WHITESPACE_KERNEL);
+}
+
+/**
+ * Test that the finder matches a per-byte scan across block boundaries.
+ *
+ * Random text of all byte values, biased towards whitespace, is scanned at
+ * every length around the block size so all partial tails are covered.
+ */
+BOOST_DATA_TEST_CASE(whitespace_finder_test, bdata::make({1u, 5u, 50u}), space_ratio)
+{
+  std::mt19937 rng{space_ratio};
+  std::uniform_int_distribution<int> byte{0, 255};
+  std::uniform_int_distribution<unsigned int> percent{0u, 99u};
+  constexpr char spaces[] = " \t\n\v\f\r";
+  std::string text;
+  for (std::size_t n = 0; n < 8 * pdxka::whitespace_block_size + 3; n++) {
+    BOOST_TEST_REQUIRE(finder_positions(text) == reference_positions(text));
+    text.push_back(
+      (percent(rng) < space_ratio) ?
+        spaces[percent(rng) % 6] : static_cast<char>(byte(rng))
+    );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()  // libpdxka